@@ -7,6 +7,7 @@
 #include <sys/shm.h>     /* Shared memory operations */
 #include <sys/sem.h>     /* Semaphore operations */
 #include <time.h>        /* Time functions for logging */
+#include "../dynamic_logger/log_timestamp.h" /* Cached timestamp prefix for order logging */
 
 #define FIFO_REQUEST "/tmp/shop_fifo"       /* FIFO path for receiving customer orders */
 #define FIFO_RESPONSE "/tmp/inventory_fifo" /* FIFO path for sending inventory data to customers */
@@ -135,15 +136,12 @@ void log_order(const char *item_name, int quantity) {
         return;
     }
 
-    /* Get current timestamp */
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
+    /* Get current timestamp, the date part is only rebuilt when the second changes */
+    char timestamp[LOG_TIMESTAMP_SIZE];
+    log_timestamp_now(timestamp);
 
     /* Write order details to file */
-    fprintf(file, "[%04d-%02d-%02d %02d:%02d:%02d] Order: %d x %s\n",
-            t->tm_year + 1900, t->tm_mon + 1, t->tm_mday,
-            t->tm_hour, t->tm_min, t->tm_sec,
-            quantity, item_name);
+    fprintf(file, "[%s] Order: %d x %s\n", timestamp, quantity, item_name);
 
     fclose(file);
 }
@@ -0,0 +1,237 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include "logger.h"
+#include "log_internal.h"
+#include "log_format.h"
+
+#define LOG_BIN_MAX_FORMATS 1024  /* Distinct call sites, later ones fall back to text logging */
+
+/* A registered call site, never modified once published */
+typedef struct {
+    const char *file;
+    const char *format;
+    int line;
+    LogLevel level;
+    unsigned char num_args;
+    unsigned char arg_types[LOG_BIN_MAX_ARGS];
+    size_t fixed_size;          /* Record size with every string empty */
+} LogFormatEntry;
+
+int log_binary_enabled = 0;
+int log_binary_fd = -1;
+
+static LogFormatEntry formats[LOG_BIN_MAX_FORMATS];
+static int num_formats = 0;     /* Published with release, read by log_binary_open */
+static pthread_mutex_t formats_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Bytes an argument takes in the payload, strings only count their length prefix */
+static size_t arg_size(LogArgType type) {
+    switch (type) {
+    case LOG_ARG_INT:     return sizeof(int);
+    case LOG_ARG_LONG:    return sizeof(long);
+    case LOG_ARG_LLONG:   return sizeof(long long);
+    case LOG_ARG_DOUBLE:  return sizeof(double);
+    case LOG_ARG_LDOUBLE: return sizeof(long double);
+    case LOG_ARG_STRING:  return sizeof(uint16_t);
+    case LOG_ARG_POINTER: return sizeof(void *);
+    default:              return 0;
+    }
+}
+
+/* Write a whole record, continuing after partial writes */
+static int write_record(const char *record, size_t len) {
+    while (len > 0) {
+        ssize_t written = write(log_binary_fd, record, len);
+        if (written < 0) return -1;
+        record += written;
+        len -= written;
+    }
+    return 0;
+}
+
+/* Append the 'F' record describing a call site to the dictionary */
+static int write_format(int id, const LogFormatEntry *entry) {
+    uint32_t id32 = id;
+    uint8_t level = entry->level;
+    uint32_t line = entry->line;
+    size_t file_len = strlen(entry->file);
+    size_t format_len = strlen(entry->format);
+    if (file_len > UINT16_MAX || format_len > UINT16_MAX) return -1;
+
+    uint16_t file_len16 = file_len;
+    uint16_t format_len16 = format_len;
+    size_t len = 1 + 4 + 1 + 1 + 4 + 2 + 2 + entry->num_args + file_len + format_len;
+    char *record = malloc(len);
+    if (record == NULL) return -1;
+
+    char *p = record;
+    *p++ = LOG_BIN_FORMAT_TAG;
+    memcpy(p, &id32, 4);            p += 4;
+    *p++ = level;
+    *p++ = entry->num_args;
+    memcpy(p, &line, 4);            p += 4;
+    memcpy(p, &file_len16, 2);      p += 2;
+    memcpy(p, &format_len16, 2);    p += 2;
+    memcpy(p, entry->arg_types, entry->num_args); p += entry->num_args;
+    memcpy(p, entry->file, file_len);             p += file_len;
+    memcpy(p, entry->format, format_len);
+
+    int result = write_record(record, len);
+    free(record);
+    return result;
+}
+
+int log_binary_open(const char *path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) return -1;
+
+    pthread_mutex_lock(&formats_lock);
+    log_binary_fd = fd;
+    int result = write_record(LOG_BIN_MAGIC, LOG_BIN_MAGIC_LEN);
+
+    /* Call sites registered for an earlier file keep their ids, describe them again */
+    for (int id = 0; id < num_formats && result == 0; id++) {
+        result = write_format(id, &formats[id]);
+    }
+    if (result == 0) {
+        log_binary_enabled = 1;
+    } else {
+        close(fd);
+        log_binary_fd = -1;
+    }
+    pthread_mutex_unlock(&formats_lock);
+    return result;
+}
+
+void log_binary_close(void) {
+    pthread_mutex_lock(&formats_lock);
+    log_binary_enabled = 0;
+    if (log_binary_fd != -1) {
+        close(log_binary_fd);
+        log_binary_fd = -1;
+    }
+    pthread_mutex_unlock(&formats_lock);
+}
+
+int log_binary_register(LogLevel level, const char *file, int line, const char *format) {
+    LogFormatEntry entry = {file, format, line, level, 0, {0}, LOG_BIN_MESSAGE_HEAD};
+    LogConversion conv;
+    size_t pos = 0;
+
+    /* Types come from the format, exactly what the compiler checked the arguments against */
+    while (log_next_conversion(format, &pos, &conv)) {
+        if (conv.type == LOG_ARG_INVALID) return -1;
+        if (conv.type == LOG_ARG_NONE) continue;
+        if (entry.num_args + conv.stars + 1 > LOG_BIN_MAX_ARGS) return -1;
+        for (int i = 0; i < conv.stars; i++) {
+            entry.arg_types[entry.num_args++] = LOG_ARG_INT;
+        }
+        entry.arg_types[entry.num_args++] = conv.type;
+    }
+    for (int i = 0; i < entry.num_args; i++) {
+        entry.fixed_size += arg_size(entry.arg_types[i]);
+    }
+    if (entry.fixed_size > LOG_SLOT_SIZE) return -1;
+
+    pthread_mutex_lock(&formats_lock);
+    int id;
+    for (id = 0; id < num_formats; id++) {
+        /* Another thread raced us to the same call site */
+        if (formats[id].format == format && formats[id].file == file && formats[id].line == line) break;
+    }
+    if (id == num_formats) {
+        if (id == LOG_BIN_MAX_FORMATS || log_binary_fd == -1 || write_format(id, &entry) == -1) {
+            id = -1;
+        } else {
+            formats[id] = entry;
+            __atomic_store_n(&num_formats, id + 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&formats_lock);
+    return id;
+}
+
+void log_binary_write(int id, ...) {
+    const LogFormatEntry *entry = &formats[id];
+    char record[LOG_SLOT_SIZE];
+    size_t len = LOG_BIN_MESSAGE_HEAD;
+    size_t string_budget = LOG_SLOT_SIZE - entry->fixed_size;
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    va_list args;
+    va_start(args, id);
+    for (int i = 0; i < entry->num_args; i++) {
+        switch (entry->arg_types[i]) {
+        case LOG_ARG_INT: {
+            int value = va_arg(args, int);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_LONG: {
+            long value = va_arg(args, long);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_LLONG: {
+            long long value = va_arg(args, long long);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_DOUBLE: {
+            double value = va_arg(args, double);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_LDOUBLE: {
+            long double value = va_arg(args, long double);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_POINTER: {
+            void *value = va_arg(args, void *);
+            memcpy(record + len, &value, sizeof(value));
+            len += sizeof(value);
+            break;
+        }
+        case LOG_ARG_STRING: {
+            /* The only copy made on the hot path, cut to what is left of the slot */
+            const char *value = va_arg(args, const char *);
+            if (value == NULL) value = "(null)";
+            uint16_t value_len = strnlen(value, string_budget);
+            string_budget -= value_len;
+            memcpy(record + len, &value_len, sizeof(value_len));
+            memcpy(record + len + sizeof(value_len), value, value_len);
+            len += sizeof(value_len) + value_len;
+            break;
+        }
+        }
+    }
+    va_end(args);
+
+    uint16_t payload_len = len - LOG_BIN_MESSAGE_HEAD;
+    uint32_t id32 = id;
+    uint64_t timestamp = (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+    record[0] = LOG_BIN_MESSAGE_TAG;
+    memcpy(record + 1, &payload_len, 2);
+    memcpy(record + 3, &id32, 4);
+    memcpy(record + 7, &timestamp, 8);
+
+    if (log_async_active() && log_enqueue_record(record, len, 1) != 1) return;
+    if (log_binary_fd != -1) {
+        write_record(record, len);
+    }
+}
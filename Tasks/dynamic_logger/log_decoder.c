@@ -0,0 +1,286 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "log_format.h"
+
+#define LOG_INT_DIGITS 11 /* Characters of the longest int, "-2147483648" */
+
+/* Level names as printed by the text logger */
+static const char *level_names[] = {"DISABLED", "ERROR", "WARNING", "INFO", "DEBUG"};
+
+/* A dictionary entry read from an 'F' record, arg_types points into the file buffer */
+typedef struct {
+    int level;
+    int num_args;
+    const unsigned char *arg_types;
+    char *format;
+} DecodedFormat;
+
+static DecodedFormat *formats = NULL;
+static size_t formats_capacity = 0;
+
+/* Function to display usage instructions */
+void print_usage(const char *progname) {
+    printf("Usage: %s <binary log file>\n", progname);
+}
+
+/* Read the whole file into memory */
+static char *read_file(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+
+    size_t capacity = 1 << 16;
+    char *data = malloc(capacity);
+    *size = 0;
+    while (data != NULL) {
+        *size += fread(data + *size, 1, capacity - *size, file);
+        if (*size < capacity) break;
+        capacity *= 2;
+        char *grown = realloc(data, capacity);
+        if (grown == NULL) free(data);
+        data = grown;
+    }
+    fclose(file);
+    return data;
+}
+
+static int add_format(uint32_t id, const DecodedFormat *format) {
+    if (id >= formats_capacity) {
+        size_t capacity = formats_capacity ? formats_capacity : 64;
+        while (capacity <= id) capacity *= 2;
+        DecodedFormat *grown = realloc(formats, capacity * sizeof(DecodedFormat));
+        if (grown == NULL) return -1;
+        memset(grown + formats_capacity, 0, (capacity - formats_capacity) * sizeof(DecodedFormat));
+        formats = grown;
+        formats_capacity = capacity;
+    }
+    formats[id] = *format;
+    return 0;
+}
+
+/*
+ * Check that the argument types stored with a format are the ones its conversions consume.
+ * The types in the file are not trusted when rendering, printf only gets what the format asks for.
+ */
+static int arg_types_match(const char *text, const unsigned char *arg_types, int num_args) {
+    size_t pos = 0;
+    int arg = 0;
+    LogConversion conv;
+    while (log_next_conversion(text, &pos, &conv)) {
+        if (conv.type == LOG_ARG_NONE) continue;
+        if (conv.type == LOG_ARG_INVALID || arg + conv.stars + 1 > num_args) return 0;
+        for (int i = 0; i < conv.stars; i++) {
+            if (arg_types[arg++] != LOG_ARG_INT) return 0;
+        }
+        if (arg_types[arg++] != conv.type) return 0;
+    }
+    return arg == num_args;
+}
+
+/* Parse an 'F' record at data[0..size), returns its length or 0 when it is cut short or corrupt */
+static size_t decode_format(const char *data, size_t size) {
+    const size_t head = 1 + 4 + 1 + 1 + 4 + 2 + 2;
+    if (size < head) return 0;
+
+    uint32_t id;
+    uint16_t file_len, format_len;
+    DecodedFormat format;
+    memcpy(&id, data + 1, 4);
+    format.level = (unsigned char)data[5];
+    format.num_args = (unsigned char)data[6];
+    memcpy(&file_len, data + 11, 2);
+    memcpy(&format_len, data + 13, 2);
+
+    size_t len = head + format.num_args + file_len + format_len;
+    if (size < len || format.num_args > LOG_BIN_MAX_ARGS) return 0;
+
+    format.arg_types = (const unsigned char *)data + head;
+    format.format = strndup(data + head + format.num_args + file_len, format_len);
+    if (format.format == NULL) return 0;
+    if (!arg_types_match(format.format, format.arg_types, format.num_args) || add_format(id, &format) == -1) {
+        free(format.format);
+        return 0;
+    }
+    return len;
+}
+
+/* Copy size bytes of an argument out of the payload, returns -1 when the record has fewer bytes left */
+static int read_arg(void *value, size_t size, const char **payload, const char *end) {
+    if ((size_t)(end - *payload) < size) return -1;
+    memcpy(value, *payload, size);
+    *payload += size;
+    return 0;
+}
+
+/*
+ * Format a single conversion with the value read from the payload, stars already substituted.
+ * Returns -1 without printing when the value does not fit in the rest of the record.
+ */
+static int render_conversion(const char *spec, LogArgType type, const char **payload, const char *end) {
+    switch (type) {
+    case LOG_ARG_INT: {
+        int value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_LONG: {
+        long value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_LLONG: {
+        long long value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_DOUBLE: {
+        double value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_LDOUBLE: {
+        long double value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_POINTER: {
+        void *value;
+        if (read_arg(&value, sizeof(value), payload, end) == -1) return -1;
+        printf(spec, value);
+        break;
+    }
+    case LOG_ARG_STRING: {
+        uint16_t len;
+        if (read_arg(&len, sizeof(len), payload, end) == -1 || (size_t)(end - *payload) < len) return -1;
+        char *value = strndup(*payload, len);
+        *payload += len;
+        printf(spec, value ? value : "");
+        free(value);
+        break;
+    }
+    default:
+        fputs(spec, stdout);
+        break;
+    }
+    return 0;
+}
+
+/*
+ * Print one 'M' record as "[time] [LEVEL] message", payload_len bytes of arguments follow the head.
+ * Returns -1 when the arguments of the format don't fit in the payload, the line is ended there.
+ */
+static int render_message(const DecodedFormat *format, uint64_t timestamp, const char *payload, size_t payload_len) {
+    const char *end = payload + payload_len;
+    char when[32];
+    time_t seconds = timestamp / 1000000000ULL;
+    struct tm tm;
+    localtime_r(&seconds, &tm);
+    strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+    printf("[%s.%06llu] [%s] ", when, (unsigned long long)(timestamp % 1000000000ULL / 1000),
+           format->level >= 0 && format->level <= 4 ? level_names[format->level] : "?");
+
+    /* The types come from the format itself, decode_format checked the file agrees with them */
+    const char *text = format->format;
+    size_t pos = 0, printed = 0;
+    LogConversion conv;
+    while (log_next_conversion(text, &pos, &conv)) {
+        fwrite(text + printed, 1, conv.offset - printed, stdout);
+        printed = pos;
+        if (conv.type == LOG_ARG_NONE) {
+            putchar('%');
+            continue;
+        }
+
+        /* Replace each '*' with the int stored before the value, sized so the whole spec always fits */
+        size_t spec_size = conv.length + conv.stars * LOG_INT_DIGITS + 1;
+        char *spec = malloc(spec_size);
+        if (spec == NULL) {
+            puts(" <out of memory>");
+            return -1;
+        }
+        size_t out = 0;
+        int failed = 0;
+        for (size_t i = 0; i < conv.length && !failed; i++) {
+            char c = text[conv.offset + i];
+            if (c == '*') {
+                int value;
+                failed = read_arg(&value, sizeof(value), &payload, end) == -1;
+                if (!failed) out += snprintf(spec + out, spec_size - out, "%d", value);
+            } else {
+                spec[out++] = c;
+            }
+        }
+        spec[out] = '\0';
+
+        failed = failed || render_conversion(spec, conv.type, &payload, end) == -1;
+        free(spec);
+        if (failed) {
+            puts(" <corrupt record>");
+            return -1;
+        }
+    }
+    fwrite(text + printed, 1, pos - printed, stdout);
+    putchar('\n');
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    size_t size;
+    char *data = read_file(argv[1], &size);
+    if (data == NULL) {
+        perror("Failed to read the log file");
+        return 1;
+    }
+    if (size < LOG_BIN_MAGIC_LEN || memcmp(data, LOG_BIN_MAGIC, LOG_BIN_MAGIC_LEN) != 0) {
+        fprintf(stderr, "%s is not a binary log file.\n", argv[1]);
+        return 1;
+    }
+
+    size_t offset = LOG_BIN_MAGIC_LEN;
+    int corrupt = 0;
+    while (offset < size) {
+        const char *record = data + offset;
+        size_t left = size - offset;
+
+        if (record[0] == LOG_BIN_FORMAT_TAG) {
+            size_t len = decode_format(record, left);
+            if (len == 0) break;
+            offset += len;
+        } else if (record[0] == LOG_BIN_MESSAGE_TAG && left >= LOG_BIN_MESSAGE_HEAD) {
+            uint16_t payload_len;
+            uint32_t id;
+            uint64_t timestamp;
+            memcpy(&payload_len, record + 1, 2);
+            memcpy(&id, record + 3, 4);
+            memcpy(&timestamp, record + 7, 8);
+            if (left < (size_t)LOG_BIN_MESSAGE_HEAD + payload_len) break;
+            if (id >= formats_capacity || formats[id].format == NULL) {
+                fprintf(stderr, "Message with unknown format id %u at offset %zu.\n", id, offset);
+            } else if (render_message(&formats[id], timestamp, record + LOG_BIN_MESSAGE_HEAD, payload_len) == -1) {
+                fprintf(stderr, "Message at offset %zu is shorter than the arguments of its format: corrupt record.\n", offset);
+                corrupt = 1;
+            }
+            offset += LOG_BIN_MESSAGE_HEAD + payload_len;
+        } else {
+            break;
+        }
+    }
+
+    if (offset < size) {
+        fprintf(stderr, "Stopped at offset %zu: truncated or corrupt record.\n", offset);
+        return 1;
+    }
+    return corrupt;
+}
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <spawn.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/wait.h>
+#include "logger.h"
+#include "log_internal.h"
+
+#define LOG_FILE_MIN_SEGMENT   (64 * 1024)
+#define LOG_FILE_MAX_PATH      4096
+#define LOG_FILE_MAX_SPAWNED   8   /* Compressions running at once, a rotation waits for the oldest beyond that */
+
+extern char **environ;
+
+/*
+ * The current segment is preallocated to its full size and mapped, so appending a
+ * message is a memcpy into the page cache. The kernel writes the pages back in the
+ * background, sequentially; on rotation the file is cut to what was actually used.
+ */
+typedef struct {
+    char path[LOG_FILE_MAX_PATH];
+    LogFileOptions options;
+    int fd;
+    char *map;
+    size_t used;
+    time_t opened_at;
+    unsigned int sequence;      /* Tells apart segments rotated within the same second */
+    int rotate_failed;          /* Set once a failed rotation was reported, cleared by the next one that works */
+    pid_t compressors[LOG_FILE_MAX_SPAWNED];
+    int num_compressors;
+} LogFile;
+
+static LogFile log_file;
+static atomic_int file_active = 0;
+static pthread_mutex_t file_lock = PTHREAD_MUTEX_INITIALIZER;
+
+int log_file_active(void) {
+    return atomic_load_explicit(&file_active, memory_order_relaxed);
+}
+
+/* Collect finished compressions, or wait for the oldest one when block is set */
+static void reap_compressors(int block) {
+    int kept = 0;
+    for (int i = 0; i < log_file.num_compressors; i++) {
+        pid_t pid = log_file.compressors[i];
+        int wait_for_it = block && i == 0;
+        if (waitpid(pid, NULL, wait_for_it ? 0 : WNOHANG) == 0) {
+            log_file.compressors[kept++] = pid;
+        }
+    }
+    log_file.num_compressors = kept;
+}
+
+/* gzip a closed segment in a child process, never waiting for it here */
+static void compress_segment(const char *segment) {
+    if (log_file.num_compressors == LOG_FILE_MAX_SPAWNED) reap_compressors(1);
+
+    char *argv[] = {"gzip", "-f", (char *)segment, NULL};
+    pid_t pid;
+    if (posix_spawnp(&pid, "gzip", NULL, NULL, argv, environ) == 0) {
+        log_file.compressors[log_file.num_compressors++] = pid;
+    }
+}
+
+/* Move the file at path aside as <path>.<date>-<time>.<sequence>, its new name goes to rotated */
+static int retire_file(char *rotated, size_t size) {
+    char stamp[32];
+    time_t now = time(NULL);
+    struct tm tm;
+
+    localtime_r(&now, &tm);
+    strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm);
+    snprintf(rotated, size, "%s.%s.%u", log_file.path, stamp, log_file.sequence);
+    if (rename(log_file.path, rotated) == -1) return -1;
+    log_file.sequence++;
+    return 0;
+}
+
+/* Hand a retired segment to gzip once nothing writes to it any more */
+static void compress_retired(const char *rotated) {
+    reap_compressors(0);
+    if (log_file.options.compress) compress_segment(rotated);
+}
+
+/* Create, preallocate and map a fresh segment at path */
+static int open_segment(void) {
+    int fd = open(log_file.path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) return -1;
+
+    /* Reserve the blocks now, a full disk must not turn into SIGBUS on a later memcpy */
+    if (posix_fallocate(fd, 0, log_file.options.segment_size) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    char *map = mmap(NULL, log_file.options.segment_size, PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    madvise(map, log_file.options.segment_size, MADV_SEQUENTIAL);
+
+    log_file.fd = fd;
+    log_file.map = map;
+    log_file.used = 0;
+    log_file.opened_at = time(NULL);
+    return 0;
+}
+
+/* Unmap the current segment and cut it to the bytes written */
+static void close_segment(void) {
+    munmap(log_file.map, log_file.options.segment_size);
+    /* If this fails the tail stays zero-filled, readers see NUL bytes after the last line */
+    int result = ftruncate(log_file.fd, log_file.used);
+    (void)result;
+    close(log_file.fd);
+    log_file.map = NULL;
+    log_file.fd = -1;
+}
+
+/*
+ * Rename the current segment first, it is still open so nothing is lost when that fails:
+ * the segment stays current and the error is reported once on stderr.
+ */
+static int rotate(void) {
+    char rotated[LOG_FILE_MAX_PATH + 48];
+    if (retire_file(rotated, sizeof(rotated)) == -1) {
+        if (!log_file.rotate_failed) {
+            fprintf(stderr, "Failed to rotate %s: %s\n", log_file.path, strerror(errno));
+            log_file.rotate_failed = 1;
+        }
+        return -1;
+    }
+    log_file.rotate_failed = 0;
+
+    close_segment();
+    compress_retired(rotated);
+    return open_segment();
+}
+
+int log_file_open(const char *path, const LogFileOptions *options) {
+    if (strlen(path) >= LOG_FILE_MAX_PATH) return -1;
+
+    pthread_mutex_lock(&file_lock);
+    if (atomic_load(&file_active)) {
+        pthread_mutex_unlock(&file_lock);
+        return -1;
+    }
+
+    strcpy(log_file.path, path);
+    log_file.options = *options;
+    if (log_file.options.segment_size < LOG_FILE_MIN_SEGMENT) {
+        log_file.options.segment_size = LOG_FILE_MIN_SEGMENT;
+    }
+
+    /* Keep what an earlier run left behind, it becomes a rotated segment; never truncate it */
+    struct stat st;
+    char rotated[LOG_FILE_MAX_PATH + 48];
+    int result = 0;
+    if (stat(path, &st) == 0 && st.st_size > 0) {
+        result = retire_file(rotated, sizeof(rotated));
+        if (result == 0) compress_retired(rotated);
+    }
+
+    if (result == 0) result = open_segment();
+    if (result == 0) {
+        /* Whatever stdio still holds belongs before the first file message */
+        fflush(stdout);
+        atomic_store(&file_active, 1);
+    }
+    pthread_mutex_unlock(&file_lock);
+    return result;
+}
+
+void log_file_close(void) {
+    pthread_mutex_lock(&file_lock);
+    if (atomic_exchange(&file_active, 0)) {
+        if (log_file.map != NULL) close_segment();
+        while (log_file.num_compressors > 0) reap_compressors(1);
+    }
+    pthread_mutex_unlock(&file_lock);
+}
+
+/* Copy data into the mapped segment, continuing in a new segment when it is full */
+static int append(const char *data, size_t len) {
+    while (len > 0) {
+        if (log_file.used == log_file.options.segment_size && rotate() == -1) return -1;
+
+        size_t chunk = log_file.options.segment_size - log_file.used;
+        if (chunk > len) chunk = len;
+        memcpy(log_file.map + log_file.used, data, chunk);
+        log_file.used += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+    return 0;
+}
+
+void log_file_write(const struct iovec *iov, int count) {
+    pthread_mutex_lock(&file_lock);
+    int ok = log_file.map != NULL;
+
+    /* A segment that could not be rotated by age is still usable, keep writing and retry later */
+    if (ok && log_file.options.rotate_seconds > 0 && log_file.used > 0 &&
+        time(NULL) - log_file.opened_at >= log_file.options.rotate_seconds) {
+        if (rotate() == -1 && log_file.map != NULL) log_file.opened_at = time(NULL);
+        ok = log_file.map != NULL;
+    }
+    int i = 0;
+    while (ok && i < count) {
+        /* A line may span several iovecs (timestamp, then text), it ends with a newline */
+        int end = i;
+        size_t line_len = 0;
+        while (end < count) {
+            const struct iovec *part = &iov[end++];
+            line_len += part->iov_len;
+            if (part->iov_len > 0 && ((const char *)part->iov_base)[part->iov_len - 1] == '\n') break;
+        }
+
+        /* Start a new segment rather than split a line, unless it is larger than a segment */
+        if (log_file.used > 0 && log_file.used + line_len > log_file.options.segment_size) ok = rotate() == 0;
+        for (; ok && i < end; i++) {
+            ok = append(iov[i].iov_base, iov[i].iov_len) == 0;
+        }
+    }
+    pthread_mutex_unlock(&file_lock);
+}
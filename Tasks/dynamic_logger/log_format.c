@@ -0,0 +1,63 @@
+#include <string.h>
+#include "log_format.h"
+
+int log_next_conversion(const char *format, size_t *pos, LogConversion *conv) {
+    const char *start = strchr(format + *pos, '%');
+    if (start == NULL) {
+        *pos += strlen(format + *pos);
+        return 0;
+    }
+
+    const char *p = start + 1;
+    int longs = 0;
+    int long_double = 0;
+
+    conv->offset = start - format;
+    conv->stars = 0;
+
+    /* Flags, width and precision */
+    while (*p != '\0' && strchr("-+ #0", *p) != NULL) p++;
+    while ((*p >= '0' && *p <= '9') || *p == '*' || *p == '.') {
+        if (*p == '*') conv->stars++;
+        p++;
+    }
+
+    /* Length modifiers */
+    for (;; p++) {
+        if (*p == 'l') longs++;
+        else if (*p == 'j' || *p == 'z' || *p == 't') longs = 1;
+        else if (*p == 'L') long_double = 1;
+        else if (*p != 'h') break;
+    }
+
+    switch (*p) {
+    case '%':
+        conv->type = LOG_ARG_NONE;
+        break;
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+        conv->type = longs >= 2 ? LOG_ARG_LLONG : longs == 1 ? LOG_ARG_LONG : LOG_ARG_INT;
+        break;
+    case 'c':
+        /* %lc takes a wint_t, which has no payload type */
+        conv->type = longs ? LOG_ARG_INVALID : LOG_ARG_INT;
+        break;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        conv->type = long_double ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+        break;
+    case 's':
+        /* %ls is a wchar_t string, copying it as char bytes would cut it at the first zero byte */
+        conv->type = longs ? LOG_ARG_INVALID : LOG_ARG_STRING;
+        break;
+    case 'p':
+        conv->type = LOG_ARG_POINTER;
+        break;
+    default:
+        conv->type = LOG_ARG_INVALID;
+        break;
+    }
+
+    if (*p != '\0') p++;
+    conv->length = p - start;
+    *pos = p - format;
+    return 1;
+}
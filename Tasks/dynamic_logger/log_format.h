@@ -0,0 +1,53 @@
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <stddef.h>
+
+/*
+ * Binary log file layout, shared by the writer (log_binary.c) and log_decoder.
+ * Fields are in host byte order, the file is decoded on the machine that wrote it.
+ *
+ *   header  "DLOGBIN1"
+ *   'F' record  u32 id, u8 level, u8 num_args, u32 line, u16 file_len, u16 format_len,
+ *               u8 arg_types[num_args], file, format
+ *   'M' record  u16 payload_len, u32 id, u64 timestamp_ns, payload
+ *
+ * Every 'F' record is written before the first 'M' record using its id.
+ * The payload holds the raw arguments in format order: integers and doubles as
+ * stored in memory, strings as u16 length then the bytes (no NUL).
+ */
+#define LOG_BIN_MAGIC        "DLOGBIN1"
+#define LOG_BIN_MAGIC_LEN    8
+#define LOG_BIN_FORMAT_TAG   'F'
+#define LOG_BIN_MESSAGE_TAG  'M'
+#define LOG_BIN_MESSAGE_HEAD (1 + 2 + 4 + 8)
+#define LOG_BIN_MAX_ARGS     16
+
+/* How one argument is stored in a message payload */
+typedef enum {
+    LOG_ARG_NONE = 0,   /* "%%", consumes no argument */
+    LOG_ARG_INT,        /* int and everything promoted to it */
+    LOG_ARG_LONG,       /* long, size_t, ptrdiff_t, intmax_t */
+    LOG_ARG_LLONG,      /* long long */
+    LOG_ARG_DOUBLE,     /* double and float */
+    LOG_ARG_LDOUBLE,    /* long double */
+    LOG_ARG_STRING,     /* const char *, copied by value */
+    LOG_ARG_POINTER,    /* void *, only the address is kept */
+    LOG_ARG_INVALID     /* %n, %ls, %lc or an unknown conversion */
+} LogArgType;
+
+/* One conversion specification of a printf format */
+typedef struct {
+    size_t offset;      /* Position of the '%' */
+    size_t length;      /* Length of the whole specification */
+    int stars;          /* '*' width/precision fields, each consumes an int argument first */
+    LogArgType type;
+} LogConversion;
+
+/*
+ * Find the next conversion specification at or after format[*pos].
+ * Returns 1 and advances *pos past it, or 0 when the format has no more.
+ */
+int log_next_conversion(const char *format, size_t *pos, LogConversion *conv);
+
+#endif /* LOG_FORMAT_H */
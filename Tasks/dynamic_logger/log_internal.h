@@ -0,0 +1,37 @@
+#ifndef LOG_INTERNAL_H
+#define LOG_INTERNAL_H
+
+#include <stddef.h>
+
+/* Shared between the files of the logger library, not part of the public API */
+
+#define LOG_SLOT_SIZE 256 /* Longest message or binary record in async mode, longer text is truncated */
+
+/* Destination of binary records, -1 while binary logging is off */
+extern int log_binary_fd;
+
+/* Nonzero while log_async_start is in effect */
+int log_async_active(void);
+
+/*
+ * Copy a ready record into the caller's ring, the flusher writes it to stdout
+ * or, when binary is set, to log_binary_fd. Returns -1 when it is too long for a slot,
+ * and 1 when async mode was stopped meanwhile, the caller then writes it itself.
+ */
+int log_enqueue_record(const void *record, size_t len, int binary);
+
+/*
+ * Write one complete line (with its newline) wherever text output currently goes:
+ * the caller's ring, the file sink or stdout. Lines longer than a slot are cut in async mode.
+ */
+void log_write_line(const char *text, size_t len);
+
+struct iovec;
+
+/* Nonzero while log_file_open is in effect, text output then goes to the file sink */
+int log_file_active(void);
+
+/* Append complete lines to the current segment, rotating when it is full or too old */
+void log_file_write(const struct iovec *iov, int count);
+
+#endif /* LOG_INTERNAL_H */
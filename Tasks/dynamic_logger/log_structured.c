@@ -0,0 +1,186 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "logger.h"
+#include "log_internal.h"
+#include "log_timestamp.h"
+
+#define LOG_KV_BUFFER_SIZE  4096   /* Longest structured line, cut to LOG_SLOT_SIZE in async mode */
+#define LOG_KV_RESERVE      24     /* Kept free for the truncation marker and the line end */
+
+/* Output buffer with a hard end, writes past it only set overflow */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+    int overflow;
+} LineBuffer;
+
+static atomic_int structured_format = LOG_STRUCTURED_LOGFMT;
+static __thread char line_buffer[LOG_KV_BUFFER_SIZE];
+static __thread long thread_id = 0;
+
+void log_set_structured_format(LogStructuredFormat format) {
+    atomic_store_explicit(&structured_format, format, memory_order_relaxed);
+}
+
+/* gettid once per thread, it is a system call */
+static long current_thread_id(void) {
+    if (thread_id == 0) thread_id = syscall(SYS_gettid);
+    return thread_id;
+}
+
+static void put_bytes(LineBuffer *buf, const char *data, size_t len) {
+    if (buf->overflow || buf->len + len > buf->cap) {
+        buf->overflow = 1;
+        return;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+}
+
+static void put_char(LineBuffer *buf, char c) {
+    put_bytes(buf, &c, 1);
+}
+
+static void put_string(LineBuffer *buf, const char *str) {
+    put_bytes(buf, str, strlen(str));
+}
+
+/* Everything JSON requires escaping, control characters as \u00XX */
+static void put_json_string(LineBuffer *buf, const char *str) {
+    put_char(buf, '"');
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            put_char(buf, '\\');
+            put_char(buf, *p);
+        } else if (*p == '\n') {
+            put_bytes(buf, "\\n", 2);
+        } else if (*p == '\t') {
+            put_bytes(buf, "\\t", 2);
+        } else if (*p < 0x20) {
+            char escape[8];
+            put_bytes(buf, escape, snprintf(escape, sizeof(escape), "\\u%04x", *p));
+        } else {
+            put_char(buf, *p);
+        }
+    }
+    put_char(buf, '"');
+}
+
+/* logfmt values are bare unless they hold spaces, quotes, '=' or control characters */
+static void put_logfmt_string(LineBuffer *buf, const char *str) {
+    int quote = *str == '\0';
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0' && !quote; p++) {
+        quote = *p <= ' ' || *p == '"' || *p == '=' || *p == '\\';
+    }
+    if (!quote) {
+        put_string(buf, str);
+        return;
+    }
+
+    put_char(buf, '"');
+    for (const unsigned char *p = (const unsigned char *)str; *p != '\0'; p++) {
+        if (*p == '"' || *p == '\\') {
+            put_char(buf, '\\');
+            put_char(buf, *p);
+        } else if (*p == '\n') {
+            put_bytes(buf, "\\n", 2);
+        } else if (*p < 0x20) {
+            put_char(buf, ' ');
+        } else {
+            put_char(buf, *p);
+        }
+    }
+    put_char(buf, '"');
+}
+
+static void put_value(LineBuffer *buf, const LogField *field, int json) {
+    char number[32];
+
+    switch (field->type) {
+    case LOG_FIELD_STR:
+        if (field->value.s == NULL) {
+            put_string(buf, json ? "null" : "\"\"");
+        } else if (json) {
+            put_json_string(buf, field->value.s);
+        } else {
+            put_logfmt_string(buf, field->value.s);
+        }
+        break;
+    case LOG_FIELD_INT:
+        put_bytes(buf, number, snprintf(number, sizeof(number), "%lld", field->value.i));
+        break;
+    case LOG_FIELD_UINT:
+        put_bytes(buf, number, snprintf(number, sizeof(number), "%llu", field->value.u));
+        break;
+    case LOG_FIELD_DOUBLE:
+        /* JSON has no NaN or infinity */
+        if (json && !isfinite(field->value.d)) {
+            put_string(buf, "null");
+        } else {
+            put_bytes(buf, number, snprintf(number, sizeof(number), "%.15g", field->value.d));
+        }
+        break;
+    case LOG_FIELD_BOOL:
+        put_string(buf, field->value.b ? "true" : "false");
+        break;
+    }
+}
+
+static void put_field(LineBuffer *buf, const LogField *field, int json) {
+    if (json) {
+        put_bytes(buf, ",", buf->len > 1);
+        put_json_string(buf, field->key);
+        put_char(buf, ':');
+    } else {
+        put_bytes(buf, " ", buf->len > 0);
+        put_string(buf, field->key);
+        put_char(buf, '=');
+    }
+    put_value(buf, field, json);
+}
+
+void log_structured(LogLevel level, const char *file, int line, const LogField *fields, int count) {
+    int json = atomic_load_explicit(&structured_format, memory_order_relaxed) == LOG_STRUCTURED_JSON;
+    size_t limit = log_async_active() ? LOG_SLOT_SIZE : LOG_KV_BUFFER_SIZE;
+    LineBuffer buf = {line_buffer, 0, limit - LOG_KV_RESERVE, 0};
+
+    char stamp[LOG_TIMESTAMP_SIZE];
+    log_timestamp_now(stamp);
+
+    const LogField header[] = {
+        LOG_STR("time", stamp),
+        LOG_STR("level", log_level_names[level]),
+        LOG_STR("file", file),
+        LOG_INT("line", line),
+        LOG_INT("tid", current_thread_id()),
+    };
+    int num_header = sizeof(header) / sizeof(header[0]);
+
+    int truncated = 0;
+    if (json) put_char(&buf, '{');
+    for (int i = 0; i < num_header + count; i++) {
+        size_t complete = buf.len;
+        put_field(&buf, i < num_header ? &header[i] : &fields[i - num_header], json);
+        if (buf.overflow) {
+            /* Drop the field that did not fit rather than leave half of it */
+            buf.len = complete;
+            truncated = 1;
+            break;
+        }
+    }
+
+    /* The reserve is always there for the ending */
+    buf.cap = limit;
+    buf.overflow = 0;
+    if (truncated && json) put_string(&buf, buf.len > 1 ? ",\"truncated\":true" : "\"truncated\":true");
+    if (truncated && !json) put_string(&buf, " truncated=true");
+    if (json) put_char(&buf, '}');
+    put_char(&buf, '\n');
+
+    log_write_line(line_buffer, buf.len);
+}
@@ -0,0 +1,58 @@
+#ifndef LOG_TIMESTAMP_H
+#define LOG_TIMESTAMP_H
+
+#include <string.h>
+#include <time.h>
+
+/*
+ * Wall-clock timestamps for log lines, "YYYY-MM-DD HH:MM:SS.uuuuuu" in local time.
+ * The date and time of day only change once per second, so each thread keeps that
+ * part formatted and a message only converts its microseconds. localtime_r runs
+ * once per second per thread instead of once per message.
+ *
+ * CLOCK_REALTIME reads the vDSO and has microsecond resolution. Build with
+ * -DLOG_TIMESTAMP_CLOCK=CLOCK_REALTIME_COARSE for a cheaper read with the
+ * resolution of the scheduler tick (1-4 ms).
+ */
+#ifndef LOG_TIMESTAMP_CLOCK
+#define LOG_TIMESTAMP_CLOCK CLOCK_REALTIME
+#endif
+
+#define LOG_TIMESTAMP_SIZE 27   /* Formatted length plus the NUL */
+#define LOG_TIMESTAMP_PREFIX 19 /* "YYYY-MM-DD HH:MM:SS" */
+
+static __thread time_t log_timestamp_second = -1;
+static __thread char log_timestamp_prefix[LOG_TIMESTAMP_PREFIX + 1];
+
+/* Format ts into out, which must hold LOG_TIMESTAMP_SIZE bytes */
+static inline void log_timestamp_format(const struct timespec *ts, char *out) {
+    if (ts->tv_sec != log_timestamp_second) {
+        struct tm tm;
+        localtime_r(&ts->tv_sec, &tm);
+        strftime(log_timestamp_prefix, sizeof(log_timestamp_prefix), "%Y-%m-%d %H:%M:%S", &tm);
+        log_timestamp_second = ts->tv_sec;
+    }
+    memcpy(out, log_timestamp_prefix, LOG_TIMESTAMP_PREFIX);
+
+    long usec = ts->tv_nsec / 1000;
+    out[LOG_TIMESTAMP_PREFIX] = '.';
+    for (int i = LOG_TIMESTAMP_SIZE - 2; i > LOG_TIMESTAMP_PREFIX; i--) {
+        out[i] = '0' + usec % 10;
+        usec /= 10;
+    }
+    out[LOG_TIMESTAMP_SIZE - 1] = '\0';
+}
+
+/* Read LOG_TIMESTAMP_CLOCK */
+static inline void log_timestamp_read(struct timespec *ts) {
+    clock_gettime(LOG_TIMESTAMP_CLOCK, ts);
+}
+
+/* Format the current time into out, which must hold LOG_TIMESTAMP_SIZE bytes */
+static inline void log_timestamp_now(char *out) {
+    struct timespec ts;
+    log_timestamp_read(&ts);
+    log_timestamp_format(&ts, out);
+}
+
+#endif /* LOG_TIMESTAMP_H */
@@ -1,81 +1,623 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <signal.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include "logger.h"
+#include "log_internal.h"
+#include "log_timestamp.h"
 
-/* Define log levels */
-typedef enum {
-    LOG_DISABLED = 0,
-    LOG_ERROR,
-    LOG_WARNING,
-    LOG_INFO,
-    LOG_DEBUG
-} LogLevel;
+#define LOG_RING_SLOTS     512    /* Slots per thread ring, must be a power of two */
+#define LOG_FLUSH_BATCH    64     /* Slots handed to one writev call */
+#define LOG_FLUSH_IDLE_NS  1000000L /* Flusher sleep when every ring is empty */
 
-LogLevel current_log_level = LOG_INFO; /* Default log level */
+atomic_int current_log_level = LOG_INFO; /* Default log level */
+atomic_uint log_config_generation = 1;   /* Call sites start at 0, so the first use refreshes */
+
+/* A named module, entries are appended under modules_lock and never removed */
+typedef struct {
+    const char *name;
+    unsigned int hash;
+    atomic_int level;           /* LOG_LEVEL_INHERIT to follow current_log_level */
+    atomic_int rate;            /* -1 to follow the process rate limit */
+} LogModule;
+
+static LogModule modules[LOG_MAX_MODULES];
+static atomic_int num_modules = 0;
+static pthread_mutex_t modules_lock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_uint process_rate_limit = 0; /* Messages per second per call site, 0 for unlimited */
 
 /* Log level names */
 const char *log_level_names[] = {"DISABLED", "ERROR", "WARNING", "INFO", "DEBUG"};
 
-/* Function to handle signals and change log level */
-void signal_handler(int signo) {
-    if (signo == SIGRTMIN) {
-        current_log_level = LOG_DISABLED;
-    } else if (signo == SIGRTMIN+1) {
-        current_log_level = LOG_ERROR;
-    } else if (signo == SIGRTMIN+2) {
-        current_log_level = LOG_WARNING;
-    } else if (signo == SIGRTMIN+3) {
-        current_log_level = LOG_INFO;
-    } else if (signo == SIGRTMIN+4) {
-        current_log_level = LOG_DEBUG;
+/* One formatted message, or one binary record when binary is set */
+typedef struct {
+    unsigned int len;
+    unsigned char binary;
+    struct timespec time;       /* When the message was logged, the flusher formats it; 0 for raw records */
+    char text[LOG_SLOT_SIZE];
+} LogSlot;
+
+/*
+ * Single-producer single-consumer ring owned by one thread.
+ * The owner only advances head, the flusher only advances tail, so no locks are needed.
+ */
+typedef struct LogRing {
+    _Alignas(64) atomic_size_t head;
+    _Alignas(64) atomic_size_t tail;
+    atomic_int in_use;          /* Cleared when the owning thread exits, the ring is then reused */
+    atomic_int writing;         /* Set while the owner is putting a message in, log_async_stop waits for it */
+    struct LogRing *next;       /* Rings are only ever pushed to the list, never removed */
+    LogSlot slots[LOG_RING_SLOTS];
+} LogRing;
+
+static _Atomic(LogRing *) ring_list = NULL;
+static __thread LogRing *thread_ring = NULL;
+static pthread_key_t ring_key;
+static pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+
+static atomic_int async_enabled = 0;
+static atomic_int flusher_stop = 0;
+static LogOverflowPolicy overflow_policy = LOG_OVERFLOW_BLOCK;
+static pthread_t flusher_thread;
+static atomic_ulong dropped_messages = 0;
+
+/* Last control payload not reported yet by log_control_poll, 0 when there is none */
+static atomic_uint control_notice = 0;
+#define LOG_CONTROL_REJECTED 0x80000000u
+
+/* Module with the given name hash, signal-safe since entries are published before the count */
+static LogModule *find_module_by_hash(unsigned int hash) {
+    int count = atomic_load_explicit(&num_modules, memory_order_acquire);
+    for (int i = 0; i < count; i++) {
+        if (modules[i].hash == hash) return &modules[i];
+    }
+    return NULL;
+}
+
+/* Apply one control command, called from the signal handler so only atomics are touched */
+static int apply_control(int payload) {
+    unsigned int value = LOG_CONTROL_VALUE(payload);
+    LogModule *module = NULL;
+
+    switch (LOG_CONTROL_COMMAND(payload)) {
+    case LOG_CTL_LEVEL:
+        if (value > LOG_DEBUG) return -1;
+        atomic_store_explicit(&current_log_level, value, memory_order_relaxed);
+        break;
+    case LOG_CTL_MODULE_LEVEL:
+        module = find_module_by_hash(LOG_CONTROL_MODULE(payload));
+        if (module == NULL || value > LOG_DEBUG) return -1;
+        atomic_store_explicit(&module->level, value, memory_order_relaxed);
+        break;
+    case LOG_CTL_RATE_LIMIT:
+        atomic_store_explicit(&process_rate_limit, value, memory_order_relaxed);
+        break;
+    case LOG_CTL_MODULE_RATE_LIMIT:
+        module = find_module_by_hash(LOG_CONTROL_MODULE(payload));
+        if (module == NULL) return -1;
+        atomic_store_explicit(&module->rate, value, memory_order_relaxed);
+        break;
+    default:
+        return -1;
+    }
+    atomic_fetch_add_explicit(&log_config_generation, 1, memory_order_release);
+    return 0;
+}
+
+/* Async-signal-safe: no stdio, no locks, the notice is left for log_control_poll */
+static void control_signal_handler(int signo, siginfo_t *info, void *context) {
+    (void)context;
+    int payload;
+
+    if (signo == LOG_CONTROL_SIGNAL) {
+        if (info->si_code != SI_QUEUE) return; /* A plain kill carries no command */
+        payload = info->si_value.sival_int;
+    } else {
+        payload = LOG_CONTROL_PAYLOAD(LOG_CTL_LEVEL, signo - SIGRTMIN, 0);
+    }
+
+    unsigned int notice = (unsigned int)payload;
+    if (apply_control(payload) == -1) notice |= LOG_CONTROL_REJECTED;
+    atomic_store_explicit(&control_notice, notice, memory_order_relaxed);
+}
+
+int log_install_signal_handlers(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = control_signal_handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+
+    /* Block the other control signals while one is handled so commands apply in order */
+    sigemptyset(&action.sa_mask);
+    for (int signo = SIGRTMIN; signo <= LOG_CONTROL_SIGNAL; signo++) {
+        sigaddset(&action.sa_mask, signo);
+    }
+    for (int signo = SIGRTMIN; signo <= LOG_CONTROL_SIGNAL; signo++) {
+        if (sigaction(signo, &action, NULL) == -1) return -1;
+    }
+    return 0;
+}
+
+/* Thread exit: hand the ring back, the flusher still drains whatever is left in it */
+static void release_ring(void *ring) {
+    atomic_store_explicit(&((LogRing *)ring)->in_use, 0, memory_order_release);
+}
+
+static void create_ring_key(void) {
+    pthread_key_create(&ring_key, release_ring);
+}
+
+/* Find this thread's ring: reuse one released by an exited thread, or push a new one lock-free */
+static LogRing *get_thread_ring(void) {
+    if (thread_ring != NULL) return thread_ring;
+
+    pthread_once(&ring_key_once, create_ring_key);
+
+    LogRing *ring;
+    for (ring = atomic_load(&ring_list); ring != NULL; ring = ring->next) {
+        int expected = 0;
+        if (atomic_compare_exchange_strong(&ring->in_use, &expected, 1)) break;
+    }
+
+    if (ring == NULL) {
+        ring = calloc(1, sizeof(LogRing));
+        if (ring == NULL) return NULL;
+        atomic_store(&ring->in_use, 1);
+        ring->next = atomic_load(&ring_list);
+        while (!atomic_compare_exchange_weak(&ring_list, &ring->next, ring));
+    }
+
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+/*
+ * Mark the caller's ring busy, then check that async mode is still on. Both are seq_cst,
+ * so either log_async_stop sees the flag and waits, or the producer sees the mode off.
+ * Returns 0 with nothing marked when async mode is off.
+ */
+static int enter_ring(LogRing *ring) {
+    atomic_store(&ring->writing, 1);
+    if (!atomic_load(&async_enabled)) {
+        atomic_store_explicit(&ring->writing, 0, memory_order_release);
+        return 0;
+    }
+    return 1;
+}
+
+/* The caller's ring, or NULL with the message counted as dropped when none can be allocated */
+static LogRing *producer_ring(void) {
+    LogRing *ring = get_thread_ring();
+    if (ring == NULL) atomic_fetch_add_explicit(&dropped_messages, 1, memory_order_relaxed);
+    return ring;
+}
+
+static void leave_ring(LogRing *ring) {
+    atomic_store_explicit(&ring->writing, 0, memory_order_release);
+}
+
+/* Claim the next free slot of the ring, waiting or dropping when it is full */
+static LogSlot *reserve_slot(LogRing *ring, size_t *head_out) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (head - atomic_load_explicit(&ring->tail, memory_order_acquire) == LOG_RING_SLOTS) {
+        if (overflow_policy == LOG_OVERFLOW_DROP) {
+            atomic_fetch_add_explicit(&dropped_messages, 1, memory_order_relaxed);
+            return NULL;
+        }
+        /* The flusher keeps running until every busy ring is left, so this wait ends */
+        sched_yield();
+    }
+
+    *head_out = head;
+    return &ring->slots[head & (LOG_RING_SLOTS - 1)];
+}
+
+/* Publish the slot, the flusher's acquire load of head sees its contents */
+static void publish_slot(LogRing *ring, size_t head) {
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+/*
+ * Format into a free slot of the caller's ring, no locks and no system calls.
+ * Returns 0 when async mode was stopped meanwhile, the caller then writes the message itself.
+ */
+static int log_enqueue(LogLevel level, const char *format, va_list args) {
+    LogRing *ring = producer_ring();
+    if (ring == NULL) return 1;
+    if (!enter_ring(ring)) return 0;
+
+    size_t head;
+    LogSlot *slot = reserve_slot(ring, &head);
+    if (slot != NULL) {
+        /* Only the clock is read here, turning it into text is left to the flusher */
+        log_timestamp_read(&slot->time);
+        int len = snprintf(slot->text, LOG_SLOT_SIZE, "[%s] ", log_level_names[level]);
+        len += vsnprintf(slot->text + len, LOG_SLOT_SIZE - len, format, args);
+        if (len > LOG_SLOT_SIZE - 1) len = LOG_SLOT_SIZE - 1;
+        slot->text[len] = '\n';
+        slot->len = len + 1;
+        slot->binary = 0;
+        publish_slot(ring, head);
+    }
+    leave_ring(ring);
+    return 1;
+}
+
+int log_async_active(void) {
+    return atomic_load_explicit(&async_enabled, memory_order_relaxed);
+}
+
+int log_enqueue_record(const void *record, size_t len, int binary) {
+    if (len > LOG_SLOT_SIZE) return -1;
+
+    LogRing *ring = producer_ring();
+    if (ring == NULL) return 0;
+    if (!enter_ring(ring)) return 1;
+
+    size_t head;
+    LogSlot *slot = reserve_slot(ring, &head);
+    if (slot != NULL) {
+        memcpy(slot->text, record, len);
+        slot->len = len;
+        slot->binary = binary;
+        slot->time.tv_sec = 0;
+        publish_slot(ring, head);
+    }
+    leave_ring(ring);
+    return 0;
+}
+
+void log_control_poll(void) {
+    /* Plain load first, the exchange is a locked instruction */
+    if (atomic_load_explicit(&control_notice, memory_order_relaxed) == 0) return;
+    unsigned int notice = atomic_exchange_explicit(&control_notice, 0, memory_order_relaxed);
+    if (notice == 0) return;
+
+    char text[128];
+    int len;
+    LogModule *module = find_module_by_hash(LOG_CONTROL_MODULE(notice));
+    const char *module_name = module != NULL ? module->name : "?";
+    unsigned int value = LOG_CONTROL_VALUE(notice);
+
+    if (notice & LOG_CONTROL_REJECTED) {
+        len = snprintf(text, sizeof(text), "Log control command %u rejected (value %u, module %04x)\n",
+                       LOG_CONTROL_COMMAND(notice), value, LOG_CONTROL_MODULE(notice));
+    } else if (LOG_CONTROL_COMMAND(notice) == LOG_CTL_MODULE_LEVEL) {
+        len = snprintf(text, sizeof(text), "Log level of module %s changed to: %s\n",
+                       module_name, log_level_names[value]);
+    } else if (LOG_CONTROL_COMMAND(notice) == LOG_CTL_RATE_LIMIT) {
+        len = snprintf(text, sizeof(text), "Log rate limit changed to: %u messages per second\n", value);
+    } else if (LOG_CONTROL_COMMAND(notice) == LOG_CTL_MODULE_RATE_LIMIT) {
+        len = snprintf(text, sizeof(text), "Log rate limit of module %s changed to: %u messages per second\n",
+                       module_name, value);
+    } else {
+        len = snprintf(text, sizeof(text), "Log level changed to: %s\n",
+                       log_level_names[atomic_load(&current_log_level)]);
+    }
+
+    /* Through the ring in async mode so the notice stays in order with this thread's messages */
+    log_write_line(text, len);
+}
+
+void log_write_line(const char *text, size_t len) {
+    if (log_async_active() && log_enqueue_record(text, len < LOG_SLOT_SIZE ? len : LOG_SLOT_SIZE, 0) != 1) {
+        return;
+    }
+    if (log_file_active()) {
+        struct iovec iov = {(void *)text, len};
+        log_file_write(&iov, 1);
+    } else {
+        fwrite(text, 1, len, stdout);
+    }
+}
+
+static void log_vwrite(LogLevel level, const char *format, va_list args) {
+    log_control_poll();
+    if (atomic_load_explicit(&async_enabled, memory_order_relaxed)) {
+        /* The arguments are only read once async mode is confirmed, so they are still unused on 0 */
+        if (log_enqueue(level, format, args)) return;
+    }
+    if (log_file_active()) {
+        /* Same line as async mode, built on the stack and handed to the sink in one piece */
+        char stamp[LOG_TIMESTAMP_SIZE];
+        char text[LOG_TIMESTAMP_SIZE + LOG_SLOT_SIZE];
+        log_timestamp_now(stamp);
+        int len = snprintf(text, sizeof(text), "[%s] [%s] ", stamp, log_level_names[level]);
+        len += vsnprintf(text + len, sizeof(text) - len, format, args);
+        if (len > (int)sizeof(text) - 1) len = sizeof(text) - 1;
+        text[len] = '\n';
+        struct iovec iov = {text, len + 1};
+        log_file_write(&iov, 1);
+    } else {
+        char stamp[LOG_TIMESTAMP_SIZE];
+        log_timestamp_now(stamp);
+        printf("[%s] [%s] ", stamp, log_level_names[level]);
+        vprintf(format, args);
+        printf("\n");
     }
-    printf("Log level changed to: %s\n", log_level_names[current_log_level]);
 }
 
 /* Logging function */
 void log_message(LogLevel level, const char *format, ...) {
-    if (level > current_log_level) return; /* Ignore logs above current level */
+    if (!LOG_LEVEL_ENABLED(level)) {
+        log_control_poll();
+        return; /* Ignore logs above current level */
+    }
 
     va_list args;
     va_start(args, format);
-    printf("[%s] ", log_level_names[level]);
-    vprintf(format, args);
-    printf("\n");
+    log_vwrite(level, format, args);
     va_end(args);
 }
 
-/* Logging macros */
-#define LOG_ERROR(...)   log_message(LOG_ERROR, __VA_ARGS__)
-#define LOG_WARNING(...) log_message(LOG_WARNING, __VA_ARGS__)
-#define LOG_INFO(...)    log_message(LOG_INFO, __VA_ARGS__)
-#define LOG_DEBUG(...)   log_message(LOG_DEBUG, __VA_ARGS__)
+void log_emit(LogLevel level, const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    log_vwrite(level, format, args);
+    va_end(args);
+}
+
+void log_set_level(LogLevel level) {
+    atomic_store_explicit(&current_log_level, level, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log_config_generation, 1, memory_order_release);
+}
+
+int log_module_register(const char *name) {
+    unsigned int hash = log_module_hash(name);
+
+    pthread_mutex_lock(&modules_lock);
+    int count = atomic_load_explicit(&num_modules, memory_order_relaxed);
+    int index;
+    for (index = 0; index < count; index++) {
+        if (strcmp(modules[index].name, name) == 0) break;
+    }
+    if (index == count) {
+        if (count == LOG_MAX_MODULES) {
+            index = -1;
+        } else {
+            modules[index].name = name;
+            modules[index].hash = hash;
+            atomic_init(&modules[index].level, LOG_LEVEL_INHERIT);
+            atomic_init(&modules[index].rate, -1);
+            /* Publish after the entry is complete, the signal handler reads it without the lock */
+            atomic_store_explicit(&num_modules, count + 1, memory_order_release);
+        }
+    }
+    pthread_mutex_unlock(&modules_lock);
+    return index;
+}
+
+int log_module_set_level(const char *name, int level) {
+    int index = log_module_register(name);
+    if (index == -1 || level < LOG_LEVEL_INHERIT || level > LOG_DEBUG) return -1;
 
-int main() {
-    /* Register signal handlers */
-    signal(SIGRTMIN, signal_handler);
-    signal(SIGRTMIN+1, signal_handler);
-    signal(SIGRTMIN+2, signal_handler);
-    signal(SIGRTMIN+3, signal_handler);
-    signal(SIGRTMIN+4, signal_handler);
+    atomic_store_explicit(&modules[index].level, level, memory_order_relaxed);
+    atomic_fetch_add_explicit(&log_config_generation, 1, memory_order_release);
+    return 0;
+}
 
+void log_site_refresh(LogSite *site, const char *module) {
+    /* Read the generation first: a change made while we compute makes the next call refresh again */
+    unsigned int generation = atomic_load_explicit(&log_config_generation, memory_order_acquire);
 
-    printf("Logger started. PID: %d\n", getpid());
-    printf("- Use SIGRTMIN to Disable logger.\n- Use SIGRTMIN+1 to set looger to error.\n");
-    printf("- Use SIGRTMIN+2 set looger to warning.\n- Use SIGRTMIN+3 to set looger to info.\n- Use SIGRTMIN+4 to set looger to debug.\n");
-    printf("---------------------------------------------------- \n");
+    int index = atomic_load_explicit(&site->module, memory_order_relaxed);
+    if (index == -1) {
+        index = log_module_register(module);
+        atomic_store_explicit(&site->module, index, memory_order_relaxed);
+    }
 
-    /* Simulated logging loop */
-    while (1) {
-        LOG_ERROR("This is an ERROR message.");
-        LOG_WARNING("This is a WARNING message.");
-        LOG_INFO("This is an INFO message.");
-        LOG_DEBUG("This is a DEBUG message.");
-	printf("---------------------------------------------------- \n");
-	sleep(3);
+    int level = atomic_load_explicit(&current_log_level, memory_order_relaxed);
+    int rate = atomic_load_explicit(&process_rate_limit, memory_order_relaxed);
+    if (index != -1) {
+        int module_level = atomic_load_explicit(&modules[index].level, memory_order_relaxed);
+        int module_rate = atomic_load_explicit(&modules[index].rate, memory_order_relaxed);
+        if (module_level != LOG_LEVEL_INHERIT) level = module_level;
+        if (module_rate != -1) rate = module_rate;
     }
 
+    atomic_store_explicit(&site->level, level, memory_order_relaxed);
+    atomic_store_explicit(&site->rate, rate, memory_order_relaxed);
+    atomic_store_explicit(&site->generation, generation, memory_order_release);
+}
+
+/*
+ * Token bucket in its GCRA form: one atomic "theoretical arrival time" instead of a
+ * token count and a refill time, so concurrent callers only need a compare-and-swap.
+ * A full bucket holds one second worth of messages.
+ */
+int log_site_admit(LogSite *site, LogLevel level, const char *file, int line) {
+    unsigned int rate = atomic_load_explicit(&site->rate, memory_order_relaxed);
+    if (rate == 0) return 1;
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    long long now = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    long long interval = 1000000000LL / rate;
+    long long tolerance = 1000000000LL - interval;
+
+    long long tat = atomic_load_explicit(&site->rate_tat, memory_order_relaxed);
+    for (;;) {
+        long long start = tat < now ? now : tat;
+        if (start - now > tolerance) {
+            atomic_fetch_add_explicit(&site->suppressed, 1, memory_order_relaxed);
+            return 0;
+        }
+        if (atomic_compare_exchange_weak_explicit(&site->rate_tat, &tat, start + interval,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    /* Summarise what the bucket dropped before this message goes out */
+    if (atomic_load_explicit(&site->suppressed, memory_order_relaxed) == 0) return 1;
+    unsigned long suppressed = atomic_exchange_explicit(&site->suppressed, 0, memory_order_relaxed);
+    if (suppressed > 0) {
+        log_emit(level, "%lu messages suppressed at %s:%d (rate limit %u/s)", suppressed, file, line, rate);
+    }
+    return 1;
+}
+
+/* writev everything, continuing after partial writes */
+static void write_all(int fd, struct iovec *iov, int count) {
+    while (count > 0) {
+        ssize_t written = writev(fd, iov, count);
+        if (written < 0) return; /* Nowhere to report it, the messages are lost */
+
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+/* Text goes to the file sink when one is open, binary records to their own file */
+static void write_output(int binary, struct iovec *iov, int count) {
+    if (binary) {
+        write_all(log_binary_fd, iov, count);
+    } else if (log_file_active()) {
+        log_file_write(iov, count);
+    } else {
+        write_all(STDOUT_FILENO, iov, count);
+    }
+}
+
+/*
+ * Write up to LOG_FLUSH_BATCH slots of one ring, returns the number written.
+ * Consecutive slots for the same output go out in a single writev, each text
+ * message preceded by its timestamp formatted here rather than by the caller.
+ */
+static size_t flush_ring(LogRing *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    struct iovec iov[2 * LOG_FLUSH_BATCH];
+    char stamps[LOG_FLUSH_BATCH][LOG_TIMESTAMP_SIZE + 3];
+    int slots = 0;
+    int count = 0;
+    int binary = 0;
+
+    for (size_t i = tail; i != head && slots < LOG_FLUSH_BATCH; i++, slots++) {
+        LogSlot *slot = &ring->slots[i & (LOG_RING_SLOTS - 1)];
+        if (count > 0 && slot->binary != binary) {
+            write_output(binary, iov, count);
+            atomic_store_explicit(&ring->tail, i, memory_order_release);
+            count = 0;
+        }
+        binary = slot->binary;
+        if (slot->time.tv_sec != 0) {
+            char *stamp = stamps[slots];
+            stamp[0] = '[';
+            log_timestamp_format(&slot->time, stamp + 1);
+            memcpy(stamp + LOG_TIMESTAMP_SIZE, "] ", 2);
+            iov[count].iov_base = stamp;
+            iov[count].iov_len = LOG_TIMESTAMP_SIZE + 2;
+            count++;
+        }
+        iov[count].iov_base = slot->text;
+        iov[count].iov_len = slot->len;
+        count++;
+    }
+    if (slots == 0) return 0;
+
+    write_output(binary, iov, count);
+    atomic_store_explicit(&ring->tail, tail + slots, memory_order_release);
+    return slots;
+}
+
+/* Report drops from the flusher so the overflowing caller never pays for it */
+static void report_drops(unsigned long *reported) {
+    unsigned long dropped = atomic_load_explicit(&dropped_messages, memory_order_relaxed);
+    if (dropped == *reported) return;
+
+    char text[96];
+    struct iovec iov;
+    iov.iov_base = text;
+    iov.iov_len = snprintf(text, sizeof(text), "[%s] %lu log messages dropped (ring buffer full)\n",
+                           log_level_names[LOG_WARNING], dropped - *reported);
+    write_output(0, &iov, 1);
+    *reported = dropped;
+}
+
+static void *flusher_main(void *arg) {
+    (void)arg;
+    unsigned long reported_drops = atomic_load(&dropped_messages);
+    struct timespec idle = {0, LOG_FLUSH_IDLE_NS};
+
+    for (;;) {
+        int stopping = atomic_load_explicit(&flusher_stop, memory_order_acquire);
+        size_t flushed = 0;
+
+        for (LogRing *ring = atomic_load(&ring_list); ring != NULL; ring = ring->next) {
+            flushed += flush_ring(ring);
+        }
+        report_drops(&reported_drops);
+
+        /* Exit only after a full pass found nothing left to write */
+        if (flushed == 0) {
+            if (stopping) break;
+            nanosleep(&idle, NULL);
+        }
+    }
+    return NULL;
+}
+
+int log_async_start(LogOverflowPolicy policy) {
+    if (atomic_load(&async_enabled)) return 0;
+
+    /* Anything printed synchronously so far must come out first */
+    fflush(stdout);
+
+    overflow_policy = policy;
+    atomic_store(&flusher_stop, 0);
+    if (pthread_create(&flusher_thread, NULL, flusher_main, NULL) != 0) {
+        return -1;
+    }
+    atomic_store(&async_enabled, 1);
     return 0;
 }
 
+void log_async_stop(void) {
+    if (!atomic_exchange(&async_enabled, 0)) return;
+
+    /*
+     * A producer that saw async mode on is still putting its message in. The flusher keeps
+     * running so a producer blocked on a full ring can finish, and it is told to stop only
+     * when no ring is busy, so its last empty pass comes after every message.
+     */
+    for (LogRing *ring = atomic_load(&ring_list); ring != NULL; ring = ring->next) {
+        while (atomic_load(&ring->writing)) sched_yield();
+    }
+
+    atomic_store_explicit(&flusher_stop, 1, memory_order_release);
+    pthread_join(flusher_thread, NULL);
+}
+
+void log_flush(void) {
+    LogRing *ring = thread_ring;
+    if (ring == NULL || !atomic_load(&async_enabled)) {
+        fflush(stdout);
+        return;
+    }
+
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    while (atomic_load_explicit(&ring->tail, memory_order_acquire) != head) {
+        sched_yield();
+    }
+}
+
+unsigned long log_dropped_messages(void) {
+    return atomic_load_explicit(&dropped_messages, memory_order_relaxed);
+}
@@ -0,0 +1,296 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <signal.h>
+#include <stdatomic.h>
+
+/* Define log levels */
+typedef enum {
+    LOG_DISABLED = 0,
+    LOG_ERROR,
+    LOG_WARNING,
+    LOG_INFO,
+    LOG_DEBUG
+} LogLevel;
+
+/* What an async caller does when its ring buffer is full */
+typedef enum {
+    LOG_OVERFLOW_BLOCK = 0,  /* Wait for the flusher to make room, nothing is lost */
+    LOG_OVERFLOW_DROP        /* Drop the message and count it, the caller never waits */
+} LogOverflowPolicy;
+
+/* Written from signal handlers, always a LogLevel value. Change it with log_set_level */
+extern atomic_int current_log_level;
+extern const char *log_level_names[];
+
+/* Bumped on every level or rate limit change, call sites recompute their cached settings */
+extern atomic_uint log_config_generation;
+
+/*
+ * Module of the call sites in a source file: define LOG_MODULE_NAME before including
+ * this header. Each module can have its own level and rate limit, set with set_log_level.
+ */
+#ifndef LOG_MODULE_NAME
+#define LOG_MODULE_NAME "main"
+#endif
+
+#define LOG_MAX_MODULES 64
+
+/*
+ * State kept by every LOG_* expansion in a static variable. The effective level and
+ * rate of its module are cached here and only recomputed when the generation changes.
+ */
+typedef struct {
+    atomic_uint generation;     /* log_config_generation the cached fields belong to */
+    atomic_int level;           /* Effective level of the site's module */
+    atomic_uint rate;           /* Messages per second allowed, 0 for unlimited */
+    atomic_int module;          /* Index in the module table, -1 until registered */
+    atomic_int binary_id;       /* Format id in binary mode, LOG_SITE_UNREGISTERED until known */
+    atomic_llong rate_tat;      /* Token bucket as a theoretical arrival time, in ns */
+    atomic_ulong suppressed;    /* Messages dropped by the rate limit since the last one logged */
+} LogSite;
+
+#define LOG_SITE_UNREGISTERED (-2)
+#define LOG_SITE_INIT {0, LOG_DISABLED, 0, -1, LOG_SITE_UNREGISTERED, 0, 0}
+
+/* Set the level of the whole process, modules with their own level keep it */
+void log_set_level(LogLevel level);
+
+/*
+ * Register a module by name (the string must stay valid), returns its index or -1 when
+ * the table is full. Call sites do it on first use; registering at startup lets
+ * set_log_level address a module before any of its messages was logged.
+ */
+int log_module_register(const char *name);
+
+/* Set a module's level, or LOG_LEVEL_INHERIT to follow the process level again */
+#define LOG_LEVEL_INHERIT (-1)
+int log_module_set_level(const char *name, int level);
+
+/* Recompute a call site's cached level and rate */
+void log_site_refresh(LogSite *site, const char *module);
+
+/* Token bucket check for a rate-limited call site, returns 1 when the message may be logged */
+int log_site_admit(LogSite *site, LogLevel level, const char *file, int line);
+
+static inline int log_site_enabled(LogSite *site, int level, const char *module) {
+    if (atomic_load_explicit(&site->generation, memory_order_acquire) !=
+        atomic_load_explicit(&log_config_generation, memory_order_relaxed)) {
+        log_site_refresh(site, module);
+    }
+    return level <= atomic_load_explicit(&site->level, memory_order_relaxed);
+}
+
+/*
+ * Control channel: SIGRTMIN..SIGRTMIN+4 set the global level directly, LOG_CONTROL_SIGNAL
+ * sent with sigqueue carries a command in its int payload:
+ *   bits 28-30 command, bits 16-27 value, bits 0-15 module name hash (0 for the whole process)
+ */
+#define LOG_CONTROL_SIGNAL (SIGRTMIN + 5)
+
+typedef enum {
+    LOG_CTL_LEVEL = 1,          /* value is a LogLevel */
+    LOG_CTL_MODULE_LEVEL,       /* value is a LogLevel for one module */
+    LOG_CTL_RATE_LIMIT,         /* value is messages per second per call site, 0 for unlimited */
+    LOG_CTL_MODULE_RATE_LIMIT   /* same, for one module */
+} LogControlCommand;
+
+#define LOG_CONTROL_MAX_VALUE 0xfff
+#define LOG_CONTROL_PAYLOAD(command, value, module_hash) \
+    ((int)(((unsigned)(command) << 28) | (((unsigned)(value) & 0xfff) << 16) | ((unsigned)(module_hash) & 0xffff)))
+#define LOG_CONTROL_COMMAND(payload) (((unsigned)(payload) >> 28) & 0x7)
+#define LOG_CONTROL_VALUE(payload)   (((unsigned)(payload) >> 16) & 0xfff)
+#define LOG_CONTROL_MODULE(payload)  ((unsigned)(payload) & 0xffff)
+
+/* 16-bit FNV-1a fold of a module name, never 0, computed the same way by set_log_level */
+static inline unsigned log_module_hash(const char *name) {
+    unsigned hash = 2166136261u;
+    while (*name != '\0') {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    hash = (hash >> 16) ^ (hash & 0xffff);
+    return hash != 0 ? hash : 1;
+}
+
+/*
+ * Install async-signal-safe handlers for the level and control signals. The handlers
+ * only store atomics, the "Log level changed" notice is printed by log_control_poll.
+ */
+int log_install_signal_handlers(void);
+
+/* Report control changes received since the last call, log_message calls it too */
+void log_control_poll(void);
+
+/* Logging function, checks the process level */
+void log_message(LogLevel level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/* Log without any level check, LOG_AT has already checked the call site's module level */
+void log_emit(LogLevel level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+
+/*
+ * Switch to asynchronous mode: callers format into a per-thread ring buffer and
+ * a background thread writes batches with writev. Returns 0 on success.
+ */
+int log_async_start(LogOverflowPolicy policy);
+
+/* Drain every ring buffer, stop the flusher thread and go back to synchronous output */
+void log_async_stop(void);
+
+/* Wait until everything this thread logged asynchronously has been written */
+void log_flush(void);
+
+/* Number of messages dropped because a ring buffer was full */
+unsigned long log_dropped_messages(void);
+
+/* Structured logging: typed key-value fields rendered as one logfmt or JSON line */
+typedef enum {
+    LOG_STRUCTURED_LOGFMT = 0,  /* level=INFO file=main.c line=12 tid=4242 msg="..." key=value */
+    LOG_STRUCTURED_JSON         /* {"level":"INFO","file":"main.c",...,"key":value} */
+} LogStructuredFormat;
+
+typedef enum {
+    LOG_FIELD_STR = 0,
+    LOG_FIELD_INT,
+    LOG_FIELD_UINT,
+    LOG_FIELD_DOUBLE,
+    LOG_FIELD_BOOL
+} LogFieldType;
+
+typedef struct {
+    const char *key;
+    LogFieldType type;
+    union {
+        const char *s;
+        long long i;
+        unsigned long long u;
+        double d;
+        int b;
+    } value;
+} LogField;
+
+#define LOG_STR(k, v)    ((LogField){(k), LOG_FIELD_STR, {.s = (v)}})
+#define LOG_INT(k, v)    ((LogField){(k), LOG_FIELD_INT, {.i = (v)}})
+#define LOG_UINT(k, v)   ((LogField){(k), LOG_FIELD_UINT, {.u = (v)}})
+#define LOG_DOUBLE(k, v) ((LogField){(k), LOG_FIELD_DOUBLE, {.d = (v)}})
+#define LOG_BOOL(k, v)   ((LogField){(k), LOG_FIELD_BOOL, {.b = (v) != 0}})
+
+void log_set_structured_format(LogStructuredFormat format);
+
+/*
+ * Render level, file, line, thread id and the fields into the calling thread's
+ * preallocated buffer and write the line, no heap allocation. Fields that do not
+ * fit are dropped and the line is marked truncated.
+ */
+void log_structured(LogLevel level, const char *file, int line, const LogField *fields, int count);
+
+/* File sink settings */
+typedef struct {
+    size_t segment_size;        /* Bytes per segment, preallocated and mapped, rotated when full */
+    int rotate_seconds;         /* Also rotate a segment this old, 0 to rotate by size only */
+    int compress;               /* gzip rotated segments in the background */
+} LogFileOptions;
+
+/*
+ * Send text output to a file instead of stdout. Rotated segments are renamed to
+ * <path>.<YYYYmmdd-HHMMSS>.<n> (plus .gz when compressed). Returns 0 on success, -1
+ * also when a file already at path cannot be moved aside; it is never truncated.
+ */
+int log_file_open(const char *path, const LogFileOptions *options);
+
+/* Cut the current segment to its used size and close it, waits for running compressions */
+void log_file_close(void);
+
+/*
+ * Binary logging: each LOG_* call site registers its format string once, after that a
+ * message is only the format id, a timestamp and the raw argument bytes, rendered
+ * later by log_decoder. Messages go through the async rings when they are running.
+ */
+extern int log_binary_enabled;
+
+/* Start writing binary records to path (truncated), returns 0 on success */
+int log_binary_open(const char *path);
+
+/* Stop binary logging and close the file, call log_async_stop first when async */
+void log_binary_close(void);
+
+/*
+ * Describe a call site in the file's dictionary. Returns its id, or -1 when the
+ * format cannot be encoded (e.g. %n, %ls, too many arguments) and text logging must be used.
+ */
+int log_binary_register(LogLevel level, const char *file, int line, const char *format);
+
+/* Encode one message for a registered call site, the arguments must match its format */
+void log_binary_write(int id, ...);
+
+/*
+ * Lowest-priority level compiled into the program, e.g. -DLOG_COMPILED_LEVEL=LOG_INFO.
+ * Calls above it are removed by the compiler together with their arguments.
+ */
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_DEBUG
+#endif
+
+/* Relaxed load, a level change only has to become visible eventually */
+#define LOG_LEVEL_ENABLED(level) \
+    ((int)(level) <= atomic_load_explicit(&current_log_level, memory_order_relaxed))
+
+/*
+ * Check the level before evaluating any argument: the first test is a compile-time
+ * constant, the second compares with the level cached in the call site and is hinted
+ * as taken only for levels up to INFO, so disabled DEBUG calls in hot loops fall
+ * through without a call or a mispredicted branch. Rate limiting costs one more load
+ * while it is off.
+ */
+#define LOG_SITE_PASSES(site, level)                                                    \
+    ((level) <= LOG_COMPILED_LEVEL &&                                                   \
+     __builtin_expect(log_site_enabled(&(site), level, LOG_MODULE_NAME), (level) <= LOG_INFO) && \
+     (atomic_load_explicit(&(site).rate, memory_order_relaxed) == 0 ||                  \
+      log_site_admit(&(site), level, __FILE__, __LINE__)))
+
+/* printf-style message, in binary mode the site also keeps its format id */
+#define LOG_AT(level, format, ...)                                                      \
+    do {                                                                                \
+        static LogSite log_site = LOG_SITE_INIT;                                        \
+        if (LOG_SITE_PASSES(log_site, level)) {                                         \
+            if (log_binary_enabled) {                                                   \
+                int log_id = atomic_load_explicit(&log_site.binary_id,                  \
+                                                  memory_order_acquire);                \
+                if (log_id == LOG_SITE_UNREGISTERED) {                                  \
+                    log_id = log_binary_register(level, __FILE__, __LINE__, format);    \
+                    atomic_store_explicit(&log_site.binary_id, log_id,                  \
+                                          memory_order_release);                        \
+                }                                                                       \
+                if (log_id >= 0) {                                                      \
+                    log_binary_write(log_id, ##__VA_ARGS__);                            \
+                    break;                                                              \
+                }                                                                       \
+            }                                                                           \
+            log_emit(level, format, ##__VA_ARGS__);                                     \
+        }                                                                               \
+    } while (0)
+
+/* Structured message: the fields are built on the stack only when the site passes */
+#define LOG_KV_AT(level, message, ...)                                                  \
+    do {                                                                                \
+        static LogSite log_site = LOG_SITE_INIT;                                        \
+        if (LOG_SITE_PASSES(log_site, level)) {                                         \
+            const LogField log_fields[] = {LOG_STR("msg", message), ##__VA_ARGS__};     \
+            log_structured(level, __FILE__, __LINE__, log_fields,                       \
+                           sizeof(log_fields) / sizeof(log_fields[0]));                 \
+        }                                                                               \
+    } while (0)
+
+/* Logging macros */
+#define LOG_ERROR(...)   LOG_AT(LOG_ERROR, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LOG_WARNING, __VA_ARGS__)
+#define LOG_INFO(...)    LOG_AT(LOG_INFO, __VA_ARGS__)
+#define LOG_DEBUG(...)   LOG_AT(LOG_DEBUG, __VA_ARGS__)
+
+/* Structured logging macros, e.g. LOG_INFO_KV("order placed", LOG_INT("id", id), LOG_STR("item", name)) */
+#define LOG_ERROR_KV(...)   LOG_KV_AT(LOG_ERROR, __VA_ARGS__)
+#define LOG_WARNING_KV(...) LOG_KV_AT(LOG_WARNING, __VA_ARGS__)
+#define LOG_INFO_KV(...)    LOG_KV_AT(LOG_INFO, __VA_ARGS__)
+#define LOG_DEBUG_KV(...)   LOG_KV_AT(LOG_DEBUG, __VA_ARGS__)
+
+#endif /* LOGGER_H */
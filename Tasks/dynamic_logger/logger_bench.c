@@ -0,0 +1,312 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <pthread.h>
+#include "logger.h"
+
+#define DEFAULT_THREADS     4
+#define DEFAULT_MESSAGES    200000
+#define DEFAULT_OUTPUT      "/dev/null"
+#define DEFAULT_FILE_OUTPUT "/tmp/logger_bench.log"
+
+/*
+ * Caller latency histogram: each power of two of nanoseconds split into HIST_STEPS
+ * linear steps (~12% precision, finer than the clock reads around a call). At 4KB per
+ * thread it stays out of the cache lines of the logger being measured.
+ */
+#define HIST_STEP_BITS      3
+#define HIST_STEPS          (1 << HIST_STEP_BITS)
+#define HIST_BUCKETS        (64 * HIST_STEPS)
+
+/* Where the messages go */
+typedef enum {
+    BACKEND_SYNC = 0,           /* printf on the calling thread */
+    BACKEND_ASYNC,              /* Per-thread rings drained by the flusher */
+    BACKEND_FILE,               /* Synchronous, into the mmap file sink */
+    BACKEND_FILE_ASYNC,         /* Rings drained into the mmap file sink */
+    BACKEND_BINARY,             /* Binary records written by the caller */
+    BACKEND_BINARY_ASYNC,       /* Binary records through the rings */
+    BACKEND_COUNT
+} Backend;
+
+const char *backend_names[] = {"sync", "async", "file", "file-async", "binary", "binary-async"};
+
+typedef struct {
+    unsigned long counts[HIST_BUCKETS];
+    unsigned long total;
+    unsigned long long sum_ns;
+    unsigned long long max_ns;
+} Histogram;
+
+typedef struct {
+    int id;
+    pthread_t thread;
+    LogLevel level;
+    Histogram latency;
+} Worker;
+
+/* Benchmark configuration shared read-only by all workers */
+static int num_messages = DEFAULT_MESSAGES;
+static const char *output_path = DEFAULT_OUTPUT;
+static const char *file_output_path = DEFAULT_FILE_OUTPUT;
+static pthread_barrier_t start_barrier;
+
+void print_usage(const char *progname);
+int parse_backends(const char *list, int *selected);
+void run_benchmark(FILE *report, Backend backend, LogLevel level, int num_threads, LogOverflowPolicy policy);
+void *worker_main(void *arg);
+long long now_ns(void);
+void histogram_record(Histogram *h, unsigned long long value_ns);
+void histogram_merge(Histogram *dst, const Histogram *src);
+unsigned long long histogram_percentile(const Histogram *h, double percentile);
+
+int main(int argc, char *argv[]) {
+    int num_threads = DEFAULT_THREADS;
+    int selected[BACKEND_COUNT] = {1, 1, 1, 1, 1, 1};
+    LogLevel process_level = LOG_INFO;
+    LogOverflowPolicy policy = LOG_OVERFLOW_BLOCK;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:n:b:l:do:F:h")) != -1) {
+        switch (opt) {
+        case 't': num_threads = atoi(optarg); break;
+        case 'n': num_messages = atoi(optarg); break;
+        case 'l': process_level = atoi(optarg); break;
+        case 'd': policy = LOG_OVERFLOW_DROP; break;
+        case 'o': output_path = optarg; break;
+        case 'F': file_output_path = optarg; break;
+        case 'b':
+            if (parse_backends(optarg, selected) == -1) {
+                fprintf(stderr, "Invalid backend list '%s'\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (num_threads <= 0 || num_messages <= 0 || process_level < LOG_DISABLED || process_level > LOG_DEBUG) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    /* Results keep the terminal, the log output itself goes to output_path */
+    FILE *report = fdopen(dup(STDOUT_FILENO), "w");
+    int null_fd = open("/dev/null", O_WRONLY);
+    if (report == NULL || null_fd == -1 || dup2(null_fd, STDOUT_FILENO) == -1) {
+        perror("Failed to redirect stdout");
+        return 1;
+    }
+    close(null_fd);
+
+    log_set_level(process_level);
+
+    fprintf(report, "%d threads x %d messages, process level %s, %s when a ring is full\n\n",
+            num_threads, num_messages, log_level_names[process_level],
+            policy == LOG_OVERFLOW_DROP ? "drop" : "block");
+    fprintf(report, "%-13s %-8s %12s %9s %9s %9s %9s %9s %10s\n",
+            "backend", "level", "msgs/s", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns", "dropped");
+
+    for (int backend = 0; backend < BACKEND_COUNT; backend++) {
+        if (!selected[backend]) continue;
+        for (LogLevel level = LOG_ERROR; level <= LOG_DEBUG; level++) {
+            run_benchmark(report, backend, level, num_threads, policy);
+        }
+    }
+
+    fclose(report);
+    return 0;
+}
+
+void print_usage(const char *progname) {
+    printf("Usage: %s [-t threads] [-n messages] [-b backends] [-l level] [-d] [-o file] [-F file]\n", progname);
+    printf("  -t threads   Logging threads (default %d)\n", DEFAULT_THREADS);
+    printf("  -n messages  Messages per thread for each backend and level (default %d)\n", DEFAULT_MESSAGES);
+    printf("  -b backends  Comma separated subset of sync,async,file,file-async,binary,binary-async\n");
+    printf("  -l level     Process log level 0-4, messages above it measure the disabled path (default 3, INFO)\n");
+    printf("  -d           Drop messages when a ring is full instead of waiting\n");
+    printf("  -o file      Output of the stdout and binary backends (default %s)\n", DEFAULT_OUTPUT);
+    printf("  -F file      Output of the file sink backends, removed after each run (default %s)\n",
+           DEFAULT_FILE_OUTPUT);
+}
+
+/* Parse "sync,binary" into the selected flags */
+int parse_backends(const char *list, int *selected) {
+    char copy[128];
+    if (strlen(list) >= sizeof(copy)) return -1;
+    strcpy(copy, list);
+    memset(selected, 0, BACKEND_COUNT * sizeof(int));
+
+    char *saveptr;
+    for (char *name = strtok_r(copy, ",", &saveptr); name != NULL; name = strtok_r(NULL, ",", &saveptr)) {
+        int backend;
+        for (backend = 0; backend < BACKEND_COUNT; backend++) {
+            if (strcmp(name, backend_names[backend]) == 0) break;
+        }
+        if (backend == BACKEND_COUNT) return -1;
+        selected[backend] = 1;
+    }
+    return 0;
+}
+
+/* Open the backend's outputs, returns -1 when one cannot be opened */
+static int start_backend(Backend backend, LogOverflowPolicy policy) {
+    LogFileOptions file_options = {64 * 1024 * 1024, 0, 0};
+
+    if (backend == BACKEND_SYNC || backend == BACKEND_ASYNC) {
+        int fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd == -1 || dup2(fd, STDOUT_FILENO) == -1) return -1;
+        close(fd);
+    }
+    if (backend == BACKEND_FILE || backend == BACKEND_FILE_ASYNC) {
+        /* The sink must preallocate and map it, /dev/null will not do; start from nothing */
+        unlink(file_output_path);
+        if (log_file_open(file_output_path, &file_options) != 0) return -1;
+    }
+    if ((backend == BACKEND_BINARY || backend == BACKEND_BINARY_ASYNC) && log_binary_open(output_path) != 0) {
+        return -1;
+    }
+    if ((backend == BACKEND_ASYNC || backend == BACKEND_FILE_ASYNC || backend == BACKEND_BINARY_ASYNC) &&
+        log_async_start(policy) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Drain and close everything start_backend opened */
+static void stop_backend(Backend backend) {
+    log_async_stop();
+    log_binary_close();
+    log_file_close();
+    fflush(stdout);
+    if (backend == BACKEND_FILE || backend == BACKEND_FILE_ASYNC) unlink(file_output_path);
+}
+
+void run_benchmark(FILE *report, Backend backend, LogLevel level, int num_threads, LogOverflowPolicy policy) {
+    Worker *workers = calloc(num_threads, sizeof(Worker));
+    if (workers == NULL) {
+        fprintf(report, "%-13s %-8s out of memory\n", backend_names[backend], log_level_names[level]);
+        return;
+    }
+    if (start_backend(backend, policy) == -1) {
+        fprintf(report, "%-13s %-8s cannot open the output\n", backend_names[backend], log_level_names[level]);
+        stop_backend(backend);
+        free(workers);
+        return;
+    }
+
+    unsigned long dropped_before = log_dropped_messages();
+    pthread_barrier_init(&start_barrier, NULL, num_threads + 1);
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].id = i;
+        workers[i].level = level;
+        pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    long long started = now_ns();
+    Histogram *total = calloc(1, sizeof(Histogram));
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        if (total != NULL) histogram_merge(total, &workers[i].latency);
+    }
+    double seconds = (now_ns() - started) / 1e9;
+
+    /* Async backends finish writing here, outside the measured caller time */
+    stop_backend(backend);
+    pthread_barrier_destroy(&start_barrier);
+
+    if (total != NULL) {
+        fprintf(report, "%-13s %-8s %12.0f %9llu %9llu %9llu %9llu %9llu %10lu\n",
+                backend_names[backend], log_level_names[level], total->total / seconds,
+                histogram_percentile(total, 50.0), histogram_percentile(total, 90.0),
+                histogram_percentile(total, 99.0), histogram_percentile(total, 99.9),
+                total->max_ns, log_dropped_messages() - dropped_before);
+    }
+    free(total);
+    free(workers);
+}
+
+/*
+ * One call site per level: a LOG_* expansion caches its level and binary format id,
+ * so the level must be a constant at each site.
+ */
+static void log_one(LogLevel level, int thread, int i) {
+    switch (level) {
+    case LOG_ERROR:   LOG_ERROR("bench thread %d message %d value %.3f tag %s", thread, i, i * 0.5, "error"); break;
+    case LOG_WARNING: LOG_WARNING("bench thread %d message %d value %.3f tag %s", thread, i, i * 0.5, "warning"); break;
+    case LOG_INFO:    LOG_INFO("bench thread %d message %d value %.3f tag %s", thread, i, i * 0.5, "info"); break;
+    case LOG_DEBUG:   LOG_DEBUG("bench thread %d message %d value %.3f tag %s", thread, i, i * 0.5, "debug"); break;
+    default: break;
+    }
+}
+
+void *worker_main(void *arg) {
+    Worker *worker = arg;
+    pthread_barrier_wait(&start_barrier);
+
+    for (int i = 0; i < num_messages; i++) {
+        long long started = now_ns();
+        log_one(worker->level, worker->id, i);
+        histogram_record(&worker->latency, now_ns() - started);
+    }
+    return NULL;
+}
+
+long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Bucket of a value: the power of two it lies in, then the next HIST_STEP_BITS bits; exact below HIST_STEPS */
+static int histogram_bucket(unsigned long long value_ns) {
+    if (value_ns < HIST_STEPS) return (int)value_ns;
+    int power = 63 - __builtin_clzll(value_ns);
+    int step = (int)(value_ns >> (power - HIST_STEP_BITS)) & (HIST_STEPS - 1);
+    return power * HIST_STEPS + step;
+}
+
+/* Largest value that lands in a bucket */
+static unsigned long long histogram_bucket_limit(int bucket) {
+    if (bucket < HIST_STEPS) return bucket;
+    int power = bucket / HIST_STEPS;
+    unsigned long long step_size = 1ULL << (power - HIST_STEP_BITS);
+    return (1ULL << power) + (bucket % HIST_STEPS + 1) * step_size - 1;
+}
+
+void histogram_record(Histogram *h, unsigned long long value_ns) {
+    h->counts[histogram_bucket(value_ns)]++;
+    h->total++;
+    h->sum_ns += value_ns;
+    if (value_ns > h->max_ns) h->max_ns = value_ns;
+}
+
+void histogram_merge(Histogram *dst, const Histogram *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum_ns += src->sum_ns;
+    if (src->max_ns > dst->max_ns) dst->max_ns = src->max_ns;
+}
+
+unsigned long long histogram_percentile(const Histogram *h, double percentile) {
+    if (h->total == 0) return 0;
+
+    unsigned long target = (unsigned long)(h->total * percentile / 100.0 + 0.5);
+    if (target == 0) target = 1;
+
+    unsigned long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            unsigned long long limit = histogram_bucket_limit(i);
+            return limit < h->max_ns ? limit : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
@@ -0,0 +1,114 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include "logger.h"
+
+static volatile sig_atomic_t running = 1;
+
+/* SIGINT/SIGTERM: leave the loop so the log files are closed cleanly */
+static void stop_handler(int signo) {
+    (void)signo;
+    running = 0;
+}
+
+/* Function to display usage instructions */
+void print_usage(const char *progname) {
+    printf("Usage: %s [-a block|drop] [-b file] [-f file [-s MiB] [-r seconds] [-z]] [-k logfmt|json]\n", progname);
+    printf("  -a block  Asynchronous logging, callers wait when their ring buffer is full\n");
+    printf("  -a drop   Asynchronous logging, messages are dropped and counted when it is full\n");
+    printf("  -b file   Binary logging to file, read it with log_decoder\n");
+    printf("  -f file   Text logging to file instead of stdout\n");
+    printf("  -s MiB    Rotate the file at this size (default 16)\n");
+    printf("  -r secs   Also rotate the file after this many seconds\n");
+    printf("  -z        gzip rotated files in the background\n");
+    printf("  -k fmt    Also log a structured line per iteration, as logfmt or json\n");
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    int async_mode = 0;
+    const char *binary_path = NULL;
+    const char *file_path = NULL;
+    LogFileOptions file_options = {16 * 1024 * 1024, 0, 0};
+    int structured = 0;
+    LogOverflowPolicy policy = LOG_OVERFLOW_BLOCK;
+    while ((opt = getopt(argc, argv, "a:b:f:s:r:zk:")) != -1) {
+        if (opt == 'a' && strcmp(optarg, "block") == 0) {
+            async_mode = 1;
+            policy = LOG_OVERFLOW_BLOCK;
+        } else if (opt == 'a' && strcmp(optarg, "drop") == 0) {
+            async_mode = 1;
+            policy = LOG_OVERFLOW_DROP;
+        } else if (opt == 'b') {
+            binary_path = optarg;
+        } else if (opt == 'f') {
+            file_path = optarg;
+        } else if (opt == 's' && atoi(optarg) > 0) {
+            file_options.segment_size = (size_t)atoi(optarg) * 1024 * 1024;
+        } else if (opt == 'r' && atoi(optarg) > 0) {
+            file_options.rotate_seconds = atoi(optarg);
+        } else if (opt == 'z') {
+            file_options.compress = 1;
+        } else if (opt == 'k' && (strcmp(optarg, "logfmt") == 0 || strcmp(optarg, "json") == 0)) {
+            structured = 1;
+            log_set_structured_format(strcmp(optarg, "json") == 0 ? LOG_STRUCTURED_JSON : LOG_STRUCTURED_LOGFMT);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* Register signal handlers */
+    if (log_install_signal_handlers() == -1) {
+        perror("Failed to install the signal handlers");
+        return 1;
+    }
+
+    printf("Logger started. PID: %d\n", getpid());
+    printf("- Use SIGRTMIN to Disable logger.\n- Use SIGRTMIN+1 to set looger to error.\n");
+    printf("- Use SIGRTMIN+2 set looger to warning.\n- Use SIGRTMIN+3 to set looger to info.\n- Use SIGRTMIN+4 to set looger to debug.\n");
+    printf("---------------------------------------------------- \n");
+
+    if (file_path != NULL && log_file_open(file_path, &file_options) != 0) {
+        perror("Failed to open the log file");
+        return 1;
+    }
+    if (binary_path != NULL && log_binary_open(binary_path) != 0) {
+        perror("Failed to open the binary log file");
+        return 1;
+    }
+    if (async_mode && log_async_start(policy) != 0) {
+        perror("Failed to start the async logger");
+        return 1;
+    }
+
+    struct sigaction stop_action;
+    memset(&stop_action, 0, sizeof(stop_action));
+    stop_action.sa_handler = stop_handler;
+    sigaction(SIGINT, &stop_action, NULL);
+    sigaction(SIGTERM, &stop_action, NULL);
+
+    /* Simulated logging loop */
+    for (int iteration = 0; running; iteration++) {
+        log_control_poll();
+        LOG_ERROR("This is an ERROR message.");
+        LOG_WARNING("This is a WARNING message.");
+        LOG_INFO("This is an INFO message.");
+        LOG_DEBUG("This is a DEBUG message.");
+        if (structured) {
+            LOG_INFO_KV("This is a structured message.", LOG_INT("iteration", iteration),
+                        LOG_STR("mode", async_mode ? "async" : "sync"), LOG_BOOL("binary", binary_path != NULL));
+        }
+	log_flush(); /* Keep the separator after the lines written by the async flusher */
+	printf("---------------------------------------------------- \n");
+	fflush(stdout);
+	sleep(3);
+    }
+
+    log_async_stop();
+    log_binary_close();
+    log_file_close();
+    return 0;
+}
@@ -3,15 +3,27 @@
 #include <signal.h>
 #include <string.h>
 #include <unistd.h>
+#include "logger.h"
 
 /* Function to display usage instructions */
 void print_usage(const char *progname) {
-    printf("Usage: %s <PID> <level>\n", progname);
+    printf("Usage: %s <PID> <level> [module]\n", progname);
+    printf("       %s <PID> rate <messages per second, 0 for unlimited> [module]\n", progname);
     printf("Levels: disable, error, warning, info, debug\n");
 }
 
+/* Map a level name to its LogLevel, -1 when unknown */
+static int parse_level(const char *name) {
+    if (strcmp(name, "disable") == 0) return LOG_DISABLED;
+    if (strcmp(name, "error") == 0) return LOG_ERROR;
+    if (strcmp(name, "warning") == 0) return LOG_WARNING;
+    if (strcmp(name, "info") == 0) return LOG_INFO;
+    if (strcmp(name, "debug") == 0) return LOG_DEBUG;
+    return -1;
+}
+
 int main(int argc, char *argv[]) {
-    if (argc != 3) {
+    if (argc != 3 && argc != 4 && !(argc == 5 && strcmp(argv[2], "rate") == 0)) {
         print_usage(argv[0]);
         return 1;
     }
@@ -22,27 +34,47 @@ int main(int argc, char *argv[]) {
         return 1;
     }
 
-    int signal_to_send = 0;
+    int command;
+    int value;
+    const char *module = NULL;
 
-    /* Determine which signal to send */
-    if (strcmp(argv[2], "disable") == 0) signal_to_send = SIGRTMIN;
-    else if (strcmp(argv[2], "error") == 0) signal_to_send = SIGRTMIN+1;
-    else if (strcmp(argv[2], "warning") == 0) signal_to_send = SIGRTMIN+2;
-    else if (strcmp(argv[2], "info") == 0) signal_to_send = SIGRTMIN+3;
-    else if (strcmp(argv[2], "debug") == 0) signal_to_send = SIGRTMIN+4;
-    else {
-        fprintf(stderr, "Invalid log level.\n");
-        print_usage(argv[0]);
-        return 1;
+    /* Determine which command to send */
+    if (strcmp(argv[2], "rate") == 0) {
+        char *end;
+        long rate = argc >= 4 ? strtol(argv[3], &end, 10) : -1;
+        if (argc < 4 || *end != '\0' || rate < 0 || rate > LOG_CONTROL_MAX_VALUE) {
+            fprintf(stderr, "Invalid rate, expected 0 to %d messages per second.\n", LOG_CONTROL_MAX_VALUE);
+            return 1;
+        }
+        value = rate;
+        if (argc == 5) module = argv[4];
+        command = module ? LOG_CTL_MODULE_RATE_LIMIT : LOG_CTL_RATE_LIMIT;
+    } else {
+        value = parse_level(argv[2]);
+        if (value == -1) {
+            fprintf(stderr, "Invalid log level.\n");
+            print_usage(argv[0]);
+            return 1;
+        }
+        if (argc == 4) module = argv[3];
+        command = module ? LOG_CTL_MODULE_LEVEL : LOG_CTL_LEVEL;
     }
 
-    /* Send the signal */
-    if (kill(pid, signal_to_send) == -1) {
-        perror("Failed to send signal");
-        return 1;
+    /* A global level keeps using its own signal, everything else goes through the control signal */
+    if (command == LOG_CTL_LEVEL) {
+        if (kill(pid, SIGRTMIN + value) == -1) {
+            perror("Failed to send signal");
+            return 1;
+        }
+    } else {
+        union sigval payload;
+        payload.sival_int = LOG_CONTROL_PAYLOAD(command, value, module ? log_module_hash(module) : 0);
+        if (sigqueue(pid, LOG_CONTROL_SIGNAL, payload) == -1) {
+            perror("Failed to send signal");
+            return 1;
+        }
     }
 
-    printf("Log level change signal sent to PID %d.\n", pid);
+    printf("Log %s signal sent to PID %d.\n", command == LOG_CTL_LEVEL ? "level change" : "control", pid);
     return 0;
 }
-
@@ -0,0 +1,572 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+
+#define DEFAULT_HOST        "127.0.0.1"
+#define DEFAULT_PORT        8080
+#define DEFAULT_CONNECTIONS 16
+#define DEFAULT_THREADS     2
+#define DEFAULT_DURATION    10
+#define RESP_BUF_SIZE       (64 * 1024)
+#define REQ_BUF_SIZE        512
+#define MAX_EVENTS          256
+#define RETRY_INTERVAL_MS   100 /* How often connections that could not be reopened are tried again */
+
+/* Latency histogram: log-linear buckets in microseconds, ~1% precision */
+#define HIST_SUB_BITS       7
+#define HIST_SUB_COUNT      (1 << HIST_SUB_BITS)
+#define HIST_HALF_COUNT     (HIST_SUB_COUNT / 2)
+#define HIST_BUCKETS        (HIST_SUB_COUNT + (64 - HIST_SUB_BITS + 1) * HIST_HALF_COUNT)
+
+/* Request kinds the benchmark can mix */
+typedef enum {
+    REQ_FILE = 0,
+    REQ_DIR,
+    REQ_CGI,
+    REQ_KINDS
+} RequestKind;
+
+const char *request_kind_names[] = {"file", "dir", "cgi"};
+
+typedef enum {
+    CONN_CONNECTING,
+    CONN_WRITING,
+    CONN_READING
+} ConnState;
+
+typedef struct {
+    unsigned long counts[HIST_BUCKETS];
+    unsigned long total;
+    unsigned long long sum_us;
+    unsigned long long max_us;
+} Histogram;
+
+typedef struct {
+    int fd;
+    ConnState state;
+    int reused;                 /* Connection already served a response */
+    RequestKind kind;
+    char request[REQ_BUF_SIZE];
+    size_t request_len;
+    size_t written;
+    char *response;
+    size_t received;            /* Bytes in response, the headers and the part of the body that fits */
+    size_t total_received;      /* Bytes of the whole response read so far, including body bytes already dropped */
+    long long started_ns;
+    unsigned int seed;
+} Connection;
+
+typedef struct {
+    int id;
+    int num_connections;
+    pthread_t thread;
+    Histogram latency;
+    unsigned long requests[REQ_KINDS];
+    unsigned long status_2xx, status_4xx, status_5xx, status_other;
+    unsigned long errors;
+    unsigned long reconnects;
+    unsigned long long bytes;
+} Worker;
+
+/* Benchmark configuration shared read-only by all workers */
+static struct sockaddr_in server_addr;
+static const char *host = DEFAULT_HOST;
+static const char *request_paths[REQ_KINDS] = {"/index.html", "/", "/script.cgi"};
+static int request_weights[REQ_KINDS] = {100, 0, 0};
+static int total_weight = 100;
+static atomic_int stop_benchmark = 0;
+
+void print_usage(const char *progname);
+int parse_mix(const char *mix);
+void *worker_main(void *arg);
+long long now_ns(void);
+void histogram_record(Histogram *h, unsigned long long value_us);
+void histogram_merge(Histogram *dst, const Histogram *src);
+unsigned long long histogram_percentile(const Histogram *h, double percentile);
+
+int main(int argc, char *argv[]) {
+    int num_connections = DEFAULT_CONNECTIONS;
+    int num_threads = DEFAULT_THREADS;
+    int duration = DEFAULT_DURATION;
+    int port = DEFAULT_PORT;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "c:t:d:H:p:f:D:C:m:h")) != -1) {
+        switch (opt) {
+        case 'c': num_connections = atoi(optarg); break;
+        case 't': num_threads = atoi(optarg); break;
+        case 'd': duration = atoi(optarg); break;
+        case 'H': host = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 'f': request_paths[REQ_FILE] = optarg; break;
+        case 'D': request_paths[REQ_DIR] = optarg; break;
+        case 'C': request_paths[REQ_CGI] = optarg; break;
+        case 'm':
+            if (parse_mix(optarg) == -1) {
+                fprintf(stderr, "Invalid mix '%s', expected file:dir:cgi weights (e.g. 70:20:10)\n", optarg);
+                return 1;
+            }
+            break;
+        default:
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (num_connections <= 0 || num_threads <= 0 || duration <= 0 || port <= 0 || port > 65535) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (num_threads > num_connections) num_threads = num_connections;
+
+    /* Writes to connections the server closed must fail with EPIPE, not kill the benchmark */
+    signal(SIGPIPE, SIG_IGN);
+
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid IPv4 address: %s\n", host);
+        return 1;
+    }
+
+    printf("Running %ds test @ http://%s:%d\n", duration, host, port);
+    printf("  %d threads and %d connections, mix file:dir:cgi = %d:%d:%d\n",
+           num_threads, num_connections,
+           request_weights[REQ_FILE], request_weights[REQ_DIR], request_weights[REQ_CGI]);
+
+    Worker *workers = calloc(num_threads, sizeof(Worker));
+    if (!workers) {
+        perror("calloc");
+        return 1;
+    }
+
+    /* Spread the connections as evenly as possible across the threads */
+    long long start_ns = now_ns();
+    for (int i = 0; i < num_threads; i++) {
+        workers[i].id = i;
+        workers[i].num_connections = num_connections / num_threads + (i < num_connections % num_threads);
+        if (pthread_create(&workers[i].thread, NULL, worker_main, &workers[i]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+
+    sleep(duration);
+    atomic_store(&stop_benchmark, 1);
+
+    Worker total;
+    memset(&total, 0, sizeof(total));
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(workers[i].thread, NULL);
+        histogram_merge(&total.latency, &workers[i].latency);
+        for (int k = 0; k < REQ_KINDS; k++) total.requests[k] += workers[i].requests[k];
+        total.status_2xx += workers[i].status_2xx;
+        total.status_4xx += workers[i].status_4xx;
+        total.status_5xx += workers[i].status_5xx;
+        total.status_other += workers[i].status_other;
+        total.errors += workers[i].errors;
+        total.reconnects += workers[i].reconnects;
+        total.bytes += workers[i].bytes;
+    }
+    double elapsed = (now_ns() - start_ns) / 1e9;
+    unsigned long completed = total.latency.total;
+
+    printf("  Latency      avg %8.2fms  p50 %8.2fms  p99 %8.2fms  p999 %8.2fms  max %8.2fms\n",
+           completed ? total.latency.sum_us / (double)completed / 1000.0 : 0.0,
+           histogram_percentile(&total.latency, 50.0) / 1000.0,
+           histogram_percentile(&total.latency, 99.0) / 1000.0,
+           histogram_percentile(&total.latency, 99.9) / 1000.0,
+           total.latency.max_us / 1000.0);
+    printf("  %lu requests in %.2fs, %.2fMB read\n", completed, elapsed, total.bytes / (1024.0 * 1024.0));
+    for (int k = 0; k < REQ_KINDS; k++) {
+        if (request_weights[k] > 0) {
+            printf("    %-4s %-24s %lu\n", request_kind_names[k], request_paths[k], total.requests[k]);
+        }
+    }
+    printf("  Status 2xx: %lu, 4xx: %lu, 5xx: %lu, other: %lu\n",
+           total.status_2xx, total.status_4xx, total.status_5xx, total.status_other);
+    printf("  Socket errors: %lu, reconnects: %lu\n", total.errors, total.reconnects);
+    printf("Requests/sec: %10.2f\n", completed / elapsed);
+    printf("Transfer/sec: %10.2fKB\n", total.bytes / elapsed / 1024.0);
+
+    free(workers);
+    return 0;
+}
+
+void print_usage(const char *progname) {
+    printf("Usage: %s [options]\n", progname);
+    printf("  -c <n>     Number of concurrent keep-alive connections (default %d)\n", DEFAULT_CONNECTIONS);
+    printf("  -t <n>     Number of client threads (default %d)\n", DEFAULT_THREADS);
+    printf("  -d <sec>   Test duration in seconds (default %d)\n", DEFAULT_DURATION);
+    printf("  -H <ip>    Server IPv4 address (default %s)\n", DEFAULT_HOST);
+    printf("  -p <port>  Server port (default %d)\n", DEFAULT_PORT);
+    printf("  -f <path>  File request path (default /index.html)\n");
+    printf("  -D <path>  Directory request path (default /)\n");
+    printf("  -C <path>  CGI request path (default /script.cgi)\n");
+    printf("  -m <mix>   Request mix as file:dir:cgi weights (default 100:0:0)\n");
+}
+
+/* Parse "file:dir:cgi" weights such as "70:20:10" */
+int parse_mix(const char *mix) {
+    int weights[REQ_KINDS];
+    if (sscanf(mix, "%d:%d:%d", &weights[REQ_FILE], &weights[REQ_DIR], &weights[REQ_CGI]) != REQ_KINDS) {
+        return -1;
+    }
+
+    int sum = 0;
+    for (int k = 0; k < REQ_KINDS; k++) {
+        if (weights[k] < 0) return -1;
+        sum += weights[k];
+    }
+    if (sum == 0) return -1;
+
+    memcpy(request_weights, weights, sizeof(weights));
+    total_weight = sum;
+    return 0;
+}
+
+long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Map a value to its log-linear bucket: exact below HIST_SUB_COUNT, then HIST_SUB_BITS of precision */
+static int histogram_bucket(unsigned long long value) {
+    if (value < HIST_SUB_COUNT) return (int)value;
+    int shift = 63 - __builtin_clzll(value) - (HIST_SUB_BITS - 1);
+    int sub = (int)(value >> shift);
+    return HIST_SUB_COUNT + (shift - 1) * HIST_HALF_COUNT + (sub - HIST_HALF_COUNT);
+}
+
+/* Upper bound of the values that land in a bucket */
+static unsigned long long histogram_bucket_value(int bucket) {
+    if (bucket < HIST_SUB_COUNT) return bucket;
+    int shift = (bucket - HIST_SUB_COUNT) / HIST_HALF_COUNT + 1;
+    unsigned long long sub = (bucket - HIST_SUB_COUNT) % HIST_HALF_COUNT + HIST_HALF_COUNT;
+    return ((sub + 1) << shift) - 1;
+}
+
+void histogram_record(Histogram *h, unsigned long long value_us) {
+    h->counts[histogram_bucket(value_us)]++;
+    h->total++;
+    h->sum_us += value_us;
+    if (value_us > h->max_us) h->max_us = value_us;
+}
+
+void histogram_merge(Histogram *dst, const Histogram *src) {
+    for (int i = 0; i < HIST_BUCKETS; i++) dst->counts[i] += src->counts[i];
+    dst->total += src->total;
+    dst->sum_us += src->sum_us;
+    if (src->max_us > dst->max_us) dst->max_us = src->max_us;
+}
+
+unsigned long long histogram_percentile(const Histogram *h, double percentile) {
+    if (h->total == 0) return 0;
+
+    unsigned long target = (unsigned long)(h->total * percentile / 100.0 + 0.5);
+    if (target == 0) target = 1;
+
+    unsigned long seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if (seen >= target) {
+            unsigned long long value = histogram_bucket_value(i);
+            return value < h->max_us ? value : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+/* Pick the next request kind according to the configured weights */
+static RequestKind pick_request_kind(Connection *conn) {
+    int r = rand_r(&conn->seed) % total_weight;
+    for (int k = 0; k < REQ_KINDS; k++) {
+        if (r < request_weights[k]) return (RequestKind)k;
+        r -= request_weights[k];
+    }
+    return REQ_FILE;
+}
+
+static void prepare_request(Connection *conn) {
+    conn->kind = pick_request_kind(conn);
+    conn->request_len = snprintf(conn->request, REQ_BUF_SIZE,
+                                 "GET %s HTTP/1.1\r\nHost: %s\r\nConnection: keep-alive\r\n\r\n",
+                                 request_paths[conn->kind], host);
+    conn->written = 0;
+    conn->received = 0;
+    conn->total_received = 0;
+    conn->started_ns = now_ns();
+}
+
+/* Open a non-blocking connection and register it with epoll */
+static int open_connection(int epoll_fd, Connection *conn) {
+    conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (conn->fd == -1) return -1;
+
+    int one = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    conn->reused = 0;
+    conn->state = CONN_CONNECTING;
+    if (connect(conn->fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1 && errno != EINPROGRESS) {
+        close(conn->fd);
+        conn->fd = -1;
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLOUT;
+    ev.data.ptr = conn;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev) == -1) {
+        close(conn->fd);
+        conn->fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+static void close_connection(Connection *conn) {
+    if (conn->fd != -1) {
+        close(conn->fd); /* Closing also removes it from the epoll set */
+        conn->fd = -1;
+    }
+}
+
+static void watch(int epoll_fd, Connection *conn, unsigned int events) {
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+/* Case-insensitive search for a header line, returns a pointer to its value or NULL */
+static const char *find_header(const char *headers, size_t len, const char *name) {
+    size_t name_len = strlen(name);
+    const char *line = memchr(headers, '\n', len);
+
+    while (line != NULL && (size_t)(line + 1 - headers) + name_len < len) {
+        line++;
+        if (strncasecmp(line, name, name_len) == 0 && line[name_len] == ':') {
+            return line + name_len + 1;
+        }
+        line = memchr(line, '\n', len - (line - headers));
+    }
+    return NULL;
+}
+
+/*
+ * Check whether the buffered response is complete.
+ * Returns the response length once complete, 0 if more bytes are needed.
+ * When the server does not send Content-Length the response ends at EOF.
+ */
+static size_t response_complete(Connection *conn, int *keep_alive) {
+    char *end = memmem(conn->response, conn->received, "\r\n\r\n", 4);
+    if (end == NULL) return 0;
+
+    size_t header_len = end + 4 - conn->response;
+    const char *content_length = find_header(conn->response, header_len, "Content-Length");
+    if (content_length == NULL) return 0;
+
+    size_t total = header_len + strtoul(content_length, NULL, 10);
+    if (conn->total_received < total) return 0;
+
+    const char *connection = find_header(conn->response, header_len, "Connection");
+    *keep_alive = !(connection != NULL && strncasecmp(connection + strspn(connection, " "), "close", 5) == 0);
+    return total;
+}
+
+static void record_response(Worker *worker, Connection *conn, size_t length) {
+    int status = 0;
+    sscanf(conn->response, "HTTP/%*s %d", &status);
+
+    if (status >= 200 && status < 300) worker->status_2xx++;
+    else if (status >= 400 && status < 500) worker->status_4xx++;
+    else if (status >= 500 && status < 600) worker->status_5xx++;
+    else worker->status_other++;
+
+    worker->requests[conn->kind]++;
+    worker->bytes += length;
+    histogram_record(&worker->latency, (now_ns() - conn->started_ns) / 1000);
+}
+
+/*
+ * Re-establish a connection the server closed.
+ * A reused connection closed before any byte arrived is a keep-alive miss,
+ * so the same request is sent again and its timer restarted.
+ * If the new connection cannot be opened it is left with fd -1, worker_main retries it.
+ */
+static void reconnect(Worker *worker, int epoll_fd, Connection *conn, int retry_request) {
+    close_connection(conn);
+    if (open_connection(epoll_fd, conn) == -1) {
+        worker->errors++;
+        return;
+    }
+    worker->reconnects++;
+    if (retry_request) {
+        conn->written = 0;
+        conn->received = 0;
+        conn->total_received = 0;
+        conn->started_ns = now_ns();
+    } else {
+        prepare_request(conn);
+    }
+}
+
+static void handle_writable(Worker *worker, int epoll_fd, Connection *conn) {
+    if (conn->state == CONN_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+        if (err != 0) {
+            worker->errors++;
+            reconnect(worker, epoll_fd, conn, 1);
+            return;
+        }
+        conn->state = CONN_WRITING;
+    }
+
+    while (conn->written < conn->request_len) {
+        ssize_t n = write(conn->fd, conn->request + conn->written, conn->request_len - conn->written);
+        if (n == -1) {
+            if (errno == EAGAIN) return;
+            /* A reused connection the server already closed */
+            if (!conn->reused) worker->errors++;
+            reconnect(worker, epoll_fd, conn, 1);
+            return;
+        }
+        conn->written += n;
+    }
+
+    conn->state = CONN_READING;
+    watch(epoll_fd, conn, EPOLLIN);
+}
+
+static void handle_readable(Worker *worker, int epoll_fd, Connection *conn) {
+    for (;;) {
+        if (conn->received == RESP_BUF_SIZE) {
+            /* Body larger than the buffer: keep the headers, the dropped body bytes stay counted in total_received */
+            char *end = memmem(conn->response, conn->received, "\r\n\r\n", 4);
+            if (end == NULL || end + 4 == conn->response + RESP_BUF_SIZE) {
+                worker->errors++; /* Headers alone fill the buffer */
+                reconnect(worker, epoll_fd, conn, 0);
+                return;
+            }
+            conn->received = end + 4 - conn->response;
+        }
+
+        ssize_t n = read(conn->fd, conn->response + conn->received, RESP_BUF_SIZE - conn->received);
+        if (n == -1) {
+            if (errno == EAGAIN) return;
+            /* Reset on a reused connection the server already closed */
+            if (!(conn->received == 0 && conn->reused)) worker->errors++;
+            reconnect(worker, epoll_fd, conn, 1);
+            return;
+        }
+
+        if (n == 0) {
+            if (conn->received == 0 && conn->reused) {
+                reconnect(worker, epoll_fd, conn, 1);
+            } else if (conn->received > 0 && memmem(conn->response, conn->received, "\r\n\r\n", 4)) {
+                /* Response without Content-Length, terminated by close */
+                record_response(worker, conn, conn->total_received);
+                reconnect(worker, epoll_fd, conn, 0);
+            } else {
+                worker->errors++;
+                reconnect(worker, epoll_fd, conn, 1);
+            }
+            return;
+        }
+
+        conn->received += n;
+        conn->total_received += n;
+        int keep_alive = 1;
+        size_t length = response_complete(conn, &keep_alive);
+        if (length > 0) {
+            record_response(worker, conn, length);
+            if (atomic_load(&stop_benchmark)) return;
+            if (!keep_alive) {
+                reconnect(worker, epoll_fd, conn, 0);
+                return;
+            }
+            conn->reused = 1;
+            conn->state = CONN_WRITING;
+            prepare_request(conn);
+            watch(epoll_fd, conn, EPOLLOUT);
+            return;
+        }
+    }
+}
+
+void *worker_main(void *arg) {
+    Worker *worker = arg;
+    int epoll_fd = epoll_create1(0);
+    if (epoll_fd == -1) {
+        perror("epoll_create1");
+        return NULL;
+    }
+
+    Connection *conns = calloc(worker->num_connections, sizeof(Connection));
+    if (!conns) {
+        perror("calloc");
+        close(epoll_fd);
+        return NULL;
+    }
+
+    for (int i = 0; i < worker->num_connections; i++) {
+        conns[i].fd = -1;
+        conns[i].seed = (unsigned int)(now_ns() ^ (worker->id * 7919 + i));
+        conns[i].response = malloc(RESP_BUF_SIZE);
+        if (!conns[i].response) {
+            perror("malloc");
+            worker->num_connections = i;
+            break;
+        }
+        prepare_request(&conns[i]);
+        if (open_connection(epoll_fd, &conns[i]) == -1) worker->errors++;
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    long long next_retry_ns = now_ns() + RETRY_INTERVAL_MS * 1000000LL;
+    while (!atomic_load(&stop_benchmark)) {
+        int n = epoll_wait(epoll_fd, events, MAX_EVENTS, RETRY_INTERVAL_MS);
+        for (int i = 0; i < n && !atomic_load(&stop_benchmark); i++) {
+            Connection *conn = events[i].data.ptr;
+            if (conn->fd == -1) continue;
+            if (conn->state == CONN_READING) {
+                handle_readable(worker, epoll_fd, conn);
+            } else {
+                handle_writable(worker, epoll_fd, conn);
+            }
+        }
+
+        /* A connection that failed to open would otherwise be lost for the rest of the run */
+        if (now_ns() >= next_retry_ns) {
+            for (int i = 0; i < worker->num_connections; i++) {
+                if (conns[i].fd == -1) reconnect(worker, epoll_fd, &conns[i], 1);
+            }
+            next_retry_ns = now_ns() + RETRY_INTERVAL_MS * 1000000LL;
+        }
+    }
+
+    for (int i = 0; i < worker->num_connections; i++) {
+        close_connection(&conns[i]);
+        free(conns[i].response);
+    }
+    free(conns);
+    close(epoll_fd);
+    return NULL;
+}
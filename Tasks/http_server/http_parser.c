@@ -0,0 +1,224 @@
+#include <string.h>
+#include <strings.h>
+#include <limits.h>
+#include "http_parser.h"
+
+/* Parser states, one per syntactic element of the request head */
+enum {
+    S_METHOD = 0,
+    S_TARGET,
+    S_VERSION,
+    S_REQUEST_LINE_LF,
+    S_HEADER_START,
+    S_HEADER_NAME,
+    S_HEADER_VALUE_START,
+    S_HEADER_VALUE,
+    S_HEADER_LF,
+    S_HEADERS_END_LF,
+    S_BODY
+};
+
+/* RFC 9110 token characters, used for the method and header names */
+static int is_tchar(unsigned char c) {
+    if (c >= '0' && c <= '9') return 1;
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') return 1;
+    return c != '\0' && strchr("!#$%&'*+-.^_`|~", c) != NULL;
+}
+
+static int hex_value(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') return (c | 0x20) - 'a' + 10;
+    return -1;
+}
+
+void http_parser_init(HttpRequest *req) {
+    memset(req, 0, sizeof(*req));
+    req->state = S_METHOD;
+    req->content_length = -1;
+}
+
+int http_slice_equals(HttpSlice slice, const char *str) {
+    return strlen(str) == slice.len && memcmp(slice.ptr, str, slice.len) == 0;
+}
+
+const HttpHeader *http_find_header(const HttpRequest *req, const char *name) {
+    size_t name_len = strlen(name);
+    for (int i = 0; i < req->num_headers; i++) {
+        if (req->headers[i].name.len == name_len && strncasecmp(req->headers[i].name.ptr, name, name_len) == 0) {
+            return &req->headers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Validate the request line version, only HTTP/1.0 and HTTP/1.1 are accepted */
+static int parse_version(HttpRequest *req) {
+    if (req->version.len != 8 || memcmp(req->version.ptr, "HTTP/1.", 7) != 0) return -1;
+    if (req->version.ptr[7] != '0' && req->version.ptr[7] != '1') return -1;
+    req->version_minor = req->version.ptr[7] - '0';
+    return 0;
+}
+
+/* Store a finished header and interpret the ones the parser itself needs */
+static int finish_header(HttpRequest *req) {
+    HttpHeader *header = &req->headers[req->num_headers - 1];
+
+    /* Drop trailing whitespace from the value */
+    while (header->value.len > 0 &&
+           (header->value.ptr[header->value.len - 1] == ' ' || header->value.ptr[header->value.len - 1] == '\t')) {
+        header->value.len--;
+    }
+
+    if (header->name.len == 14 && strncasecmp(header->name.ptr, "Content-Length", 14) == 0) {
+        if (header->value.len == 0) return -1;
+        long value = 0;
+        for (size_t i = 0; i < header->value.len; i++) {
+            unsigned char c = header->value.ptr[i];
+            if (c < '0' || c > '9') return -1;
+            if (value > (LONG_MAX - (c - '0')) / 10) return -1;
+            value = value * 10 + (c - '0');
+        }
+        /* Conflicting duplicates are a request smuggling vector */
+        if (req->content_length != -1 && req->content_length != value) return -1;
+        req->content_length = value;
+    } else if (header->name.len == 17 && strncasecmp(header->name.ptr, "Transfer-Encoding", 17) == 0) {
+        /* Chunked bodies are not supported, refuse rather than misframe the request */
+        return -1;
+    }
+    return 0;
+}
+
+HttpParseResult http_parse_request(HttpRequest *req, const char *buf, size_t len) {
+    size_t i = req->offset;
+
+    while (req->state != S_BODY && i < len) {
+        unsigned char c = buf[i];
+
+        switch (req->state) {
+        case S_METHOD:
+            if (c == ' ' && i > req->mark) {
+                req->method.ptr = buf + req->mark;
+                req->method.len = i - req->mark;
+                req->mark = i + 1;
+                req->state = S_TARGET;
+            } else if (!is_tchar(c)) {
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_TARGET:
+            if (c == ' ' && i > req->mark) {
+                req->target.ptr = buf + req->mark;
+                req->target.len = i - req->mark;
+                req->mark = i + 1;
+                req->state = S_VERSION;
+            } else if (c <= ' ' || c >= 0x7f) {
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_VERSION:
+            if (c == '\r' || c == '\n') {
+                req->version.ptr = buf + req->mark;
+                req->version.len = i - req->mark;
+                if (parse_version(req) == -1) return HTTP_PARSE_ERROR;
+                req->state = (c == '\r') ? S_REQUEST_LINE_LF : S_HEADER_START;
+            } else if (c <= ' ' || c >= 0x7f) {
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_REQUEST_LINE_LF:
+        case S_HEADER_LF:
+            if (c != '\n') return HTTP_PARSE_ERROR;
+            req->state = S_HEADER_START;
+            break;
+
+        case S_HEADER_START:
+            if (c == '\r') {
+                req->state = S_HEADERS_END_LF;
+            } else if (c == '\n') {
+                req->header_length = i + 1;
+                req->state = S_BODY;
+            } else if (is_tchar(c)) {
+                if (req->num_headers == HTTP_MAX_HEADERS) return HTTP_PARSE_TOO_MANY_HEADERS;
+                req->mark = i;
+                req->num_headers++;
+                req->state = S_HEADER_NAME;
+            } else {
+                /* Obsolete line folding and stray bytes are rejected */
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_HEADER_NAME:
+            if (c == ':') {
+                req->headers[req->num_headers - 1].name.ptr = buf + req->mark;
+                req->headers[req->num_headers - 1].name.len = i - req->mark;
+                req->state = S_HEADER_VALUE_START;
+            } else if (!is_tchar(c)) {
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_HEADER_VALUE_START:
+            if (c == ' ' || c == '\t') break;
+            req->mark = i;
+            req->state = S_HEADER_VALUE;
+            /* fall through */
+
+        case S_HEADER_VALUE:
+            if (c == '\r' || c == '\n') {
+                HttpHeader *header = &req->headers[req->num_headers - 1];
+                header->value.ptr = buf + req->mark;
+                header->value.len = i - req->mark;
+                if (finish_header(req) == -1) return HTTP_PARSE_ERROR;
+                req->state = (c == '\r') ? S_HEADER_LF : S_HEADER_START;
+            } else if ((c < ' ' && c != '\t') || c == 0x7f) {
+                return HTTP_PARSE_ERROR;
+            }
+            break;
+
+        case S_HEADERS_END_LF:
+            if (c != '\n') return HTTP_PARSE_ERROR;
+            req->header_length = i + 1;
+            req->state = S_BODY;
+            break;
+        }
+        i++;
+    }
+    req->offset = i;
+
+    if (req->state != S_BODY) return HTTP_PARSE_INCOMPLETE;
+
+    size_t body_length = req->content_length > 0 ? (size_t)req->content_length : 0;
+    if (len - req->header_length < body_length) return HTTP_PARSE_INCOMPLETE;
+
+    req->body.ptr = buf + req->header_length;
+    req->body.len = body_length;
+    return HTTP_PARSE_OK;
+}
+
+ssize_t http_decode_path(HttpSlice target, char *out, size_t out_size) {
+    size_t j = 0;
+
+    for (size_t i = 0; i < target.len && target.ptr[i] != '?' && target.ptr[i] != '#'; i++) {
+        unsigned char c = target.ptr[i];
+        if (c == '%') {
+            if (i + 2 >= target.len) return -1;
+            int high = hex_value(target.ptr[i + 1]);
+            int low = hex_value(target.ptr[i + 2]);
+            if (high == -1 || low == -1) return -1;
+            c = (unsigned char)(high << 4 | low);
+            // An encoded '/' would join segments the path checks see as one name
+            if (c == '\0' || c == '/') return -1;
+            i += 2;
+        }
+        if (j + 1 >= out_size) return -1;
+        out[j++] = c;
+    }
+
+    if (out_size == 0) return -1;
+    out[j] = '\0';
+    return j;
+}
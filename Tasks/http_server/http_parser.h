@@ -0,0 +1,69 @@
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define HTTP_MAX_HEADERS 32
+
+/* A view into the receive buffer, not NUL-terminated */
+typedef struct {
+    const char *ptr;
+    size_t len;
+} HttpSlice;
+
+typedef struct {
+    HttpSlice name;
+    HttpSlice value;
+} HttpHeader;
+
+typedef enum {
+    HTTP_PARSE_OK = 0,          /* A full request (headers and body) is in the buffer */
+    HTTP_PARSE_INCOMPLETE,      /* Read more bytes and call again */
+    HTTP_PARSE_ERROR,           /* Malformed request, answer 400 */
+    HTTP_PARSE_TOO_MANY_HEADERS /* More than HTTP_MAX_HEADERS, answer 431 */
+} HttpParseResult;
+
+/*
+ * Parsed request. Every slice points into the buffer given to http_parse_request,
+ * so that buffer must stay in place (it may only grow at its end) while the request is used.
+ */
+typedef struct {
+    /* Parser state, resumed on the next call when the request is incomplete */
+    int state;
+    size_t offset;
+    size_t mark;
+
+    HttpSlice method;
+    HttpSlice target;
+    HttpSlice version;
+    int version_minor;          /* 0 for HTTP/1.0, 1 for HTTP/1.1 */
+    HttpHeader headers[HTTP_MAX_HEADERS];
+    int num_headers;
+    long content_length;        /* -1 when the request has no Content-Length */
+    size_t header_length;       /* Bytes up to and including the blank line */
+    HttpSlice body;
+} HttpRequest;
+
+/* Reset a request before parsing a new one */
+void http_parser_init(HttpRequest *req);
+
+/*
+ * Parse the request held in buf[0..len). Bytes already examined by an earlier call
+ * returning HTTP_PARSE_INCOMPLETE are not scanned again.
+ */
+HttpParseResult http_parse_request(HttpRequest *req, const char *buf, size_t len);
+
+/* Case-insensitive header lookup, returns NULL when the header is absent */
+const HttpHeader *http_find_header(const HttpRequest *req, const char *name);
+
+/* Compare a slice with a NUL-terminated string */
+int http_slice_equals(HttpSlice slice, const char *str);
+
+/*
+ * Percent-decode the path part of a request target (everything before '?') into out.
+ * Returns the decoded length, or -1 for invalid escapes, encoded NUL or '/' bytes or when out is too small.
+ */
+ssize_t http_decode_path(HttpSlice target, char *out, size_t out_size);
+
+#endif /* HTTP_PARSER_H */
@@ -8,22 +8,160 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <limits.h>
+#include <signal.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include "http_parser.h"
 
 #define PORT 8080
 #define BUF_SIZE 1024
-#define BACKLOG 10
+#define REQUEST_BUF_SIZE 8192   /* Request line, headers and body must fit */
+#define BACKLOG 128             /* Bound of the kernel accept queue */
+#define MAX_CONNECTIONS 256     /* Concurrent workers before answering 503 */
+#define MAX_PER_IP 32           /* Concurrent workers per client address */
+#define IDLE_TIMEOUT 5          /* Seconds to wait for the first request byte */
+#define READ_TIMEOUT 10         /* Seconds to receive the rest of the request */
+#define WRITE_TIMEOUT 10        /* Seconds a single write may block */
+#define METRICS_PATH "metrics"
+#define METRICS_SLOTS 16        /* Per-worker metric slots, picked by pid */
+#define METRICS_BUF_SIZE 16384
+
+/* Histogram bucket upper bounds; latencies are in nanoseconds, sizes in bytes */
+static const long long latency_bounds[] = {
+    50000, 100000, 250000, 500000, 1000000, 2500000, 5000000,
+    10000000, 25000000, 50000000, 100000000, 250000000, 1000000000
+};
+#define LATENCY_BUCKETS (sizeof(latency_bounds) / sizeof(latency_bounds[0]))
+
+static const long long size_bounds[] = {
+    64, 256, 1024, 4096, 16384, 65536, 262144, 1048576
+};
+#define SIZE_BUCKETS (sizeof(size_bounds) / sizeof(size_bounds[0]))
+
+/* Status codes tracked by http_responses_total, the last slot counts any other code */
+static const int tracked_status_codes[] = {200, 400, 404, 405, 408, 413, 431, 500, 503};
+#define STATUS_SLOTS (sizeof(tracked_status_codes) / sizeof(tracked_status_codes[0]) + 1)
+
+/* Buckets are stored non-cumulatively, the one after the last bound is +Inf */
+#define MAX_BUCKETS (LATENCY_BUCKETS > SIZE_BUCKETS ? LATENCY_BUCKETS + 1 : SIZE_BUCKETS + 1)
+typedef struct {
+    unsigned long buckets[MAX_BUCKETS];
+    unsigned long count;
+    unsigned long long sum;
+} Histogram;
+
+/* One slot per worker, cache-line aligned so workers do not share lines */
+typedef struct {
+    Histogram parse_time;
+    Histogram open_time;
+    Histogram total_time;
+    Histogram bytes_sent;
+    unsigned long responses[STATUS_SLOTS];
+    unsigned long cgi_requests;
+    unsigned long long cgi_busy_ns;
+} __attribute__((aligned(64))) WorkerMetrics;
+
+/* Lives in a MAP_SHARED mapping so forked workers update the parent's copy lock-free */
+typedef struct {
+    WorkerMetrics workers[METRICS_SLOTS];
+    long active_connections;
+    long cgi_active;
+    unsigned long connections_total;
+} ServerMetrics;
+
+/* Timing of the request handled by this (forked) process */
+typedef struct {
+    long long accepted_ns;
+    long long parse_ns;
+    long long open_ns;      /* -1 when no file was opened */
+    size_t bytes_sent;
+    int status;
+} RequestStats;
+
+/* Limits, overridable from the command line */
+typedef struct {
+    int port;
+    int backlog;
+    int max_connections;
+    int max_per_ip;
+    int idle_timeout;
+    int read_timeout;
+    int write_timeout;
+} ServerConfig;
+
+/* A running worker, tracked by the parent to enforce the limits */
+typedef struct {
+    pid_t pid;
+    struct in_addr addr;
+} ActiveWorker;
+
+static ServerConfig config = {PORT, BACKLOG, MAX_CONNECTIONS, MAX_PER_IP, IDLE_TIMEOUT, READ_TIMEOUT, WRITE_TIMEOUT};
+static ActiveWorker *active_workers;
+static int num_active_workers = 0;
+static ServerMetrics *metrics;
+static char server_root[PATH_MAX]; /* Resolved directory the server was started in, requests stay under it */
+static RequestStats request_stats;
 
 void handle_request(int client_fd);
 void send_response(int client_fd, const char *status, const char *content_type, const char *body);
 void list_directory(int client_fd, const char *path);
 void send_file(int client_fd, const char *path);
 void execute_cgi(int client_fd, const char *path);
+void send_metrics(int client_fd);
+void record_request(void);
+long long now_ns(void);
+void print_usage(const char *progname);
+void reap_workers(void);
+int workers_for_address(struct in_addr addr);
+void reject_overloaded(int client_fd);
 
-int main() {
+int main(int argc, char *argv[]) {
     int server_fd, client_fd;
     struct sockaddr_in server_addr, client_addr;
     socklen_t addr_len = sizeof(client_addr);
 
+    int opt_char;
+    while ((opt_char = getopt(argc, argv, "p:b:c:i:I:r:w:h")) != -1) {
+        switch (opt_char) {
+        case 'p': config.port = atoi(optarg); break;
+        case 'b': config.backlog = atoi(optarg); break;
+        case 'c': config.max_connections = atoi(optarg); break;
+        case 'i': config.max_per_ip = atoi(optarg); break;
+        case 'I': config.idle_timeout = atoi(optarg); break;
+        case 'r': config.read_timeout = atoi(optarg); break;
+        case 'w': config.write_timeout = atoi(optarg); break;
+        default:
+            print_usage(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (config.port <= 0 || config.port > 65535 || config.backlog <= 0 || config.max_connections <= 0 ||
+        config.max_per_ip <= 0 || config.idle_timeout <= 0 || config.read_timeout <= 0 || config.write_timeout <= 0) {
+        print_usage(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // Every request must resolve to a path under this directory
+    if (realpath(".", server_root) == NULL) {
+        perror("Cannot resolve the server directory");
+        exit(EXIT_FAILURE);
+    }
+
+    active_workers = calloc(config.max_connections, sizeof(ActiveWorker));
+    if (!active_workers) {
+        perror("Worker table allocation failed");
+        exit(EXIT_FAILURE);
+    }
+
+    // A client closing early must not kill the worker (or the parent answering 503) on write
+    signal(SIGPIPE, SIG_IGN);
+
     // Create server socket
     if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == -1) {
         perror("Socket creation failed");
@@ -37,7 +175,7 @@ int main() {
     // Bind to the specified port
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(PORT);
+    server_addr.sin_port = htons(config.port);
 
     if (bind(server_fd, (struct sockaddr *)&server_addr, sizeof(server_addr)) == -1) {
         perror("Bind failed");
@@ -46,22 +184,57 @@ int main() {
     }
 
     // Listen for incoming connections
-    if (listen(server_fd, BACKLOG) == -1) {
+    if (listen(server_fd, config.backlog) == -1) {
         perror("Listen failed");
         close(server_fd);
         exit(EXIT_FAILURE);
     }
 
-    printf("HTTP server running on port %d\n", PORT);
+    // Shared between the parent and every forked worker
+    metrics = mmap(NULL, sizeof(ServerMetrics), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (metrics == MAP_FAILED) {
+        perror("Metrics mmap failed");
+        close(server_fd);
+        exit(EXIT_FAILURE);
+    }
+
+    printf("HTTP server running on port %d (max %d connections, %d per client, backlog %d)\n",
+           config.port, config.max_connections, config.max_per_ip, config.backlog);
 
     // Accept and handle client connections
-    while ((client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &addr_len)) != -1) {
-        if (fork() == 0) { // Child process handles the request
+    while ((client_fd = accept(server_fd, (struct sockaddr *)&client_addr, &addr_len)) != -1 || errno == EINTR) {
+        if (client_fd == -1) continue;
+        request_stats.accepted_ns = now_ns();
+        __atomic_fetch_add(&metrics->connections_total, 1, __ATOMIC_RELAXED);
+
+        // Shed load before forking so overload costs one small write instead of a process
+        reap_workers();
+        if (num_active_workers >= config.max_connections ||
+            workers_for_address(client_addr.sin_addr) >= config.max_per_ip) {
+            reject_overloaded(client_fd);
+            continue;
+        }
+
+        __atomic_fetch_add(&metrics->active_connections, 1, __ATOMIC_RELAXED);
+        pid_t pid = fork();
+        if (pid == 0) { // Child process handles the request
             close(server_fd);
+            struct timeval write_timeout = {config.write_timeout, 0};
+            setsockopt(client_fd, SOL_SOCKET, SO_SNDTIMEO, &write_timeout, sizeof(write_timeout));
             handle_request(client_fd);
             close(client_fd);
+            record_request();
+            __atomic_fetch_sub(&metrics->active_connections, 1, __ATOMIC_RELAXED);
             exit(0);
+        } else if (pid == -1) {
+            __atomic_fetch_sub(&metrics->active_connections, 1, __ATOMIC_RELAXED);
+            reject_overloaded(client_fd);
+            continue;
         }
+
+        active_workers[num_active_workers].pid = pid;
+        active_workers[num_active_workers].addr = client_addr.sin_addr;
+        num_active_workers++;
         close(client_fd); // Parent process closes the socket
     }
 
@@ -70,26 +243,144 @@ int main() {
     return 0;
 }
 
+void print_usage(const char *progname) {
+    printf("Usage: %s [options]\n", progname);
+    printf("  -p <port>  Port to listen on (default %d)\n", PORT);
+    printf("  -b <n>     Accept queue length passed to listen (default %d)\n", BACKLOG);
+    printf("  -c <n>     Maximum concurrent connections (default %d)\n", MAX_CONNECTIONS);
+    printf("  -i <n>     Maximum concurrent connections per client IP (default %d)\n", MAX_PER_IP);
+    printf("  -I <sec>   Idle timeout until the first request byte (default %d)\n", IDLE_TIMEOUT);
+    printf("  -r <sec>   Timeout to receive the rest of the request (default %d)\n", READ_TIMEOUT);
+    printf("  -w <sec>   Timeout for each write to the client (default %d)\n", WRITE_TIMEOUT);
+}
+
+/* Collect finished workers without blocking and drop them from the table */
+void reap_workers(void) {
+    pid_t pid;
+    while ((pid = waitpid(-1, NULL, WNOHANG)) > 0) {
+        for (int i = 0; i < num_active_workers; i++) {
+            if (active_workers[i].pid == pid) {
+                active_workers[i] = active_workers[--num_active_workers];
+                break;
+            }
+        }
+    }
+}
+
+int workers_for_address(struct in_addr addr) {
+    int count = 0;
+    for (int i = 0; i < num_active_workers; i++) {
+        if (active_workers[i].addr.s_addr == addr.s_addr) count++;
+    }
+    return count;
+}
+
+/* Answer 503 from the parent without forking, then drop the connection */
+void reject_overloaded(int client_fd) {
+    static const char response[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Type: text/plain\r\n"
+                                   "Content-Length: 19\r\nRetry-After: 1\r\nConnection: close\r\n\r\n"
+                                   "Server overloaded\r\n";
+    char discard[BUF_SIZE];
+
+    // The response is tiny and fits the socket buffer, so a non-blocking send never stalls the accept loop
+    send(client_fd, response, sizeof(response) - 1, MSG_DONTWAIT);
+    shutdown(client_fd, SHUT_WR);
+    // Drain what the client already sent, so close() does not turn into a reset that discards the 503
+    while (recv(client_fd, discard, sizeof(discard), MSG_DONTWAIT) > 0);
+    close(client_fd);
+
+    size_t slot = 0;
+    while (slot < STATUS_SLOTS - 1 && tracked_status_codes[slot] != 503) slot++;
+    __atomic_fetch_add(&metrics->workers[getpid() % METRICS_SLOTS].responses[slot], 1, __ATOMIC_RELAXED);
+}
+
+/* Reject "/../" segments and empty segments like "//etc", only a trailing '/' may be empty */
+static int has_unsafe_segment(const char *path) {
+    for (const char *p = path; *p != '\0'; p++) {
+        if (p[0] != '/') continue;
+        if (p[1] == '/') return 1;
+        if (p[1] == '.' && p[2] == '.' && (p[3] == '/' || p[3] == '\0')) return 1;
+    }
+    return 0;
+}
+
+/* Resolve symlinks and check the file is still inside the server's directory */
+static int inside_server_root(const char *path) {
+    char resolved[PATH_MAX];
+    if (realpath(path, resolved) == NULL) return 0;
+
+    size_t root_len = strlen(server_root);
+    if (root_len == 1) return 1; // Serving "/" itself
+    return strncmp(resolved, server_root, root_len) == 0 && (resolved[root_len] == '/' || resolved[root_len] == '\0');
+}
+
 void handle_request(int client_fd) {
-    char buffer[BUF_SIZE];
-    read(client_fd, buffer, BUF_SIZE);
+    char buffer[REQUEST_BUF_SIZE];
+    size_t received = 0;
+    HttpRequest request;
+    HttpParseResult result = HTTP_PARSE_INCOMPLETE;
 
-    printf("Request:\n%s\n", buffer);
+    // Keep reading until the parser has the whole request, it resumes where it stopped.
+    // The first byte must arrive within the idle timeout, the rest within the read timeout.
+    http_parser_init(&request);
+    long long deadline = request_stats.accepted_ns + config.idle_timeout * 1000000000LL;
+    while (result == HTTP_PARSE_INCOMPLETE && received < REQUEST_BUF_SIZE) {
+        long long remaining_ms = (deadline - now_ns()) / 1000000;
+        struct pollfd pfd = {client_fd, POLLIN, 0};
+        if (remaining_ms <= 0 || poll(&pfd, 1, (int)remaining_ms) <= 0) {
+            // Idle connections are dropped silently, slow senders are told why
+            if (received > 0) {
+                send_response(client_fd, "408 Request Timeout", "text/plain", "Request not received in time");
+            }
+            return;
+        }
 
-    // Simple HTTP parsing (assumes GET method)
-    char method[16], path[256];
-    sscanf(buffer, "%s %s", method, path);
+        ssize_t n = read(client_fd, buffer + received, REQUEST_BUF_SIZE - received);
+        if (n <= 0) return; // Client closed or errored before sending a full request
+        if (received == 0) deadline = now_ns() + config.read_timeout * 1000000000LL;
+        received += n;
+        result = http_parse_request(&request, buffer, received);
+    }
+    request_stats.parse_ns = now_ns() - request_stats.accepted_ns;
+    request_stats.open_ns = -1;
 
-    if (strcmp(method, "GET") != 0) {
+    if (result == HTTP_PARSE_INCOMPLETE) {
+        send_response(client_fd, "413 Content Too Large", "text/plain", "Request too large");
+        return;
+    } else if (result == HTTP_PARSE_TOO_MANY_HEADERS) {
+        send_response(client_fd, "431 Request Header Fields Too Large", "text/plain", "Too many headers");
+        return;
+    } else if (result == HTTP_PARSE_ERROR) {
+        send_response(client_fd, "400 Bad Request", "text/plain", "Malformed request");
+        return;
+    }
+
+    printf("Request:\n%.*s\n", (int)request.header_length, buffer);
+
+    if (!http_slice_equals(request.method, "GET")) {
         send_response(client_fd, "405 Method Not Allowed", "text/plain", "Only GET supported");
         return;
     }
 
-    // Remove leading slash
-    if (path[0] == '/') memmove(path, path + 1, strlen(path));
+    char path[PATH_MAX];
+    if (request.target.ptr[0] != '/' || http_decode_path(request.target, path, sizeof(path)) == -1 ||
+        has_unsafe_segment(path)) {
+        send_response(client_fd, "400 Bad Request", "text/plain", "Invalid request target");
+        return;
+    }
+
+    // Remove leading slash, the root itself is the server's directory
+    memmove(path, path + 1, strlen(path));
+    if (path[0] == '\0') strcpy(path, ".");
 
+    if (strcmp(path, METRICS_PATH) == 0) {
+        send_metrics(client_fd);
+        return;
+    }
+
+    // Missing files and files outside the directory (through symlinks) look the same to the client
     struct stat path_stat;
-    if (stat(path, &path_stat) == -1) {
+    if (!inside_server_root(path) || stat(path, &path_stat) == -1) {
         send_response(client_fd, "404 Not Found", "text/plain", "File or directory not found");
     } else if (S_ISDIR(path_stat.st_mode)) {
         list_directory(client_fd, path);
@@ -106,7 +397,10 @@ void send_response(int client_fd, const char *status, const char *content_type,
     char response[BUF_SIZE];
     snprintf(response, BUF_SIZE, "HTTP/1.1 %s\r\nContent-Type: %s\r\nContent-Length: %ld\r\n\r\n%s",
              status, content_type, strlen(body), body);
-    write(client_fd, response, strlen(response));
+    ssize_t sent = write(client_fd, response, strlen(response));
+
+    request_stats.status = atoi(status);
+    if (sent > 0) request_stats.bytes_sent += sent;
 }
 
 void list_directory(int client_fd, const char *path) {
@@ -130,7 +424,9 @@ void list_directory(int client_fd, const char *path) {
 }
 
 void send_file(int client_fd, const char *path) {
+    long long open_start = now_ns();
     FILE *file = fopen(path, "r");
+    request_stats.open_ns = now_ns() - open_start;
     if (!file) {
         send_response(client_fd, "500 Internal Server Error", "text/plain", "Cannot open file");
         return;
@@ -150,6 +446,9 @@ void execute_cgi(int client_fd, const char *path) {
         return;
     }
 
+    long long cgi_start = now_ns();
+    __atomic_fetch_add(&metrics->cgi_active, 1, __ATOMIC_RELAXED);
+
     if (fork() == 0) {
         close(pipe_fd[0]);
         dup2(pipe_fd[1], STDOUT_FILENO);
@@ -162,5 +461,150 @@ void execute_cgi(int client_fd, const char *path) {
     read(pipe_fd[0], body, BUF_SIZE);
     close(pipe_fd[0]);
 
+    WorkerMetrics *worker = &metrics->workers[getpid() % METRICS_SLOTS];
+    __atomic_fetch_sub(&metrics->cgi_active, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&worker->cgi_requests, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&worker->cgi_busy_ns, now_ns() - cgi_start, __ATOMIC_RELAXED);
+
     send_response(client_fd, "200 OK", "text/html", body);
 }
+
+long long now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* Find the histogram bucket for a value, the last bucket is +Inf */
+static size_t bucket_index(const long long *bounds, size_t num_bounds, long long value) {
+    size_t i = 0;
+    while (i < num_bounds && value > bounds[i]) i++;
+    return i;
+}
+
+static void observe(Histogram *h, const long long *bounds, size_t num_bounds, long long value) {
+    __atomic_fetch_add(&h->buckets[bucket_index(bounds, num_bounds, value)], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+}
+
+/* Record the finished request into this worker's slot with relaxed atomic adds, no locks */
+void record_request(void) {
+    WorkerMetrics *worker = &metrics->workers[getpid() % METRICS_SLOTS];
+
+    observe(&worker->parse_time, latency_bounds, LATENCY_BUCKETS, request_stats.parse_ns);
+    if (request_stats.open_ns >= 0) {
+        observe(&worker->open_time, latency_bounds, LATENCY_BUCKETS, request_stats.open_ns);
+    }
+    observe(&worker->total_time, latency_bounds, LATENCY_BUCKETS, now_ns() - request_stats.accepted_ns);
+    observe(&worker->bytes_sent, size_bounds, SIZE_BUCKETS, request_stats.bytes_sent);
+
+    size_t slot = 0;
+    while (slot < STATUS_SLOTS - 1 && tracked_status_codes[slot] != request_stats.status) slot++;
+    __atomic_fetch_add(&worker->responses[slot], 1, __ATOMIC_RELAXED);
+}
+
+/* Append printf-style text to the metrics body, silently truncating at the buffer end */
+static void metrics_append(char *body, size_t *len, const char *format, ...) {
+    if (*len >= METRICS_BUF_SIZE) return;
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(body + *len, METRICS_BUF_SIZE - *len, format, args);
+    va_end(args);
+    if (n > 0) *len += n;
+    if (*len > METRICS_BUF_SIZE) *len = METRICS_BUF_SIZE;
+}
+
+/* Sum one histogram over all worker slots and render it in Prometheus text format */
+static void metrics_append_histogram(char *body, size_t *len, const char *name, const char *help,
+                                     size_t offset, const long long *bounds, size_t num_bounds, double scale) {
+    unsigned long buckets[MAX_BUCKETS] = {0};
+    unsigned long count = 0;
+    unsigned long long sum = 0;
+
+    for (int w = 0; w < METRICS_SLOTS; w++) {
+        const Histogram *h = (const Histogram *)((const char *)&metrics->workers[w] + offset);
+        for (size_t i = 0; i <= num_bounds; i++) buckets[i] += __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+        count += __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+        sum += __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+    }
+
+    metrics_append(body, len, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+    unsigned long cumulative = 0;
+    for (size_t i = 0; i < num_bounds; i++) {
+        cumulative += buckets[i];
+        metrics_append(body, len, "%s_bucket{le=\"%g\"} %lu\n", name, bounds[i] / scale, cumulative);
+    }
+    cumulative += buckets[num_bounds];
+    metrics_append(body, len, "%s_bucket{le=\"+Inf\"} %lu\n", name, cumulative);
+    metrics_append(body, len, "%s_sum %g\n%s_count %lu\n", name, sum / scale, name, count);
+}
+
+void send_metrics(int client_fd) {
+    char *body = malloc(METRICS_BUF_SIZE);
+    if (!body) {
+        send_response(client_fd, "500 Internal Server Error", "text/plain", "Cannot render metrics");
+        return;
+    }
+    size_t len = 0;
+
+    metrics_append_histogram(body, &len, "http_request_duration_seconds",
+                             "Time from accept to the response being written.",
+                             offsetof(WorkerMetrics, total_time), latency_bounds, LATENCY_BUCKETS, 1e9);
+    metrics_append_histogram(body, &len, "http_request_parse_seconds",
+                             "Time from accept until the full request was read and parsed.",
+                             offsetof(WorkerMetrics, parse_time), latency_bounds, LATENCY_BUCKETS, 1e9);
+    metrics_append_histogram(body, &len, "http_file_open_seconds",
+                             "Time spent opening the requested file.",
+                             offsetof(WorkerMetrics, open_time), latency_bounds, LATENCY_BUCKETS, 1e9);
+    metrics_append_histogram(body, &len, "http_response_size_bytes",
+                             "Bytes written to the client per request.",
+                             offsetof(WorkerMetrics, bytes_sent), size_bounds, SIZE_BUCKETS, 1.0);
+
+    unsigned long responses[STATUS_SLOTS] = {0};
+    unsigned long cgi_requests = 0;
+    unsigned long long cgi_busy_ns = 0;
+    for (int w = 0; w < METRICS_SLOTS; w++) {
+        for (size_t i = 0; i < STATUS_SLOTS; i++) {
+            responses[i] += __atomic_load_n(&metrics->workers[w].responses[i], __ATOMIC_RELAXED);
+        }
+        cgi_requests += __atomic_load_n(&metrics->workers[w].cgi_requests, __ATOMIC_RELAXED);
+        cgi_busy_ns += __atomic_load_n(&metrics->workers[w].cgi_busy_ns, __ATOMIC_RELAXED);
+    }
+
+    metrics_append(body, &len, "# HELP http_responses_total Responses sent by status code.\n"
+                               "# TYPE http_responses_total counter\n");
+    for (size_t i = 0; i < STATUS_SLOTS - 1; i++) {
+        metrics_append(body, &len, "http_responses_total{code=\"%d\"} %lu\n", tracked_status_codes[i], responses[i]);
+    }
+    metrics_append(body, &len, "http_responses_total{code=\"other\"} %lu\n", responses[STATUS_SLOTS - 1]);
+
+    metrics_append(body, &len, "# HELP http_connections_total Connections accepted.\n"
+                               "# TYPE http_connections_total counter\nhttp_connections_total %lu\n",
+                   __atomic_load_n(&metrics->connections_total, __ATOMIC_RELAXED));
+    metrics_append(body, &len, "# HELP http_active_connections Connections currently being served.\n"
+                               "# TYPE http_active_connections gauge\nhttp_active_connections %ld\n",
+                   __atomic_load_n(&metrics->active_connections, __ATOMIC_RELAXED));
+    metrics_append(body, &len, "# HELP http_cgi_active CGI scripts currently running.\n"
+                               "# TYPE http_cgi_active gauge\nhttp_cgi_active %ld\n",
+                   __atomic_load_n(&metrics->cgi_active, __ATOMIC_RELAXED));
+    metrics_append(body, &len, "# HELP http_cgi_requests_total CGI scripts executed.\n"
+                               "# TYPE http_cgi_requests_total counter\nhttp_cgi_requests_total %lu\n",
+                   cgi_requests);
+    metrics_append(body, &len, "# HELP http_cgi_busy_seconds_total Wall time spent running CGI scripts; "
+                               "its rate is the average number of busy CGI workers.\n"
+                               "# TYPE http_cgi_busy_seconds_total counter\nhttp_cgi_busy_seconds_total %g\n",
+                   cgi_busy_ns / 1e9);
+
+    // The body outgrows send_response's fixed buffer, so write the header and body separately
+    char header[BUF_SIZE];
+    int header_len = snprintf(header, BUF_SIZE,
+                              "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\n\r\n",
+                              len);
+    ssize_t sent = write(client_fd, header, header_len);
+    if (sent > 0) request_stats.bytes_sent += sent;
+    sent = write(client_fd, body, len);
+    if (sent > 0) request_stats.bytes_sent += sent;
+    request_stats.status = 200;
+    free(body);
+}
@@ -0,0 +1,229 @@
+ /******************************************************************************
+ *
+ * File Name: command_hash.c
+ *
+ * Description: Source file for the command hash table which remembers where each external command was found in $PATH,
+ *              and the internal command hash to print and reset it
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "command_hash.h"
+
+static hashed_command *hash_table[HASH_BUCKETS]; /* Buckets of remembered commands */
+static char *hashed_path_variable = NULL; /* Value of $PATH when the remembered commands were searched */
+
+/*
+ * Description :
+ * 1. Function to calculate the bucket of a command name (FNV-1a).
+ */
+static unsigned int hash_bucket(const char *name)
+{
+    unsigned int hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+    return hash % HASH_BUCKETS;
+}
+
+/*
+ * Description :
+ * 1. Function to forget all remembered commands.
+ */
+void hash_reset(void)
+{
+    for (int i = 0; i < HASH_BUCKETS; i++) {
+        hashed_command *entry = hash_table[i];
+        while (entry != NULL) {
+            hashed_command *next = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+        hash_table[i] = NULL;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to forget everything if $PATH changed since the commands were searched.
+ * 2. Comparing the strings is much cheaper than searching all the directories again.
+ */
+static void hash_check_path_variable(const char *path)
+{
+    if (path == NULL) {
+        path = "";
+    }
+    if (hashed_path_variable != NULL && strcmp(hashed_path_variable, path) == 0) {
+        return; /* $PATH is the same, the remembered paths are still valid */
+    }
+
+    hash_reset();
+    free(hashed_path_variable);
+    hashed_path_variable = strdup(path);
+}
+
+/*
+ * Description :
+ * 1. Function to search the $PATH directories for a command and write its full path in full_path.
+ * 2. It returns 1 if found, and sets is_relative if it was found in a directory that depends on the working directory.
+ */
+static int hash_search_path(const char *path, const char *command, char *full_path, int *is_relative)
+{
+    /* Walk the directories without copying $PATH, an empty directory means the working directory */
+    const char *dir = path;
+    while (1) {
+        const char *dir_end = strchr(dir, ':');
+        int dir_len = (dir_end != NULL) ? (int)(dir_end - dir) : (int)strlen(dir);
+
+        if (dir_len == 0) {
+            snprintf(full_path, HASH_PATH_BUFFER, "%s", command);
+        } else {
+            snprintf(full_path, HASH_PATH_BUFFER, "%.*s/%s", dir_len, dir, command);
+        }
+        if (access(full_path, X_OK) == 0) {
+            *is_relative = (dir_len == 0 || dir[0] != '/');
+            return 1; /* Command is executable */
+        }
+
+        if (dir_end == NULL) {
+            return 0; /* Command not found in any PATH directory */
+        }
+        dir = dir_end + 1;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to find the full path of a command, searching $PATH only the first time the command is used.
+ * 2. It returns NULL if the command is not an executable in any $PATH directory.
+ * 3. A command containing '/' is not searched, it is returned as it is if it is executable.
+ * 4. is_execute is HASH_EXECUTE when the command is about to run, so hash prints how many times it was used.
+ */
+const char *hash_lookup(const char *command, char is_execute)
+{
+    static char uncached_path[HASH_PATH_BUFFER]; /* Result that must not be remembered, valid until the next lookup */
+
+    /* Check if the user sent a path */
+    if (strchr(command, '/') != NULL) {
+        return (access(command, X_OK) == 0) ? command : NULL;
+    }
+
+    char *path = getenv("PATH"); /* Get the PATH environment variable */
+    hash_check_path_variable(path);
+    if (path == NULL || command[0] == '\0') {
+        return NULL; /* No PATH environment variable found */
+    }
+
+    unsigned int bucket = hash_bucket(command);
+    for (hashed_command *entry = hash_table[bucket]; entry != NULL; entry = entry->next) {
+        if (strcmp(entry->name, command) == 0) {
+            entry->hits += is_execute;
+            return entry->path;
+        }
+    }
+
+    char full_path[HASH_PATH_BUFFER]; /* Buffer to store the full path of the command */
+    int is_relative = 0;
+    if (!hash_search_path(path, command, full_path, &is_relative)) {
+        return NULL; /* Not found commands are not remembered, they may be installed later */
+    }
+
+    /* A path relative to the working directory changes with cd, so it is searched every time */
+    if (is_relative) {
+        strcpy(uncached_path, full_path);
+        return uncached_path;
+    }
+
+    hashed_command *entry = malloc(sizeof(hashed_command));
+    if (entry == NULL) {
+        strcpy(uncached_path, full_path);
+        return uncached_path;
+    }
+    entry->name = strdup(command);
+    entry->path = strdup(full_path);
+    if (entry->name == NULL || entry->path == NULL) {
+        free(entry->name);
+        free(entry->path);
+        free(entry);
+        strcpy(uncached_path, full_path);
+        return uncached_path;
+    }
+    entry->hits = is_execute;
+    entry->next = hash_table[bucket];
+    hash_table[bucket] = entry;
+    return entry->path;
+}
+
+/*
+ * Description :
+ * 1. Function to forget the remembered path of one command, the next lookup searches $PATH again.
+ */
+void hash_remove(const char *command)
+{
+    hashed_command **link = &hash_table[hash_bucket(command)];
+    while (*link != NULL) {
+        hashed_command *entry = *link;
+        if (strcmp(entry->name, command) == 0) {
+            *link = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            return;
+        }
+        link = &entry->next;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command hash.
+ * 2. hash: prints the remembered commands, hash -r: forgets them, hash name...: remembers these commands.
+ */
+int fun_HASH(int argc, char **argv)
+{
+    /* Forget everything was remembered */
+    if (argc > 1 && strcmp(argv[1], "-r") == 0) {
+        if (argc > 2) {
+            printf("hash: -r doesn't take command names, use hash -r alone\n");
+            return 1;
+        }
+        hash_reset();
+        return 0;
+    }
+
+    /* Search and remember the given commands */
+    if (argc > 1) {
+        int status = 0;
+        for (int i = 1; i < argc; i++) {
+            if (hash_lookup(argv[i], HASH_CHECK) == NULL) {
+                printf("hash: %s: not found\n", argv[i]);
+                status = 1;
+            }
+        }
+        return status;
+    }
+
+    /* Print the remembered commands, $PATH may have changed since they were searched */
+    hash_check_path_variable(getenv("PATH"));
+    int count = 0;
+    for (int i = 0; i < HASH_BUCKETS; i++) {
+        for (hashed_command *entry = hash_table[i]; entry != NULL; entry = entry->next) {
+            if (count++ == 0) {
+                printf("hits\tcommand\n");
+            }
+            printf("%4d\t%s\n", entry->hits, entry->path);
+        }
+    }
+    if (count == 0) {
+        printf("hash: hash table empty\n");
+    }
+    return 0;
+}
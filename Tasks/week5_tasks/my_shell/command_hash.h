@@ -0,0 +1,63 @@
+ /******************************************************************************
+ *
+ * File Name: command_hash.h
+ *
+ * Description: Header file for command_hash.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef COMMAND_HASH_H
+#define COMMAND_HASH_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define HASH_BUCKETS        (64)    /* Number of buckets, entries are chained so there is no limit on commands */
+#define HASH_PATH_BUFFER    (512)   /* Longest resolved path of a command */
+#define HASH_EXECUTE        (1)     /* Lookup before executing the command, counted in the hits */
+#define HASH_CHECK          (0)     /* Lookup to check the command only */
+
+/* Struct to save a command name, the path it was found at and how many times it was used */
+typedef struct hashed_command {
+    char *name;
+    char *path;
+    int hits;
+    struct hashed_command *next;
+} hashed_command;
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to find the full path of a command, searching $PATH only the first time the command is used.
+ * 2. It returns NULL if the command is not an executable in any $PATH directory.
+ * 3. A command containing '/' is not searched, it is returned as it is if it is executable.
+ * 4. is_execute is HASH_EXECUTE when the command is about to run, so hash prints how many times it was used.
+ */
+const char *hash_lookup(const char *command, char is_execute);
+
+/*
+ * Description :
+ * 1. Function to forget the remembered path of one command, the next lookup searches $PATH again.
+ */
+void hash_remove(const char *command);
+
+/*
+ * Description :
+ * 1. Function to forget all remembered commands.
+ */
+void hash_reset(void);
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command hash.
+ * 2. hash: prints the remembered commands, hash -r: forgets them, hash name...: remembers these commands.
+ */
+int fun_HASH(int argc, char **argv);
+
+#endif // COMMAND_HASH_H
@@ -0,0 +1,735 @@
+ /******************************************************************************
+ *
+ * File Name: executor.c
+ *
+ * Description: Source file for running the command tree: lists, && and ||, pipelines, subshells,
+ *              variable expansion and redirections
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "executor.h"
+#include "launcher.h"
+#include "internal_commands.h"
+#include "external_commands.h"
+#include "jobs.h"
+#include "my_shell.h"
+
+char exit_requested = 0; /* Set by exit, the shell stops after the current command */
+int last_exit_status = 0; /* Exit status of the last command, $? */
+
+/* Struct to save a growing string while a word is expanded */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} expand_buffer;
+
+/*
+ * Description :
+ * 1. Function to add length characters to an expand buffer, doubling it when it is full.
+ */
+static int expand_add(expand_buffer *buffer, const char *text, size_t length)
+{
+    if (buffer->len + length + 1 > buffer->cap) {
+        size_t cap = buffer->cap ? buffer->cap : 32;
+        while (buffer->len + length + 1 > cap) {
+            cap *= 2;
+        }
+        char *data = realloc(buffer->data, cap);
+        if (data == NULL) {
+            return -1;
+        }
+        buffer->data = data;
+        buffer->cap = cap;
+    }
+    memcpy(buffer->data + buffer->len, text, length);
+    buffer->len += length;
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to replace every EXPAND_MARK of a word by the value of the variable after it.
+ * 2. Names are NAME, {NAME}, ? for the last exit status, $ for the PID of the shell and ! for the last background job.
+ * 3. It returns a new string, or NULL if memory is exhausted.
+ */
+static char *expand_word(const char *text)
+{
+    expand_buffer buffer = {NULL, 0, 0};
+    int ok = (expand_add(&buffer, "", 0) == 0);
+
+    while (ok && *text != '\0') {
+        /* Copy everything until the next variable in one go */
+        const char *mark = strchr(text, EXPAND_MARK);
+        size_t literal = (mark != NULL) ? (size_t)(mark - text) : strlen(text);
+        ok = (expand_add(&buffer, text, literal) == 0);
+        text += literal;
+        if (!ok || *text == '\0') {
+            break;
+        }
+
+        text++; /* Skip the mark */
+        const char *name = text;
+        size_t name_length;
+        char number[16];
+        const char *value = NULL;
+
+        if (*text == '?' || *text == '$') {
+            snprintf(number, sizeof(number), "%d", (*text == '?') ? last_exit_status : (int)getpid());
+            value = number;
+            text++;
+        } else if (*text == '!') {
+            snprintf(number, sizeof(number), "%d", (int)last_background_pid);
+            value = (last_background_pid > 0) ? number : NULL; /* Empty before the first job */
+            text++;
+        } else {
+            if (*text == '{') {
+                const char *closing = strchr(text, '}');
+                if (closing == NULL) {
+                    ok = (expand_add(&buffer, "$", 1) == 0); /* ${ without } is not a variable */
+                    continue;
+                }
+                name = text + 1;
+                name_length = closing - name;
+                text = closing + 1;
+            } else {
+                while (isalnum((unsigned char)*text) || *text == '_') {
+                    text++;
+                }
+                name_length = text - name;
+            }
+
+            value = get_variable(name, name_length); /* Unknown variables expand to nothing */
+        }
+
+        if (value != NULL) {
+            ok = (expand_add(&buffer, value, strlen(value)) == 0);
+        }
+    }
+
+    if (!ok) {
+        free(buffer.data);
+        return NULL;
+    }
+    return buffer.data;
+}
+
+/*
+ * Description :
+ * 1. Function to free an argument vector built by expand_words.
+ */
+static void free_words(char **argv)
+{
+    if (argv == NULL) {
+        return;
+    }
+    for (int i = 0; argv[i] != NULL; i++) {
+        free(argv[i]);
+    }
+    free(argv);
+}
+
+/*
+ * Description :
+ * 1. Function to expand the words of a command into a NULL terminated argument vector.
+ * 2. An unquoted word that expands to nothing is dropped, "$EMPTY" stays an empty argument.
+ * 3. It returns the vector and its length in argc, or NULL if memory is exhausted.
+ */
+static char **expand_words(const shell_node *node, int *argc)
+{
+    char **argv = malloc((node->num_words + 1) * sizeof(char *));
+    if (argv == NULL) {
+        return NULL;
+    }
+
+    *argc = 0;
+    argv[0] = NULL;
+    for (int i = 0; i < node->num_words; i++) {
+        char *word = expand_word(node->words[i].text);
+        if (word == NULL) {
+            free_words(argv);
+            return NULL;
+        }
+        if (word[0] == '\0' && !node->words[i].quoted) {
+            free(word);
+            continue;
+        }
+        argv[(*argc)++] = word;
+        argv[*argc] = NULL;
+    }
+    return argv;
+}
+
+/*
+ * Description :
+ * 1. Function to open the files of the redirections of a command and add them to dups in the order they were written.
+ * 2. It prints why a redirection failed and returns -1, the files opened so far stay in dups to be released.
+ */
+static int open_redirections(const shell_redirection *redirection, launch_dups *dups)
+{
+    for (; redirection != NULL; redirection = redirection->next) {
+        char *target = expand_word(redirection->target.text);
+        if (target == NULL) {
+            printf("Redirection failed: out of memory\n");
+            return -1;
+        }
+
+        int source_fd;
+        char owned = 1;
+        if (redirection->type == REDIRECT_DUP) {
+            /* n>&m makes n a copy of m, n>&- closes n */
+            char *end;
+            owned = 0;
+            if (strcmp(target, "-") == 0) {
+                source_fd = LAUNCH_CLOSE;
+            } else {
+                long fd = strtol(target, &end, 10);
+                if (end == target || *end != '\0' || fd < 0 || fd >= HIGH_FD_MIN) {
+                    printf("Redirection failed: '%s' is not a descriptor number\n", target);
+                    free(target);
+                    return -1;
+                }
+                source_fd = (int)fd;
+            }
+        } else {
+            int open_flags;
+            if (redirection->type == REDIRECT_INPUT) {
+                open_flags = O_RDONLY;
+            } else if (redirection->type == REDIRECT_APPEND) {
+                open_flags = O_WRONLY | O_CREAT | O_APPEND;
+            } else {
+                open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+            }
+            source_fd = open_redirection(target, open_flags);
+            if (source_fd == -1) {
+                printf("Redirection failed: %s: %s\n", target, strerror(errno));
+                free(target);
+                return -1;
+            }
+        }
+        free(target);
+
+        if (launch_dups_add(dups, redirection->fd, source_fd, owned) == -1) {
+            if (owned) {
+                close(source_fd);
+            }
+            printf("Redirection failed: out of memory\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to check if a word as written is an assignment name=value, before its variables are expanded.
+ */
+static int is_assignment(const char *text)
+{
+    const char *equal_sign = strchr(text, '=');
+    return equal_sign != NULL && is_variable_name(text, equal_sign - text);
+}
+
+/*
+ * Description :
+ * 1. Function to set local variables if the whole command is assignments: a=1 b=2, or the old form a = 1.
+ * 2. It returns 1 if the command was assignments and puts their status in status.
+ */
+static int run_assignments(const shell_node *node, char **argv, int argc, int *status)
+{
+    int all_assignments = 1;
+    for (int i = 0; i < node->num_words; i++) {
+        all_assignments = all_assignments && is_assignment(node->words[i].text);
+    }
+
+    *status = 0;
+    if (all_assignments) {
+        for (int i = 0; i < argc; i++) {
+            *status |= fun_PLACE_VARIABLE(argv[i], LOCAL_VARIABLE);
+        }
+        return 1;
+    }
+
+    if (node->num_words == 3 && argc == 3 && strcmp(node->words[1].text, "=") == 0 && !node->words[1].quoted &&
+        is_variable_name(node->words[0].text, strlen(node->words[0].text))) {
+        char *assignment = malloc(strlen(argv[0]) + strlen(argv[2]) + 2);
+        if (assignment == NULL) {
+            printf("Memory allocation failed.\n");
+            *status = 1;
+            return 1;
+        }
+        sprintf(assignment, "%s=%s", argv[0], argv[2]);
+        *status = fun_PLACE_VARIABLE(assignment, LOCAL_VARIABLE);
+        free(assignment);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to run an internal command in the shell itself with its redirections applied.
+ * 2. The shell's own descriptors are saved first and put back when the command returns.
+ */
+static int run_internal_command(internal_function function, int argc, char **argv, const launch_dups *dups)
+{
+    saved_fd *saved = NULL;
+    if (dups->count > 0) {
+        saved = malloc(dups->count * sizeof(saved_fd));
+        if (saved == NULL) {
+            printf("Redirection failed: out of memory\n");
+            return 1;
+        }
+        fflush(stdout); /* Output printed before belongs to the old standard output */
+        if (apply_fds(dups, saved) == -1) {
+            printf("Redirection failed: %s\n", strerror(errno));
+            free(saved);
+            return 1;
+        }
+    }
+
+    int status = function(argc, argv);
+
+    if (saved != NULL) {
+        fflush(stdout);
+        fflush(stderr);
+        restore_fds(saved, dups->count);
+        free(saved);
+    }
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to run the expanded words of a command: assignments, an internal command or an external command.
+ * 2. Its redirections are added to dups, after the pipe ends a pipeline stage may already have there.
+ */
+static int run_words(const shell_node *node, char **argv, int argc, launch_dups *dups)
+{
+    int status = 0;
+    if (open_redirections(node->redirections, dups) == -1) {
+        status = 1;
+    } else if (argc == 0) {
+        status = 0; /* Only redirections, like > file to create an empty file */
+    } else if (run_assignments(node, argv, argc, &status)) {
+        /* status is set by run_assignments */
+    } else {
+        internal_function function = find_internal_command(argv[0]);
+        if (function != NULL) {
+            status = run_internal_command(function, argc, argv, dups);
+        } else if (is_external_command(argv[0])) {
+            status = fun_EXTERNAL_COMMAND(argv, dups);
+        } else {
+            ERROR_MESSAGE(); /* Print error message for unknown commands */
+            status = STATUS_NOT_FOUND;
+        }
+    }
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to run one simple command: assignments, an internal command or an external command.
+ */
+static int run_command(const shell_node *node)
+{
+    int argc;
+    char **argv = expand_words(node, &argc);
+    if (argv == NULL) {
+        printf("Memory allocation failed.\n");
+        return 1;
+    }
+
+    launch_dups dups = {NULL, 0, 0};
+    int status = run_words(node, argv, argc, &dups);
+    launch_dups_release(&dups);
+    free_words(argv);
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to add the command tree as text to a buffer, for the command jobs shows.
+ */
+static int add_node_text(expand_buffer *buffer, const shell_node *node)
+{
+    static const char *const operators[] = {[NODE_AND] = " && ", [NODE_OR] = " || ", [NODE_SEQUENCE] = "; "};
+    int ok = 1;
+
+    switch (node->type) {
+    case NODE_COMMAND:
+        for (int i = 0; ok && i < node->num_words; i++) {
+            /* The variables are shown as they were written */
+            for (const char *p = node->words[i].text; ok && *p != '\0'; p++) {
+                ok = (expand_add(buffer, (*p == EXPAND_MARK) ? "$" : p, 1) == 0);
+            }
+            if (ok && i < node->num_words - 1) {
+                ok = (expand_add(buffer, " ", 1) == 0);
+            }
+        }
+        break;
+    case NODE_PIPELINE:
+        for (int i = 0; ok && i < node->num_stages; i++) {
+            ok = add_node_text(buffer, node->stages[i]) == 0 && (i == node->num_stages - 1 || expand_add(buffer, " | ", 3) == 0);
+        }
+        break;
+    case NODE_AND:
+    case NODE_OR:
+    case NODE_SEQUENCE:
+        ok = add_node_text(buffer, node->left) == 0 &&
+             expand_add(buffer, operators[node->type], strlen(operators[node->type])) == 0 &&
+             add_node_text(buffer, node->right) == 0;
+        break;
+    case NODE_SUBSHELL:
+        ok = expand_add(buffer, "(", 1) == 0 && add_node_text(buffer, node->left) == 0 && expand_add(buffer, ")", 1) == 0;
+        break;
+    case NODE_BACKGROUND:
+        ok = add_node_text(buffer, node->left) == 0 && expand_add(buffer, " &", 2) == 0;
+        break;
+    case NODE_TIME:
+        ok = expand_add(buffer, TIME_KEYWORD, strlen(TIME_KEYWORD)) == 0 &&
+             (node->left == NULL || (expand_add(buffer, " ", 1) == 0 && add_node_text(buffer, node->left) == 0));
+        break;
+    }
+
+    /* Redirections are part of the command too */
+    for (const shell_redirection *redirection = node->redirections; ok && redirection != NULL; redirection = redirection->next) {
+        char operator[24];
+        const char *symbol = (redirection->type == REDIRECT_INPUT) ? "<" : (redirection->type == REDIRECT_APPEND) ? ">>" :
+                             (redirection->type == REDIRECT_DUP) ? ">&" : ">";
+        char default_fd = (redirection->type == REDIRECT_INPUT) ? STDIN : STDOUT;
+        if (redirection->fd == default_fd && redirection->type != REDIRECT_DUP) {
+            snprintf(operator, sizeof(operator), " %s ", symbol);
+        } else {
+            snprintf(operator, sizeof(operator), " %d%s", redirection->fd, symbol);
+        }
+        ok = expand_add(buffer, operator, strlen(operator)) == 0 &&
+             expand_add(buffer, redirection->target.text, strlen(redirection->target.text)) == 0;
+    }
+    return ok ? 0 : -1;
+}
+
+/*
+ * Description :
+ * 1. Function to create a job named by the text of its command tree.
+ */
+static shell_job *create_job(const shell_node *node, char background)
+{
+    expand_buffer buffer = {NULL, 0, 0};
+    shell_job *job = NULL;
+    if (expand_add(&buffer, "", 0) == 0 && add_node_text(&buffer, node) == 0) {
+        job = job_create(buffer.data, background);
+    }
+    free(buffer.data);
+    if (job == NULL) {
+        printf("Memory allocation failed.\n");
+    }
+    return job;
+}
+
+/*
+ * Description :
+ * 1. Function to fork the shell to run a node: the copy joins the process group pgid, applies stage_dups
+ *    and redirections and runs the node.
+ * 2. Used for ( subshells ), so variables and cd inside don't change the shell, and for internal commands and
+ *    lists started with &.
+ * 3. close_fd is a descriptor the copy must not keep open, like the read end of the pipe it writes to.
+ * 4. It returns the PID of the copy or -1.
+ */
+static pid_t fork_shell(const shell_node *run, const shell_redirection *redirections, const launch_dups *stage_dups,
+                        int close_fd, pid_t pgid)
+{
+    fflush(stdout); /* Otherwise the copy prints the buffered output again */
+    fflush(stderr);
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        perror("fork");
+        return -1;
+    }
+    if (pid > 0) {
+        return pid;
+    }
+
+    jobs_enter_child(pgid);
+    if (close_fd != -1) {
+        close(close_fd);
+    }
+    if (stage_dups != NULL) {
+        if (apply_fds(stage_dups, NULL) == -1) {
+            perror("dup2");
+            _exit(1);
+        }
+        for (int i = 0; i < stage_dups->count; i++) {
+            if (stage_dups->dups[i].owned) {
+                close(stage_dups->dups[i].source_fd); /* Only the copies on 0 and 1 are needed */
+            }
+        }
+    }
+
+    launch_dups dups = {NULL, 0, 0};
+    if (open_redirections(redirections, &dups) == -1) {
+        fflush(stdout);
+        _exit(1);
+    }
+    if (apply_fds(&dups, NULL) == -1) {
+        perror("dup2");
+        _exit(1);
+    }
+    launch_dups_release(&dups); /* The copies stay, only the opened originals are closed */
+
+    exit_requested = 0;
+    int status = execute_node((shell_node *)run);
+    fflush(stdout);
+    fflush(stderr);
+    _exit(status);
+}
+
+/*
+ * Description :
+ * 1. Function to start one stage of a job with its pipe ends in stage_dups, without waiting for it.
+ * 2. The stage's own redirections are applied after the pipe, so cmd 2>&1 | other sends errors in the pipe too.
+ * 3. The stage is added to the job as a process, or as a failed one with its status if it couldn't start.
+ * 4. Internal commands and assignments run in a forked copy of the shell, which needs no exec, or in the shell
+ *    itself when in_shell is set, for the last stage of a pipeline like the lastpipe option of bash.
+ */
+static void start_stage(const shell_node *stage, launch_dups *stage_dups, int close_fd, shell_job *job, char in_shell)
+{
+    int processes = job->num_processes;
+    int status = 0;
+
+    if (stage->type == NODE_SUBSHELL) {
+        pid_t pid = fork_shell(stage->left, stage->redirections, stage_dups, close_fd, job_spawn_pgid(job));
+        if (pid == -1) {
+            status = 1;
+        } else {
+            job_add_process(job, pid, SUBSHELL_NAME, 0);
+        }
+    } else {
+        int argc;
+        char **argv = expand_words(stage, &argc);
+        if (argv == NULL) {
+            printf("Memory allocation failed.\n");
+            status = 1;
+        } else if (argc > 0 && is_external_command(argv[0])) {
+            if (open_redirections(stage->redirections, stage_dups) == -1) {
+                status = 1;
+            } else {
+                status = start_external_command(argv, stage_dups, job);
+            }
+        } else if (in_shell) {
+            /* The stages before it are already running, it reads their output from the pipe in stage_dups */
+            status = run_words(stage, argv, argc, stage_dups);
+        } else {
+            /* The copy runs the whole command, with its own redirections and error messages */
+            pid_t pid = fork_shell(stage, NULL, stage_dups, close_fd, job_spawn_pgid(job));
+            if (pid == -1) {
+                status = 1;
+            } else {
+                job_add_process(job, pid, (argc > 0) ? argv[0] : NULL, 0);
+            }
+        }
+        free_words(argv);
+    }
+
+    if (job->num_processes == processes) {
+        job_add_process(job, -1, NULL, status);
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to run commands connected by pipes as one job, all of them run at the same time in one process group.
+ * 2. A foreground job returns the exit status of the last command like other shells, a background job returns 0.
+ * 3. Without job control an internal command at the end of a pipeline runs in the shell, so myecho a | mygrep a
+ *    starts one process. With job control it is forked, the shell must not wait for a pipe if Ctrl+Z stops
+ *    the commands writing to it.
+ * 4. If a pipe can't be created the commands after it aren't started, and the job fails with status 1.
+ */
+static int run_job(shell_node *const *stages, int num_stages, const shell_node *whole, char background)
+{
+    shell_job *job = create_job(whole, background);
+    if (job == NULL) {
+        return 1;
+    }
+
+    int prev_fd = -1; /* Read end of the pipe of the previous stage */
+    for (int i = 0; i < num_stages; i++) {
+        int pipe_fd[2] = {-1, -1};
+
+        /* Create a pipe for the current command, its write end becomes the output */
+        if (i < num_stages - 1 && open_pipe(pipe_fd) == -1) {
+            /* The rest of the pipeline isn't started, the stages already running are waited for as one failed job */
+            perror("pipe failed");
+            if (prev_fd != -1) {
+                close(prev_fd);
+            }
+            job_add_process(job, -1, NULL, 1);
+            break;
+        }
+
+        /* The pipe ends are owned by the stage, releasing the list closes them in the shell */
+        launch_dups stage_dups = {NULL, 0, 0};
+        int added = 0;
+        if (prev_fd != -1 && launch_dups_add(&stage_dups, STDIN, prev_fd, 1) == -1) {
+            close(prev_fd);
+            added = -1;
+        }
+        if (pipe_fd[1] != -1 && launch_dups_add(&stage_dups, STDOUT, pipe_fd[1], 1) == -1) {
+            close(pipe_fd[1]);
+            added = -1;
+        }
+        if (added == 0) {
+            char in_shell = !background && num_stages > 1 && i == num_stages - 1 && !job_control_active();
+            start_stage(stages[i], &stage_dups, pipe_fd[0], job, in_shell);
+        } else {
+            printf("Memory allocation failed.\n");
+            job_add_process(job, -1, NULL, 1);
+        }
+        launch_dups_release(&stage_dups);
+        prev_fd = pipe_fd[0];
+    }
+
+    if (background) {
+        job_background(job);
+        return 0;
+    }
+    return job_wait(job, 1); /* Also adds the commands to phist */
+}
+
+/*
+ * Description :
+ * 1. Function to start a node with & as a background job.
+ * 2. Commands, pipelines and subshells are started directly, other lists run in a forked copy of the shell.
+ */
+static int run_background(shell_node *node)
+{
+    if (node->type == NODE_PIPELINE) {
+        return run_job(node->stages, node->num_stages, node, 1);
+    }
+    if (node->type == NODE_COMMAND || node->type == NODE_SUBSHELL) {
+        return run_job(&node, 1, node, 1);
+    }
+
+    shell_job *job = create_job(node, 1);
+    if (job == NULL) {
+        return 1;
+    }
+    pid_t pid = fork_shell(node, NULL, NULL, -1, job_spawn_pgid(job));
+    job_add_process(job, pid, NULL, 1);
+    job_background(job);
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to print a time in seconds like other shells do for time, 1m2.345s.
+ */
+static void print_time(const char *label, double seconds)
+{
+    int minutes = (int)(seconds / 60);
+    fprintf(stderr, "%s\t%dm%.3fs\n", label, minutes, seconds - minutes * 60);
+}
+
+/*
+ * Description :
+ * 1. Function to run time pipeline: the pipeline runs as usual, then its real time, user and system CPU time and
+ *    resources are printed on the standard error.
+ * 2. The processes are counted from what wait4 reported when they were collected, the internal commands that ran
+ *    in the shell from getrusage of the shell itself. The max RSS is the largest process, or the shell if none ran.
+ */
+static int run_timed(shell_node *node)
+{
+    struct timespec start, end;
+    struct rusage saved, children, self_start, self_end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    getrusage(RUSAGE_SELF, &self_start);
+    jobs_usage_begin(&saved);
+
+    int status = (node != NULL) ? execute_node(node) : 0;
+
+    jobs_usage_end(&saved, &children);
+    getrusage(RUSAGE_SELF, &self_end);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double user = timeval_seconds(&children.ru_utime) + timeval_seconds(&self_end.ru_utime) - timeval_seconds(&self_start.ru_utime);
+    double system = timeval_seconds(&children.ru_stime) + timeval_seconds(&self_end.ru_stime) - timeval_seconds(&self_start.ru_stime);
+    children.ru_minflt += self_end.ru_minflt - self_start.ru_minflt;
+    children.ru_majflt += self_end.ru_majflt - self_start.ru_majflt;
+    children.ru_nvcsw += self_end.ru_nvcsw - self_start.ru_nvcsw;
+    children.ru_nivcsw += self_end.ru_nivcsw - self_start.ru_nivcsw;
+    if (children.ru_maxrss == 0) {
+        children.ru_maxrss = self_end.ru_maxrss;
+    }
+
+    fflush(stdout); /* The output of the pipeline comes first */
+    fputc('\n', stderr);
+    print_time("real", (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+    print_time("user", user);
+    print_time("sys", system);
+    print_resources(stderr, &children);
+    fputc('\n', stderr);
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to run a command tree built by parse_command_line.
+ * 2. Variables are expanded and redirections are opened when each command runs, so a=1 && myecho $a prints 1.
+ * 3. It returns the exit status of the last command that ran, also kept in last_exit_status.
+ */
+int execute_node(shell_node *node)
+{
+    if (node == NULL || exit_requested) {
+        return last_exit_status;
+    }
+
+    switch (node->type) {
+    case NODE_SEQUENCE:
+        execute_node(node->left);
+        execute_node(node->right);
+        break;
+    case NODE_AND:
+        /* The right side runs only if the left side succeeded */
+        if (execute_node(node->left) == 0) {
+            execute_node(node->right);
+        }
+        break;
+    case NODE_OR:
+        /* The right side runs only if the left side failed */
+        if (execute_node(node->left) != 0) {
+            execute_node(node->right);
+        }
+        break;
+    case NODE_PIPELINE:
+        last_exit_status = run_job(node->stages, node->num_stages, node, 0);
+        break;
+    case NODE_SUBSHELL:
+        last_exit_status = run_job(&node, 1, node, 0);
+        break;
+    case NODE_BACKGROUND:
+        last_exit_status = run_background(node->left);
+        break;
+    case NODE_COMMAND:
+        last_exit_status = run_command(node);
+        break;
+    case NODE_TIME:
+        last_exit_status = run_timed(node->left);
+        break;
+    }
+    return last_exit_status;
+}
@@ -0,0 +1,42 @@
+ /******************************************************************************
+ *
+ * File Name: executor.h
+ *
+ * Description: Header file for executor.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef EXECUTOR_H
+#define EXECUTOR_H
+
+#include "parser.h"
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define STATUS_SYNTAX_ERROR (2)     /* $? after a line that couldn't be parsed */
+#define SUBSHELL_NAME       ("(subshell)")  /* Name of a forked ( list ) in phist */
+
+/*******************************************************************************
+ *                           Extern Global Variable                            *
+ *******************************************************************************/
+
+extern char exit_requested;     /* Set by exit, the shell stops after the current command */
+extern int last_exit_status;    /* Exit status of the last command, $? */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to run a command tree built by parse_command_line.
+ * 2. Variables are expanded and redirections are opened when each command runs, so a=1 && myecho $a prints 1.
+ * 3. It returns the exit status of the last command that ran, also kept in last_exit_status.
+ */
+int execute_node(shell_node *node);
+
+#endif // EXECUTOR_H
@@ -11,26 +11,16 @@
 #ifndef EXTERNAL_COMMANDS_H
 #define EXTERNAL_COMMANDS_H
 
+#include <sys/types.h>
+#include "launcher.h"
+#include "jobs.h"
+
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 
-#define INPUT_BUFFER        (100)
-#define MAX_HISTORY         (10)
-#define MAX_PROCESS_NAME    (50)
-#define OUTPUT_REDIRECTION  (0)
-#define INPUT_REDIRECTION   (0)
-#define ERROR_REDIRECTION   (1)
-#define STD_IN              (0)
-#define STD_OUT             (1)
-#define STD_ERROR           (2)
-
-/*Struct to save Process pids and exit status*/
-typedef struct {
-    int pid;
-    int exit_status;
-    char process_name[MAX_PROCESS_NAME];
-} ProcessInfo;
+#define STATUS_NOT_FOUND    (127)   /* Status of a command that doesn't exist */
+#define STATUS_NOT_STARTED  (126)   /* Status of a command that exists but couldn't be started */
 
 /*******************************************************************************
  *                             Functions Prototypes                            *
@@ -38,22 +28,23 @@ typedef struct {
 
 /*
  * Description :
- * 1. Function to be called to display the last 10 process occured with there pid and exit status and its name ,  
- * 2. It is an internal command it was implemented here as it used to display external commands processes.
+ * 1. Function to check if a command is external or not.
  */
-void fun_PHIST();
+int is_external_command(const char *command);
 
 /*
  * Description :
- * 1. Function to check if a command is external or not.
+ * 1. Function to start an external command with the descriptors in dups as a process of job, without waiting for it.
+ * 2. It returns 0, or the status to report after printing why the command couldn't start.
  */
-int is_external_command(const char *command);
+int start_external_command(char *const argv[], const launch_dups *dups, shell_job *job);
 
 /*
  * Description :
  * 1. Function to be called if is_external_command is true .
  * 2. you can call external commands by its name or its paths.
+ * 3. It runs the command as a foreground job with the descriptors in dups, waits for it and returns its exit status.
  */
-void fun_EXTERNAL_COMMAND();
+int fun_EXTERNAL_COMMAND(char *const argv[], const launch_dups *dups);
 
-#endif // EXTERNAL_COMMANDS_H
\ No newline at end of file
+#endif // EXTERNAL_COMMANDS_H
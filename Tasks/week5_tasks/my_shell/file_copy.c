@@ -0,0 +1,684 @@
+ /******************************************************************************
+ *
+ * File Name: file_copy.c
+ *
+ * Description: Source file for copying, moving and removing files and directory trees, used by mycp and mymv
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE  /* For copy_file_range and asprintf */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <limits.h>
+#include <pthread.h>
+#include <ftw.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>  /* For FICLONE */
+#include "file_copy.h"
+
+#define COPY_CHUNK_MAX      (1024 * 1024 * 1024)    /* Largest request to copy_file_range and sendfile */
+#define REMOVE_OPEN_FDS     (32)                    /* Directories nftw keeps open while removing a tree */
+
+/* Struct to save one file waiting to be copied by a worker */
+typedef struct {
+    char *source;
+    char *target;
+} copy_job;
+
+/* Struct to save a created directory, its permissions and times are set after all its files are copied */
+typedef struct {
+    char *target;
+    struct stat st;
+} copy_directory;
+
+/* Struct shared by the directory walk and the worker threads */
+typedef struct {
+    copy_job jobs[COPY_QUEUE_SIZE];     /* Ring of files waiting for a worker */
+    int head;
+    int count;
+    char walk_done;                     /* No more files will be added */
+    int num_workers;
+    int failures;
+    int flags;
+    mode_t umask;                       /* Applied to the permissions of directories that are not preserved */
+    copy_directory *directories;
+    int num_directories;
+    int max_directories;
+    pthread_mutex_t lock;
+    pthread_cond_t can_take;
+    pthread_cond_t can_add;
+} copy_pool;
+
+/*
+ * Description :
+ * 1. Function to copy from the current offsets of the files through an aligned buffer, the fallback when the kernel can't copy.
+ * 2. length < 0 copies until the end of the source, for files like /proc ones whose size is reported as 0.
+ */
+static int copy_with_buffer(int fd_src, int fd_dest, off_t length)
+{
+    char *buffer;
+    if (posix_memalign((void **)&buffer, COPY_BUFFER_ALIGN, COPY_BUFFER_SIZE) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    while (length != 0) {
+        size_t chunk = COPY_BUFFER_SIZE;
+        if (length > 0 && (off_t)chunk > length) {
+            chunk = length;
+        }
+
+        ssize_t size = read(fd_src, buffer, chunk);
+        if (size == -1 && errno == EINTR) {
+            continue;
+        }
+        if (size <= 0) {
+            free(buffer);
+            return (int)size; /* 0 at the end of the file, -1 on error */
+        }
+
+        /* Write everything that was read */
+        for (ssize_t written = 0; written < size; ) {
+            ssize_t result = write(fd_dest, buffer + written, size - written);
+            if (result == -1 && errno != EINTR) {
+                free(buffer);
+                return -1;
+            }
+            if (result > 0) {
+                written += result;
+            }
+        }
+        if (length > 0) {
+            length -= size;
+        }
+    }
+
+    free(buffer);
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to copy length bytes at offset from one regular file to the same offset of another.
+ * 2. copy_file_range copies inside the kernel (or on the file server for NFS), sendfile still avoids copying to user space,
+ *    and the buffer loop is used only when neither works for these two files.
+ */
+static int copy_range(int fd_src, int fd_dest, off_t offset, off_t length)
+{
+    while (length > 0) {
+        loff_t in_offset = offset;
+        loff_t out_offset = offset;
+        size_t chunk = (length > COPY_CHUNK_MAX) ? COPY_CHUNK_MAX : (size_t)length;
+
+        ssize_t copied = copy_file_range(fd_src, &in_offset, fd_dest, &out_offset, chunk, 0);
+        if (copied > 0) {
+            offset += copied;
+            length -= copied;
+            continue;
+        }
+        if (copied == 0) {
+            return 0; /* The source became shorter while copying */
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EXDEV && errno != ENOSYS && errno != EINVAL && errno != EOPNOTSUPP) {
+            return -1;
+        }
+        break; /* Not supported for these files, try sendfile */
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    /* sendfile writes at the position of the target */
+    if (lseek(fd_dest, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    while (length > 0) {
+        off_t in_offset = offset;
+        size_t chunk = (length > COPY_CHUNK_MAX) ? COPY_CHUNK_MAX : (size_t)length;
+
+        ssize_t sent = sendfile(fd_dest, fd_src, &in_offset, chunk);
+        if (sent > 0) {
+            offset += sent;
+            length -= sent;
+            continue;
+        }
+        if (sent == 0) {
+            return 0;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EINVAL && errno != ENOSYS) {
+            return -1;
+        }
+        break; /* Not supported either, copy through the buffer */
+    }
+    if (length == 0) {
+        return 0;
+    }
+
+    if (lseek(fd_src, offset, SEEK_SET) == -1 || lseek(fd_dest, offset, SEEK_SET) == -1) {
+        return -1;
+    }
+    return copy_with_buffer(fd_src, fd_dest, length);
+}
+
+/*
+ * Description :
+ * 1. Function to copy the contents of an opened file into an empty opened target.
+ */
+static int copy_contents(int fd_src, int fd_dest, const struct stat *st)
+{
+    /* Pipes, devices and /proc files have no useful size, read them until the end */
+    if (!S_ISREG(st->st_mode) || st->st_size == 0) {
+        return copy_with_buffer(fd_src, fd_dest, -1);
+    }
+
+    /* On btrfs, XFS and others the target can share the source blocks, nothing is copied at all */
+    if (ioctl(fd_dest, FICLONE, fd_src) == 0) {
+        return 0;
+    }
+
+    /* A file using fewer blocks than its size has holes, copy only the data between them */
+    if ((off_t)st->st_blocks * 512 < st->st_size) {
+        off_t data = lseek(fd_src, 0, SEEK_DATA);
+        if (data != -1 || errno == ENXIO) {
+            while (data != -1 && data < st->st_size) {
+                off_t hole = lseek(fd_src, data, SEEK_HOLE);
+                if (hole == -1 || copy_range(fd_src, fd_dest, data, hole - data) == -1) {
+                    return -1;
+                }
+                data = lseek(fd_src, hole, SEEK_DATA);
+            }
+            if (data == -1 && errno != ENXIO) {
+                return -1; /* ENXIO means only a hole is left until the end */
+            }
+            /* The holes stay holes, including the one at the end */
+            return ftruncate(fd_dest, st->st_size);
+        }
+        /* The file system can't find the holes, copy it whole */
+    }
+
+    return copy_range(fd_src, fd_dest, 0, st->st_size);
+}
+
+/*
+ * Description :
+ * 1. Function to give an opened target the owner, permissions and timestamps of the source.
+ * 2. Only root can give files away, so a failed change of owner is not an error.
+ */
+static int preserve_metadata(int fd_dest, const struct stat *st)
+{
+    if (fchown(fd_dest, st->st_uid, st->st_gid) == -1 && errno != EPERM) {
+        return -1;
+    }
+    /* After fchown, it clears the set-user-ID bit */
+    if (fchmod(fd_dest, st->st_mode & 07777) == -1) {
+        return -1;
+    }
+    struct timespec times[2] = {st->st_atim, st->st_mtim};
+    return futimens(fd_dest, times);
+}
+
+/*
+ * Description :
+ * 1. Function to copy one file to target, which must not exist.
+ * 2. It tries a reflink first, then copy_file_range, sendfile and finally a read/write loop, keeping the holes of sparse files.
+ * 3. It returns 0 on success or -1 with errno set, the half written target is removed.
+ */
+int copy_file(const char *source, const char *target, int flags)
+{
+    int fd_src = open(source, O_RDONLY | O_CLOEXEC);
+    if (fd_src == -1) {
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd_src, &st) == -1) {
+        close(fd_src);
+        return -1;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        close(fd_src);
+        errno = EISDIR;
+        return -1;
+    }
+
+    /* O_EXCL: never overwrite a file that appeared after the caller checked */
+    int fd_dest = open(target, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, st.st_mode & 0777);
+    if (fd_dest == -1) {
+        close(fd_src);
+        return -1;
+    }
+
+    int result = copy_contents(fd_src, fd_dest, &st);
+    if (result == 0 && (flags & COPY_PRESERVE)) {
+        result = preserve_metadata(fd_dest, &st);
+    }
+    int saved_errno = errno;
+    close(fd_src);
+    if (close(fd_dest) == -1 && result == 0) {
+        result = -1; /* A delayed write error, the copy is not complete */
+        saved_errno = errno;
+    }
+
+    if (result == -1) {
+        unlink(target);
+        errno = saved_errno;
+    }
+    return result;
+}
+
+/*
+ * Description :
+ * 1. Function to print why a file couldn't be copied and count it, callable from any thread.
+ */
+static void copy_failed(copy_pool *pool, const char *source, const char *target, int error)
+{
+    pthread_mutex_lock(&pool->lock);
+    fprintf(stderr, "Error copying '%s' to '%s': %s\n", source, target, strerror(error));
+    pool->failures++;
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/*
+ * Description :
+ * 1. Function run by each worker thread, it copies files from the queue until the walk is done and the queue is empty.
+ */
+static void *copy_worker(void *arg)
+{
+    copy_pool *pool = arg;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        while (pool->count == 0 && !pool->walk_done) {
+            pthread_cond_wait(&pool->can_take, &pool->lock);
+        }
+        if (pool->count == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            return NULL;
+        }
+        copy_job job = pool->jobs[pool->head];
+        pool->head = (pool->head + 1) % COPY_QUEUE_SIZE;
+        pool->count--;
+        pthread_cond_signal(&pool->can_add);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (copy_file(job.source, job.target, pool->flags) == -1) {
+            copy_failed(pool, job.source, job.target, errno);
+        }
+        free(job.source);
+        free(job.target);
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to give a file to the workers, it waits while the queue is full.
+ * 2. The pool takes ownership of the two paths.
+ */
+static void copy_queue_file(copy_pool *pool, char *source, char *target)
+{
+    /* No worker could be started, copy it here */
+    if (pool->num_workers == 0) {
+        if (copy_file(source, target, pool->flags) == -1) {
+            copy_failed(pool, source, target, errno);
+        }
+        free(source);
+        free(target);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->count == COPY_QUEUE_SIZE) {
+        pthread_cond_wait(&pool->can_add, &pool->lock);
+    }
+    copy_job *job = &pool->jobs[(pool->head + pool->count) % COPY_QUEUE_SIZE];
+    job->source = source;
+    job->target = target;
+    pool->count++;
+    pthread_cond_signal(&pool->can_take);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+/*
+ * Description :
+ * 1. Function to recreate a symbolic link instead of copying the file it points to.
+ */
+static int copy_link(const char *source, const char *target, const struct stat *st, int flags)
+{
+    char link_target[PATH_MAX];
+    ssize_t len = readlink(source, link_target, sizeof(link_target) - 1);
+    if (len == -1) {
+        return -1;
+    }
+    link_target[len] = '\0';
+
+    if (symlink(link_target, target) == -1) {
+        return -1;
+    }
+    if (flags & COPY_PRESERVE) {
+        struct timespec times[2] = {st->st_atim, st->st_mtim};
+        if (lchown(target, st->st_uid, st->st_gid) == -1 && errno != EPERM) {
+            return -1;
+        }
+        return utimensat(AT_FDCWD, target, times, AT_SYMLINK_NOFOLLOW);
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to remember a created directory so its permissions and times are set when the copy is finished.
+ */
+static void copy_remember_directory(copy_pool *pool, const char *target, const struct stat *st)
+{
+    if (pool->num_directories == pool->max_directories) {
+        int max = pool->max_directories ? pool->max_directories * 2 : 16;
+        copy_directory *directories = realloc(pool->directories, max * sizeof(copy_directory));
+        if (directories == NULL) {
+            return; /* The directory keeps the permissions it was created with */
+        }
+        pool->directories = directories;
+        pool->max_directories = max;
+    }
+    pool->directories[pool->num_directories].target = strdup(target);
+    pool->directories[pool->num_directories].st = *st;
+    if (pool->directories[pool->num_directories].target != NULL) {
+        pool->num_directories++;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to walk a directory, creating its subdirectories and links here and queueing its files for the workers.
+ */
+static void copy_tree(copy_pool *pool, const char *source, const char *target, const struct stat *st)
+{
+    /* Writable by the owner until the files are inside, the real permissions are set at the end */
+    if (mkdir(target, (st->st_mode & 07777) | S_IRWXU) == -1) {
+        copy_failed(pool, source, target, errno);
+        return;
+    }
+    copy_remember_directory(pool, target, st);
+
+    DIR *dir = opendir(source);
+    if (dir == NULL) {
+        copy_failed(pool, source, target, errno);
+        return;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
+            continue;
+        }
+
+        char *entry_source;
+        char *entry_target;
+        if (asprintf(&entry_source, "%s/%s", source, entry->d_name) == -1) {
+            copy_failed(pool, source, target, ENOMEM);
+            continue;
+        }
+        if (asprintf(&entry_target, "%s/%s", target, entry->d_name) == -1) {
+            copy_failed(pool, entry_source, target, ENOMEM);
+            free(entry_source);
+            continue;
+        }
+
+        struct stat entry_st;
+        if (lstat(entry_source, &entry_st) == -1) {
+            copy_failed(pool, entry_source, entry_target, errno);
+        } else if (S_ISREG(entry_st.st_mode)) {
+            copy_queue_file(pool, entry_source, entry_target);
+            continue; /* The worker frees the paths */
+        } else if (S_ISDIR(entry_st.st_mode)) {
+            copy_tree(pool, entry_source, entry_target, &entry_st);
+        } else if (S_ISLNK(entry_st.st_mode)) {
+            if (copy_link(entry_source, entry_target, &entry_st, pool->flags) == -1) {
+                copy_failed(pool, entry_source, entry_target, errno);
+            }
+        } else {
+            /* Devices, pipes and sockets are not copied */
+            copy_failed(pool, entry_source, entry_target, ENOTSUP);
+        }
+        free(entry_source);
+        free(entry_target);
+    }
+    closedir(dir);
+}
+
+/*
+ * Description :
+ * 1. Function to check if target would be inside the source directory, copying it would never end.
+ */
+static int copy_into_itself(const char *source, const char *target)
+{
+    char source_real[PATH_MAX];
+    char parent_real[PATH_MAX];
+    char parent[PATH_MAX];
+
+    if (realpath(source, source_real) == NULL) {
+        return 0;
+    }
+
+    /* The target doesn't exist yet, its parent directory does */
+    snprintf(parent, sizeof(parent), "%s", target);
+    char *last_slash = strrchr(parent, '/');
+    if (last_slash == NULL) {
+        strcpy(parent, ".");
+    } else if (last_slash == parent) {
+        parent[1] = '\0';
+    } else {
+        *last_slash = '\0';
+    }
+    if (realpath(parent, parent_real) == NULL) {
+        return 0;
+    }
+
+    size_t len = strlen(source_real);
+    return strncmp(parent_real, source_real, len) == 0 && (parent_real[len] == '\0' || parent_real[len] == '/');
+}
+
+/*
+ * Description :
+ * 1. Function to copy a file, or a directory tree when COPY_RECURSIVE is given, to target which must not exist.
+ * 2. The files of a tree are copied by a pool of worker threads while the directories are walked.
+ * 3. It prints an error for every file that couldn't be copied and returns 0 if everything was copied, -1 otherwise.
+ */
+int copy_path(const char *source, const char *target, int flags)
+{
+    struct stat st;
+    if (stat(source, &st) == -1) {
+        fprintf(stderr, "Error copying '%s': %s\n", source, strerror(errno));
+        return -1;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        if (copy_file(source, target, flags) == -1) {
+            fprintf(stderr, "Error copying '%s' to '%s': %s\n", source, target, strerror(errno));
+            return -1;
+        }
+        return 0;
+    }
+
+    if (!(flags & COPY_RECURSIVE)) {
+        fprintf(stderr, "Error copying '%s': %s, use -r to copy directories\n", source, strerror(EISDIR));
+        return -1;
+    }
+    if (copy_into_itself(source, target)) {
+        fprintf(stderr, "Error copying '%s' to '%s': can't copy a directory into itself\n", source, target);
+        return -1;
+    }
+
+    copy_pool *pool = calloc(1, sizeof(copy_pool));
+    if (pool == NULL) {
+        perror("calloc");
+        return -1;
+    }
+    pool->flags = flags;
+    pool->umask = umask(0); /* Read the umask, the threads are not started yet */
+    umask(pool->umask);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->can_take, NULL);
+    pthread_cond_init(&pool->can_add, NULL);
+
+    /* The copies wait on the disk more than on the CPU, but more threads than cores gain nothing here */
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int max_workers = (cores < 1) ? 1 : (cores > COPY_MAX_WORKERS) ? COPY_MAX_WORKERS : (int)cores;
+    pthread_t workers[COPY_MAX_WORKERS];
+    while (pool->num_workers < max_workers &&
+           pthread_create(&workers[pool->num_workers], NULL, copy_worker, pool) == 0) {
+        pool->num_workers++;
+    }
+
+    copy_tree(pool, source, target, &st);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->walk_done = 1;
+    pthread_cond_broadcast(&pool->can_take);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->num_workers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+
+    /* Deepest directories first, setting the times of a parent must come after its children changed it */
+    for (int i = pool->num_directories - 1; i >= 0; i--) {
+        copy_directory *directory = &pool->directories[i];
+        if (flags & COPY_PRESERVE) {
+            struct timespec times[2] = {directory->st.st_atim, directory->st.st_mtim};
+            if (lchown(directory->target, directory->st.st_uid, directory->st.st_gid) == -1 && errno != EPERM) {
+                copy_failed(pool, source, directory->target, errno);
+            }
+            if (chmod(directory->target, directory->st.st_mode & 07777) == -1 ||
+                utimensat(AT_FDCWD, directory->target, times, 0) == -1) {
+                copy_failed(pool, source, directory->target, errno);
+            }
+        } else if ((directory->st.st_mode & S_IRWXU) != S_IRWXU &&
+                   chmod(directory->target, directory->st.st_mode & 07777 & ~pool->umask) == -1) {
+            /* Only the owner bits added by copy_tree need to be taken back */
+            copy_failed(pool, source, directory->target, errno);
+        }
+        free(directory->target);
+    }
+
+    int failures = pool->failures;
+    free(pool->directories);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->can_take);
+    pthread_cond_destroy(&pool->can_add);
+    free(pool);
+    return (failures == 0) ? 0 : -1;
+}
+
+/*
+ * Description :
+ * 1. Function called by nftw for every entry of a tree being removed, the contents of a directory come before it.
+ */
+static int remove_entry(const char *path, const struct stat *st, int type, struct FTW *ftw)
+{
+    (void)st;
+    (void)ftw;
+    if (((type == FTW_DP) ? rmdir(path) : unlink(path)) == -1) {
+        fprintf(stderr, "Error removing '%s': %s\n", path, strerror(errno));
+        return -1; /* Stop, the rest of the tree is kept */
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to remove a file, or a directory with all its contents.
+ */
+int remove_path(const char *path)
+{
+    /* FTW_PHYS: links are removed, never followed. FTW_DEPTH: children first */
+    return nftw(path, remove_entry, REMOVE_OPEN_FDS, FTW_PHYS | FTW_DEPTH);
+}
+
+/*
+ * Description :
+ * 1. Function to move a file or a directory to target, which must not exist.
+ * 2. On the same file system it is one rename, instant and atomic whatever the size.
+ * 3. Across file systems the source is copied with its owner, permissions and times, then removed.
+ */
+int move_path(const char *source, const char *target)
+{
+    /* RENAME_NOREPLACE: fail instead of replacing a target that appeared after the caller checked */
+    if (renameat2(AT_FDCWD, source, AT_FDCWD, target, RENAME_NOREPLACE) == 0) {
+        return 0;
+    }
+
+    /* Some file systems don't support the flag, check and rename without it */
+    if (errno == EINVAL || errno == ENOSYS) {
+        if (access(target, F_OK) == 0) {
+            errno = EEXIST;
+        } else if (rename(source, target) == 0) {
+            return 0;
+        }
+    }
+
+    if (errno == EINVAL) {
+        fprintf(stderr, "Error moving '%s' to '%s': can't move a directory into itself\n", source, target);
+        return -1;
+    }
+    if (errno != EXDEV) {
+        fprintf(stderr, "Error moving '%s' to '%s': %s\n", source, target, strerror(errno));
+        return -1;
+    }
+
+    /* Different file systems, there is no way around copying the data */
+    struct stat st;
+    if (lstat(source, &st) == -1) {
+        fprintf(stderr, "Error moving '%s': %s\n", source, strerror(errno));
+        return -1;
+    }
+    /* rename reports EXDEV before checking the target, and a failed copy removes the target */
+    struct stat target_st;
+    if (lstat(target, &target_st) == 0) {
+        errno = EEXIST;
+    }
+    if (errno != ENOENT) {
+        fprintf(stderr, "Error moving '%s' to '%s': %s\n", source, target, strerror(errno));
+        return -1;
+    }
+
+    int result;
+    if (S_ISLNK(st.st_mode)) {
+        result = copy_link(source, target, &st, COPY_PRESERVE);
+        if (result == -1) {
+            fprintf(stderr, "Error moving '%s' to '%s': %s\n", source, target, strerror(errno));
+        }
+    } else {
+        result = copy_path(source, target, COPY_RECURSIVE | COPY_PRESERVE);
+    }
+
+    if (result == -1) {
+        /* Keep the source, and don't leave half of it at the target */
+        if (lstat(target, &target_st) == 0) {
+            remove_path(target);
+        }
+        fprintf(stderr, "'%s' was not moved\n", source);
+        return -1;
+    }
+
+    /* Everything is at the target now */
+    if (remove_path(source) == -1) {
+        fprintf(stderr, "'%s' was copied to '%s' but couldn't be removed\n", source, target);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+ /******************************************************************************
+ *
+ * File Name: file_copy.h
+ *
+ * Description: Header file for file_copy.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef FILE_COPY_H
+#define FILE_COPY_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define COPY_BUFFER_SIZE    (1024 * 1024)   /* Buffer of the read/write fallback, used when the kernel can't copy by itself */
+#define COPY_BUFFER_ALIGN   (4096)          /* The buffer starts on a page boundary */
+#define COPY_MAX_WORKERS    (8)             /* Most threads copying the files of a directory tree at once */
+#define COPY_QUEUE_SIZE     (256)           /* Files waiting for a worker, the directory walk stops when it is full */
+
+/* Flags of copy_path */
+#define COPY_RECURSIVE      (1)     /* Copy directories with all their contents */
+#define COPY_PRESERVE       (2)     /* Keep the owner, permissions and timestamps of the source */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to copy one file to target, which must not exist.
+ * 2. It tries a reflink first, then copy_file_range, sendfile and finally a read/write loop, keeping the holes of sparse files.
+ * 3. It returns 0 on success or -1 with errno set, the half written target is removed.
+ */
+int copy_file(const char *source, const char *target, int flags);
+
+/*
+ * Description :
+ * 1. Function to copy a file, or a directory tree when COPY_RECURSIVE is given, to target which must not exist.
+ * 2. The files of a tree are copied by a pool of worker threads while the directories are walked.
+ * 3. It prints an error for every file that couldn't be copied and returns 0 if everything was copied, -1 otherwise.
+ */
+int copy_path(const char *source, const char *target, int flags);
+
+/*
+ * Description :
+ * 1. Function to remove a file, or a directory with all its contents.
+ */
+int remove_path(const char *path);
+
+/*
+ * Description :
+ * 1. Function to move a file or a directory to target, which must not exist.
+ * 2. On the same file system it is one rename, instant and atomic whatever the size.
+ * 3. Across file systems the source is copied with its owner, permissions and times, then removed.
+ * 4. It prints why a move failed and returns 0 on success, -1 otherwise.
+ */
+int move_path(const char *source, const char *target);
+
+#endif // FILE_COPY_H
@@ -0,0 +1,300 @@
+ /******************************************************************************
+ *
+ * File Name: filters.c
+ *
+ * Description: Source file for the internal commands mycat and mygrep, filters that run inside the shell
+ *              so short pipelines don't start a program for every stage
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE  /* For strcasestr */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <regex.h>
+#include "filters.h"
+#include "my_shell.h"
+
+/* Struct to save the options of mygrep */
+typedef struct {
+    regex_t regex;
+    const char *fixed;      /* The pattern when it has no special characters, it is searched without the regex engine */
+    char ignore_case;       /* -i */
+    char invert;            /* -v */
+    char line_numbers;      /* -n */
+    char count_only;        /* -c */
+    char extended;          /* -E */
+    char show_names;        /* More than one file, every line starts with its file name */
+} grep_options;
+
+/*
+ * Description :
+ * 1. Function to open a file for a filter, - is the standard input.
+ * 2. It returns the descriptor or -1 after printing why the file can't be opened.
+ */
+static int open_filter_file(const char *command, const char *file)
+{
+    if (strcmp(file, "-") == 0) {
+        return STDIN;
+    }
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        fprintf(stderr, "%s: %s: %s\n", command, file, strerror(errno));
+    }
+    return fd;
+}
+
+/*
+ * Description :
+ * 1. Function to copy everything from one descriptor to another.
+ * 2. It returns 0, or -1 with errno set.
+ */
+static int copy_fd(int in_fd, int out_fd)
+{
+    char buffer[FILTER_BUFFER_SIZE];
+    while (1) {
+        ssize_t bytes = read(in_fd, buffer, sizeof(buffer));
+        if (bytes == 0) {
+            return 0;
+        }
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        for (ssize_t written = 0; written < bytes; ) {
+            ssize_t result = write(out_fd, buffer + written, bytes - written);
+            if (result == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return -1;
+            }
+            written += result;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command mycat [file...], it writes the files one after the other.
+ * 2. Without files, or for the file -, it copies the standard input, so it can end a pipeline.
+ */
+int fun_CAT(int argc, char **argv)
+{
+    static char *const standard_input[] = {"-", NULL};
+    char *const *files = (argc > 1) ? argv + 1 : standard_input;
+    int status = 0;
+
+    fflush(stdout); /* The files are written directly to the descriptor, after what was printed before */
+    for (int i = 0; files[i] != NULL; i++) {
+        int fd = open_filter_file("mycat", files[i]);
+        if (fd == -1) {
+            status = 1;
+            continue;
+        }
+        if (copy_fd(fd, STDOUT) == -1) {
+            fprintf(stderr, "mycat: %s: %s\n", files[i], strerror(errno));
+            status = 1;
+        }
+        if (fd != STDIN) {
+            close(fd);
+        }
+    }
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to check if a line is selected by mygrep.
+ */
+static int line_selected(const grep_options *options, const char *line)
+{
+    int found;
+    if (options->fixed != NULL) {
+        found = ((options->ignore_case) ? strcasestr(line, options->fixed) : strstr(line, options->fixed)) != NULL;
+    } else {
+        found = (regexec(&options->regex, line, 0, NULL, 0) == 0);
+    }
+    return found != options->invert;
+}
+
+/*
+ * Description :
+ * 1. Function to check one line and print it if it is selected.
+ */
+static void grep_line(const grep_options *options, const char *name, const char *line, size_t length,
+                      long line_number, long *selected)
+{
+    if (!line_selected(options, line)) {
+        return;
+    }
+    (*selected)++;
+    if (options->count_only) {
+        return;
+    }
+    if (options->show_names) {
+        printf("%s:", name);
+    }
+    if (options->line_numbers) {
+        printf("%ld:", line_number);
+    }
+    fwrite(line, 1, length, stdout);
+    putchar('\n');
+}
+
+/*
+ * Description :
+ * 1. Function to run mygrep on one descriptor, the lines are cut in a buffer that grows for long lines.
+ * 2. It returns the number of selected lines, or -1 with errno set if reading failed.
+ */
+static long grep_fd(const grep_options *options, int fd, const char *name)
+{
+    size_t cap = FILTER_BUFFER_SIZE;
+    char *data = malloc(cap + 1); /* One more byte for the '\0' of a last line without '\n' */
+    if (data == NULL) {
+        return -1;
+    }
+
+    size_t len = 0; /* Bytes in data, the start of a line that isn't complete yet */
+    long line_number = 0;
+    long selected = 0;
+    while (1) {
+        if (len == cap) {
+            char *grown = realloc(data, cap * 2 + 1);
+            if (grown == NULL) {
+                free(data);
+                return -1;
+            }
+            data = grown;
+            cap *= 2;
+        }
+        ssize_t bytes = read(fd, data + len, cap - len);
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            free(data);
+            return -1;
+        }
+        if (bytes == 0) {
+            break;
+        }
+
+        /* Only the new bytes are searched for the end of a line, the kept part has none */
+        char *line = data;
+        char *end = data + len + bytes;
+        char *newline = data + len;
+        while ((newline = memchr(newline, '\n', end - newline)) != NULL) {
+            *newline = '\0';
+            grep_line(options, name, line, newline - line, ++line_number, &selected);
+            line = ++newline;
+        }
+        len = end - line;
+        memmove(data, line, len);
+    }
+
+    if (len > 0) {
+        data[len] = '\0';
+        grep_line(options, name, data, len, ++line_number, &selected);
+    }
+    free(data);
+    return selected;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command mygrep [-i] [-v] [-n] [-c] [-E] pattern [file...].
+ * 2. It prints the lines that match the pattern, a basic regular expression like grep, or an extended one with -E.
+ *    -i ignores case, -v prints the lines that don't match, -n adds line numbers and -c only counts the lines.
+ * 3. Without files it reads the standard input. It returns 0 if a line matched, 1 if none did and 2 on errors.
+ */
+int fun_GREP(int argc, char **argv)
+{
+    grep_options options;
+    memset(&options, 0, sizeof(options));
+
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        for (const char *flag = argv[first] + 1; *flag != '\0'; flag++) {
+            switch (*flag) {
+            case 'i': options.ignore_case = 1; break;
+            case 'v': options.invert = 1; break;
+            case 'n': options.line_numbers = 1; break;
+            case 'c': options.count_only = 1; break;
+            case 'E': options.extended = 1; break;
+            default:
+                fprintf(stderr, "mygrep: unknown option -%c\nusage: mygrep [-i] [-v] [-n] [-c] [-E] pattern [file...]\n", *flag);
+                return STATUS_GREP_ERROR;
+            }
+        }
+    }
+    if (first >= argc) {
+        fprintf(stderr, "usage: mygrep [-i] [-v] [-n] [-c] [-E] pattern [file...]\n");
+        return STATUS_GREP_ERROR;
+    }
+
+    /* A plain word is searched with strstr, much faster than running the regex engine on every line */
+    const char *pattern = argv[first++];
+    const char *special = options.extended ? "\\.[]*^$+?(){}|" : "\\.[]*^$";
+    if (strpbrk(pattern, special) == NULL) {
+        options.fixed = pattern;
+    } else {
+        int flags = REG_NOSUB | (options.extended ? REG_EXTENDED : 0) | (options.ignore_case ? REG_ICASE : 0);
+        int error = regcomp(&options.regex, pattern, flags);
+        if (error != 0) {
+            char message[128];
+            regerror(error, &options.regex, message, sizeof(message));
+            fprintf(stderr, "mygrep: %s\n", message);
+            return STATUS_GREP_ERROR;
+        }
+    }
+
+    static char *const standard_input[] = {"-", NULL};
+    char *const *files = (first < argc) ? argv + first : standard_input;
+    options.show_names = (argc - first > 1);
+    long total = 0;
+    char failed = 0;
+    for (int i = 0; files[i] != NULL; i++) {
+        const char *name = (strcmp(files[i], "-") == 0) ? "(standard input)" : files[i];
+        int fd = open_filter_file("mygrep", files[i]);
+        if (fd == -1) {
+            failed = 1;
+            continue;
+        }
+        long selected = grep_fd(&options, fd, name);
+        if (selected == -1) {
+            fprintf(stderr, "mygrep: %s: %s\n", name, strerror(errno));
+            failed = 1;
+        } else {
+            total += selected;
+            if (options.count_only) {
+                if (options.show_names) {
+                    printf("%s:", name);
+                }
+                printf("%ld\n", selected);
+            }
+        }
+        if (fd != STDIN) {
+            close(fd);
+        }
+    }
+
+    if (options.fixed == NULL) {
+        regfree(&options.regex);
+    }
+    if (failed) {
+        return STATUS_GREP_ERROR;
+    }
+    return (total > 0) ? 0 : STATUS_NO_MATCH;
+}
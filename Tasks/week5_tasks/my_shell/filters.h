@@ -0,0 +1,42 @@
+ /******************************************************************************
+ *
+ * File Name: filters.h
+ *
+ * Description: Header file for filters.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef FILTERS_H
+#define FILTERS_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define FILTER_BUFFER_SIZE  (65536)     /* Bytes read from a file at once */
+#define STATUS_NO_MATCH     (1)         /* Status of mygrep when no line matched, like grep */
+#define STATUS_GREP_ERROR   (2)         /* Status of mygrep when a file can't be read or the pattern is wrong */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command mycat [file...], it writes the files one after the other.
+ * 2. Without files, or for the file -, it copies the standard input, so it can end a pipeline.
+ */
+int fun_CAT(int argc, char **argv);
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command mygrep [-i] [-v] [-n] [-c] [-E] pattern [file...].
+ * 2. It prints the lines that match the pattern, a basic regular expression like grep, or an extended one with -E.
+ *    -i ignores case, -v prints the lines that don't match, -n adds line numbers and -c only counts the lines.
+ * 3. Without files it reads the standard input. It returns 0 if a line matched, 1 if none did and 2 on errors.
+ */
+int fun_GREP(int argc, char **argv);
+
+#endif // FILTERS_H
@@ -0,0 +1,281 @@
+ /******************************************************************************
+ *
+ * File Name: history.c
+ *
+ * Description: Source file for the command line history, kept in a file mapped with mmap so it survives the shell,
+ *              and the internal command history
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <time.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "history.h"
+
+static history_header *history = NULL; /* Start of the mapping, NULL if there is no history */
+static history_entry *history_index; /* Ring of HISTORY_ENTRIES lines after the header */
+static char *history_text; /* Ring of HISTORY_TEXT_SIZE bytes after the index */
+static int history_fd = -1; /* Descriptor of the file, locked while a line is added, -1 for a history in memory */
+static char history_line[HISTORY_LINE_MAX + 1]; /* Line returned by history_get, the text may wrap around the ring */
+
+/*
+ * Description :
+ * 1. Function to get the size of the history file: the header, the index ring and the text ring.
+ */
+static size_t history_size(void)
+{
+    return sizeof(history_header) + HISTORY_ENTRIES * sizeof(history_entry) + HISTORY_TEXT_SIZE;
+}
+
+/*
+ * Description :
+ * 1. Function to write an empty history.
+ */
+static void history_reset(void)
+{
+    memset(history, 0, history_size());
+    memcpy(history->magic, HISTORY_MAGIC, sizeof(history->magic));
+    history->entries = HISTORY_ENTRIES;
+    history->text_size = HISTORY_TEXT_SIZE;
+}
+
+/*
+ * Description :
+ * 1. Function to check that a mapped file starts with the header of a history of this layout.
+ */
+static int history_valid(const history_header *header)
+{
+    return memcmp(header->magic, HISTORY_MAGIC, sizeof(header->magic)) == 0 &&
+           header->entries == HISTORY_ENTRIES && header->text_size == HISTORY_TEXT_SIZE;
+}
+
+/*
+ * Description :
+ * 1. Function to lock the history file while it is changed, other shells may use the same file.
+ */
+static void history_lock(int operation)
+{
+    if (history_fd != -1) {
+        while (flock(history_fd, operation) == -1 && errno == EINTR) {
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to open the history file and check it is a history file of the right size.
+ * 2. It returns the descriptor, locked until history_open has checked or written the header,
+ *    or -1 if the file can't be used. fresh is set if the file is new.
+ */
+static int history_open_file(const char *path, char *fresh)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd == -1) {
+        return -1;
+    }
+    /* Another shell creating the same file at the same time waits until its header is written */
+    while (flock(fd, LOCK_EX) == -1 && errno == EINTR) {
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == 0) {
+        if (file_stat.st_size == (off_t)history_size()) {
+            *fresh = 0;
+            return fd;
+        }
+        /* Only an empty file becomes a history, any other file is left as it is */
+        if (file_stat.st_size == 0 && ftruncate(fd, history_size()) == 0) {
+            *fresh = 1;
+            return fd;
+        }
+        errno = EINVAL;
+    }
+    close(fd);
+    return -1;
+}
+
+/*
+ * Description :
+ * 1. Function to map the history file, $MY_SHELL_HISTFILE or ~/.my_shell_history, it is created if it doesn't exist.
+ * 2. The file is the header, the index ring and the text ring, used in place with mmap: loading it reads nothing
+ *    and adding a line writes it in memory, the kernel saves it in the file.
+ * 3. If the file can't be used, or it isn't a history file of this layout, the history is kept in memory
+ *    for this session only and the file is left as it is.
+ */
+void history_open(void)
+{
+    char path[PATH_MAX];
+    const char *file = getenv("MY_SHELL_HISTFILE");
+    const char *home = getenv("HOME");
+    if (file == NULL || file[0] == '\0') {
+        snprintf(path, sizeof(path), "%s/%s", (home != NULL) ? home : ".", HISTORY_FILE_NAME);
+        file = path;
+    }
+
+    char fresh = 1;
+    int fd = history_open_file(file, &fresh);
+    void *map = MAP_FAILED;
+    if (fd != -1) {
+        map = mmap(NULL, history_size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (map != MAP_FAILED && !fresh && !history_valid(map)) {
+        /* A file of the same size that isn't a history, or one written with other sizes */
+        munmap(map, history_size());
+        map = MAP_FAILED;
+        errno = EINVAL;
+    }
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "my_shell: %s: %s, the history is only kept until exit\n", file, strerror(errno));
+        if (fd != -1) {
+            if (fresh && ftruncate(fd, 0) == -1) {
+                /* The file stays at the history size, it will be refused the next time too */
+            }
+            close(fd);
+            fd = -1;
+        }
+        fresh = 1;
+        map = mmap(NULL, history_size(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (map == MAP_FAILED) {
+            return;
+        }
+    }
+
+    history = map;
+    history_index = (history_entry *)(history + 1);
+    history_text = (char *)(history_index + HISTORY_ENTRIES);
+    history_fd = fd;
+
+    if (fresh) {
+        history_reset(); /* Only a file created just now, or the memory, is written before it is a history */
+    }
+    history_lock(LOCK_UN);
+}
+
+/*
+ * Description :
+ * 1. Function to get a remembered line, age 0 is the newest.
+ * 2. It returns the line, valid until the next call, or NULL when there is no older line.
+ *    number is set to the number of the line like the history command shows it, if it isn't NULL.
+ */
+const char *history_get(int age, uint64_t *number)
+{
+    if (history == NULL || age < 0 || age >= HISTORY_ENTRIES || (uint64_t)age >= history->count) {
+        return NULL;
+    }
+
+    uint64_t line_number = history->count - age;
+    const history_entry *entry = &history_index[(line_number - 1) % HISTORY_ENTRIES];
+    if (entry->number != line_number || entry->length > HISTORY_LINE_MAX ||
+        history->text_end - entry->text_start > HISTORY_TEXT_SIZE) {
+        return NULL; /* Its text was overwritten by newer lines */
+    }
+
+    /* The text may continue at the start of the ring */
+    size_t offset = entry->text_start % HISTORY_TEXT_SIZE;
+    size_t first = HISTORY_TEXT_SIZE - offset;
+    if (first > entry->length) {
+        first = entry->length;
+    }
+    memcpy(history_line, history_text + offset, first);
+    memcpy(history_line + first, history_text, entry->length - first);
+    history_line[entry->length] = '\0';
+
+    if (number != NULL) {
+        *number = line_number;
+    }
+    return history_line;
+}
+
+/*
+ * Description :
+ * 1. Function to remember a line entered by the user, empty lines and repeats of the last line are skipped.
+ */
+void history_add(const char *line)
+{
+    size_t length = strlen(line);
+    if (history == NULL || length > HISTORY_LINE_MAX || strspn(line, " \t") == length) {
+        return;
+    }
+
+    history_lock(LOCK_EX);
+    const char *last = history_get(0, NULL);
+    if (last == NULL || strcmp(last, line) != 0) {
+        /* The text is written first, then its slot, and the counters last so a reader never sees half a line */
+        size_t offset = history->text_end % HISTORY_TEXT_SIZE;
+        size_t first = HISTORY_TEXT_SIZE - offset;
+        if (first > length) {
+            first = length;
+        }
+        memcpy(history_text + offset, line, first);
+        memcpy(history_text, line + first, length - first);
+
+        history_entry *entry = &history_index[history->count % HISTORY_ENTRIES];
+        entry->number = history->count + 1;
+        entry->text_start = history->text_end;
+        entry->length = length;
+        entry->time = time(NULL);
+
+        history->text_end += length;
+        history->count++;
+    }
+    history_lock(LOCK_UN);
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command history: history [n] prints the last n lines, all of them
+ *    without n, history -c forgets them.
+ */
+int fun_HISTORY(int argc, char **argv)
+{
+    if (argc > 2) {
+        printf("history: usage: history [n] or history -c\n");
+        return 1;
+    }
+    if (history == NULL) {
+        printf("history: the history couldn't be loaded\n");
+        return 1;
+    }
+
+    if (argc == 2 && strcmp(argv[1], "-c") == 0) {
+        history_lock(LOCK_EX);
+        history_reset();
+        history_lock(LOCK_UN);
+        return 0;
+    }
+
+    int limit = HISTORY_ENTRIES;
+    if (argc == 2) {
+        char *end;
+        long number = strtol(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0' || number < 0) {
+            printf("history: %s: numeric argument required\n", argv[1]);
+            return 1;
+        }
+        if (number < limit) {
+            limit = number;
+        }
+    }
+
+    /* Count the lines first, they are printed from the oldest */
+    int available = 0;
+    while (available < limit && history_get(available, NULL) != NULL) {
+        available++;
+    }
+    for (int age = available - 1; age >= 0; age--) {
+        uint64_t number;
+        const char *line = history_get(age, &number);
+        printf("%5llu  %s\n", (unsigned long long)number, line);
+    }
+    return 0;
+}
@@ -0,0 +1,79 @@
+ /******************************************************************************
+ *
+ * File Name: history.h
+ *
+ * Description: Header file for history.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define HISTORY_FILE_NAME   (".my_shell_history")  /* In $HOME, $MY_SHELL_HISTFILE can give another file */
+#define HISTORY_MAGIC       ("MYSHIST1")            /* First bytes of the file, the layout below */
+#define HISTORY_ENTRIES     (1000)                  /* Lines remembered, the oldest is overwritten */
+#define HISTORY_TEXT_SIZE   (128 * 1024)            /* Bytes of the text ring, long lines leave room for fewer lines */
+#define HISTORY_LINE_MAX    (4096)                  /* Longer lines are not remembered */
+
+/* Header at the start of the history file, the counters only grow, the slot is the counter modulo the size */
+typedef struct {
+    char magic[8];
+    uint32_t entries;       /* HISTORY_ENTRIES when the file was created */
+    uint32_t text_size;     /* HISTORY_TEXT_SIZE when the file was created */
+    uint64_t count;         /* Lines ever added */
+    uint64_t text_end;      /* Bytes ever written to the text ring */
+} history_header;
+
+/* One slot of the index ring, the text of a line is at text_start modulo text_size in the text ring */
+typedef struct {
+    uint64_t number;        /* 1 for the first line ever added, 0 for an empty slot */
+    uint64_t text_start;
+    uint32_t length;
+    uint32_t reserved;
+    int64_t time;           /* When the line was entered */
+} history_entry;
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to map the history file, $MY_SHELL_HISTFILE or ~/.my_shell_history, it is created if it doesn't exist.
+ * 2. The file is the header, the index ring and the text ring, used in place with mmap: loading it reads nothing
+ *    and adding a line writes it in memory, the kernel saves it in the file.
+ * 3. If the file can't be used, or it isn't a history file of this layout, the history is kept in memory
+ *    for this session only and the file is left as it is.
+ */
+void history_open(void);
+
+/*
+ * Description :
+ * 1. Function to remember a line entered by the user, empty lines and repeats of the last line are skipped.
+ */
+void history_add(const char *line);
+
+/*
+ * Description :
+ * 1. Function to get a remembered line, age 0 is the newest.
+ * 2. It returns the line, valid until the next call, or NULL when there is no older line.
+ *    number is set to the number of the line like the history command shows it, if it isn't NULL.
+ */
+const char *history_get(int age, uint64_t *number);
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command history: history [n] prints the last n lines, all of them
+ *    without n, history -c forgets them.
+ */
+int fun_HISTORY(int argc, char **argv);
+
+#endif // HISTORY_H
@@ -16,198 +16,233 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/wait.h>
+#include <limits.h>
+#include <ctype.h>
 #include "internal_commands.h"
+#include "my_shell.h"  /* for ERROR_MESSAGE and the colors of exit */
 #include "external_commands.h"  /* to use is_external_command function in fun_TYPE */
+#include "command_hash.h"  /* to print the path of an external command in fun_TYPE */
+#include "file_copy.h"  /* to copy and move files and directories in fun_COPY and fun_MOVE */
+#include "executor.h"  /* to stop the shell in fun_EXIT */
+#include "jobs.h"  /* for the job control commands and phist */
+#include "parallel.h"  /* for fun_PARALLEL */
+#include "filters.h"  /* for fun_CAT and fun_GREP */
+#include "history.h"  /* for fun_HISTORY */
+#include "local_variables.h"  /* for the table of local variables */
 
 char pwd_PATH[PWD_BUFFER]; /* Array of characters that store the paths of the pwd */
+char pwd_changed = 1; /* Set by cd, the prompt is built again only when the directory changed */
 extern char** environ; /* Get environ for env Function */
-static const char *internal_commands[] = {"cd", "mypwd", "myecho", "help", "exit", "type", "mycp", "mymv", "envir", "phist", "free", "uptime", "allvars", NULL}; /* List of internal commands, PHIST is implemented in external_commands.c but it is an internal command */
-static int exit_from_fun_PATH_CHECKSPACES = 1; /* To exit from fun_PATH_CHECKSPACES while loop */
-static int return_variable = 0; /* Global variable that is used in fun_COPY and fun_MOVE to return from function fun_PATH_CONCATENATE if the filename ends with '\' */
-static local_variable local_vars[MAX_LOCAL_VARIABLES];
-static int local_var_count = 0;
+
+static int fun_MYPWD(int argc, char **argv);
+
+/* List of internal commands, PHIST, ACCOUNTING and the job commands are implemented in jobs.c, PARALLEL in parallel.c, CAT and GREP in filters.c, HISTORY in history.c and HASH in command_hash.c but they are internal commands */
+static const internal_command internal_commands[] = {
+    {"cd", fun_CD}, {"mypwd", fun_MYPWD}, {"myecho", fun_ECHO}, {"help", fun_HELP}, {"exit", fun_EXIT},
+    {"type", fun_TYPE}, {"mycp", fun_COPY}, {"mymv", fun_MOVE}, {"envir", fun_ENVIR}, {"phist", fun_PHIST},
+    {"free", fun_FREE}, {"uptime", fun_UPTIME}, {"allvars", fun_ALLVARS}, {"hash", fun_HASH}, {"set", fun_SET},
+    {"jobs", fun_JOBS}, {"fg", fun_FG}, {"bg", fun_BG}, {"wait", fun_WAIT},
+    {"parallel", fun_PARALLEL}, {"mycat", fun_CAT}, {"mygrep", fun_GREP},
+    {"history", fun_HISTORY}, {"accounting", fun_ACCOUNTING},
+    {NULL, NULL}
+};
 
 /*
  * Description :
- * 1. Function to set local variables.
+ * 1. Function to print Error message if the user inputs a wrong format.
  */
-static void SET_LOCAL_VARIABLE(char *name, char *value) 
+static void ERROR_MESSAGE_FOR_LOCAL_VARIABLES()
 {
-    /* Iterate through existing local variables to check if the variable already exists */
-    for (int i = 0; i < local_var_count; i++) {
-        /* If variable name exists, update its value */
-        if (strcmp(local_vars[i].name, name) == 0) {
-            free(local_vars[i].value);
-            local_vars[i].value = strdup(value);
-            return;
-        }
-    }
-    /* If variable doesn't exist and there's room, add new variable */
-    if (local_var_count < MAX_LOCAL_VARIABLES) {
-        local_vars[local_var_count].name = strdup(name);
-        local_vars[local_var_count].value = strdup(value);
-        local_var_count++;
+    fflush(stdout); /* Flush the output buffer */
+    printf("Please Enter a valid command -_- use help to know all commands \n");
+    printf("When Trying to assign Envir use this format only\nset variable_name=variable value (quote the value if it has spaces)\nNote:\n-You remove set to assign local variables\n-Variable name is letters, digits and _ and can't start with a digit\n");
+}
+
+/*
+ * Description :
+ * 1. Function to check if the first length characters of name are a valid variable name.
+ */
+int is_variable_name(const char *name, size_t length)
+{
+    if (length == 0 || !(isalpha((unsigned char)name[0]) || name[0] == '_')) {
+        return 0;
     }
-    else 
-    {
-        /* If the maximum number of local variables is reached, print an error */
-        printf("Error You have reached the maximum number of local variables *_* \n");
+    for (size_t i = 1; i < length; i++) {
+        if (!(isalnum((unsigned char)name[i]) || name[i] == '_')) {
+            return 0;
+        }
     }
+    return 1;
 }
 
 /*
  * Description :
- * 1. Function to print Error message if the user inputs a wrong format.
+ * 1. Function to get the value of a variable, local variables hide environment variables with the same name.
+ * 2. The name is the first length characters of name, so a word is expanded without copying the names in it.
+ * 3. It returns NULL if the variable doesn't exist.
  */
-static void ERROR_MESSAGE_FOR_LOCAL_VARIABLES()
+const char *get_variable(const char *name, size_t length)
 {
-    fflush(stdout); /* Flush the output buffer */
-    printf("Please Enter a valid command -_- use help to know all commands \n");
-    printf("When Trying to assign Envir use this format only\nset variable_name = variable value between two Qoutes\nNote:\n-You remove set to assign local variables\n-Variable name can't contain spaces\n");
+    const char *value = local_variable_get(name, length);
+    if (value != NULL) {
+        return value;
+    }
+    for (int i = 0; environ[i] != NULL; i++) {
+        if (strncmp(environ[i], name, length) == 0 && environ[i][length] == '=') {
+            return environ[i] + length + 1;
+        }
+    }
+    return NULL;
 }
 
 /*
  * Description :
- * 1. Function to add a local variable to the shell.
+ * 1. Function to add a local or environment variable to the shell from an assignment name=value.
+ * 2. The quotes were already removed by the parser, so the value is taken as it is.
  */
-void fun_PLACE_VARIABLE(char *input_string_main_copy, char *equal_sign, char VARIABLE_MODE)
+int fun_PLACE_VARIABLE(const char *assignment, char VARIABLE_MODE)
 {
-    /* First, check for quotes in the input string */
-    char *first_quote_sign = strchr(input_string_main_copy, '"');
-    if (first_quote_sign == NULL) 
-    {
-        /* If no quotes are found, display an error message */
+    const char *equal_sign = strchr(assignment, '=');
+    if (equal_sign == NULL || !is_variable_name(assignment, equal_sign - assignment)) {
         ERROR_MESSAGE_FOR_LOCAL_VARIABLES();
-        return;
+        return 1;
     }
 
-    /* Error if the first quote is before the equal sign */
-    if (first_quote_sign != NULL && first_quote_sign < equal_sign)
-    {
-        ERROR_MESSAGE_FOR_LOCAL_VARIABLES();
-        return;
+    /* Local variables are set straight from the assignment, the name is the part before '=' */
+    if (!VARIABLE_MODE) {
+        if (local_variable_set(assignment, equal_sign - assignment, equal_sign + 1) != 0) {
+            printf("Memory allocation failed.\n");
+            return 1;
+        }
+        return 0;
     }
 
-    /* Check for the presence of the last quotes and make sure that it doesn't equal the position of the first quote */
-    char *last_quote_sign = strrchr(input_string_main_copy, '"');
-    if (last_quote_sign == NULL || (first_quote_sign == last_quote_sign)) 
-    {
-        ERROR_MESSAGE_FOR_LOCAL_VARIABLES();
-        return;
+    /* First part before '=' is the variable name */
+    char *name = strndup(assignment, equal_sign - assignment);
+    if (name == NULL) {
+        printf("Memory allocation failed.\n");
+        return 1;
     }
 
-    *equal_sign = '\0'; /* Split the command into name and value */
-
-    /* First part before '=' is the variable name */
-    char *name = input_string_main_copy;
-    name = strtok(name, " "); /* Remove spaces if the user put spaces between the variable name and '=' operation */
-    char *check_name = strtok(NULL, " "); /* Check that no spaces are in the variable name */
-    if (check_name != NULL) 
+    int status = 0;
+    /* Set the environment variable */
+    if (setenv(name, equal_sign + 1, 1) != 0)
     {
-        ERROR_MESSAGE_FOR_LOCAL_VARIABLES();
-        return;
+        perror("setenv"); /* Print an error if setenv fails */
+        status = 1;
     }
+    free(name);
+    return status;
+}
 
-    /* Remove quotes from value */
-    first_quote_sign++; /* Move past the first quote */
-    *last_quote_sign = '\0'; /* Null-terminate before the last quote */
-
-    /* Check if it's an environment variable or a local variable */
-    if (VARIABLE_MODE)
-    {   
-        /* Set the environment variable */
-        if (setenv(name, first_quote_sign, 1) != 0)
-        {
-            perror("setenv"); /* Print an error if setenv fails */
-        }
+/*
+ * Description :
+ * 1. Function to be called for the internal command set to add an environment variable.
+ * 2. set name=value, or set name = value.
+ */
+int fun_SET(int argc, char **argv)
+{
+    if (argc == 2) {
+        return fun_PLACE_VARIABLE(argv[1], ENVIROMENT_VARIABLE);
     }
-    else
-    {
-        /* Set a local variable */
-        SET_LOCAL_VARIABLE(name, first_quote_sign);
+    if (argc == 4 && strcmp(argv[2], "=") == 0) {
+        char *assignment = malloc(strlen(argv[1]) + strlen(argv[3]) + 2);
+        if (assignment == NULL) {
+            printf("Memory allocation failed.\n");
+            return 1;
+        }
+        sprintf(assignment, "%s=%s", argv[1], argv[3]);
+        int status = fun_PLACE_VARIABLE(assignment, ENVIROMENT_VARIABLE);
+        free(assignment);
+        return status;
     }
+    ERROR_MESSAGE_FOR_LOCAL_VARIABLES();
+    return 1;
 }
 
 /*
  * Description :
  * 1. Function to print environment variables.
  */
-void fun_ENVIR(char *token)
+int fun_ENVIR(int argc, char **argv)
 {
-    /* If no token is provided, print all environment variables */
-    if (token == NULL) {
+    /* If no name is provided, print all environment variables */
+    if (argc == 1) {
         int i = 0;
         while (environ[i] != NULL)
         {
             printf("%s\n", environ[i++]);
         }
+        return 0;
     }
-    else
+
+    if (argc > 2)
     {
-        char *check = strtok(NULL, " "); /* Check if there is any additional input after the token */
-        if (check != NULL)
-        {
-            printf("Envir Variables Doesn't have spaces in the name, so try to find the correct name \n");
-            return;
-        }
-        /* Get the environment variable value by name */
-        char *variable = getenv(token);
-        if (variable == NULL)
-        {
-            fflush(stdout); /* Flush the output buffer */
-            printf("Sorry for you, Environment Doesn't have a variable = %s \n", token);
-        }
-        else 
-        {
-            printf("%s = %s \n", token, variable);
-        }
+        printf("Envir Variables Doesn't have spaces in the name, so try to find the correct name \n");
+        return 1;
     }
+    /* Get the environment variable value by name */
+    char *variable = getenv(argv[1]);
+    if (variable == NULL)
+    {
+        fflush(stdout); /* Flush the output buffer */
+        printf("Sorry for you, Environment Doesn't have a variable = %s \n", argv[1]);
+        return 1;
+    }
+    printf("%s = %s \n", argv[1], variable);
+    return 0;
 }
 
 /*
  * Description :
  * 1. Function to print all local and environment variables.
  */
-void fun_ALLVARS(char *which_variables)
+int fun_ALLVARS(int argc, char **argv)
 {
+    const char *which_variables = (argc == 2) ? argv[1] : NULL;
+
     /* If no argument is passed, print both local and environment variables */
-    if (which_variables == NULL) {
+    if (argc == 1) {
         /* Print local variables */
         printf("------- Local Variables ------- \n");
-        for (int i = 0; i < local_var_count; ++i) {
-            printf("%s=%s\n", local_vars[i].name, local_vars[i].value);
-        }
+        local_variables_print();
 
         /* Print environment variables */
         printf("\n------- ENVIR Variables ------- \n");
-        fun_ENVIR(NULL);
+        fun_ENVIR(1, argv);
     } 
-    else if (strcmp(which_variables, "-l") == 0) {
+    else if (which_variables != NULL && strcmp(which_variables, "-l") == 0) {
         /* Print local variables only if "-l" argument is passed */
         printf("------- Local Variables ------- \n");
-        for (int i = 0; i < local_var_count; ++i) {
-            printf("%s=%s\n", local_vars[i].name, local_vars[i].value);
-        }
+        local_variables_print();
     } 
     else {
         /* Print an error message if an invalid argument is passed */
         printf("Please Enter a valid command -_- use help to know all commands \n");
         printf("allvars: prints all local and envir variables\nallvars -l: print local variables only\n");
         printf("envir: prints environment variables only\n");
+        return 1;
     }
+    return 0;
 }
 
 /*
  * Description :
  * 1. Function to check the path /proc/uptime and print the uptime for the system and the total time spent in IDLE.
  */
-void fun_UPTIME()
+int fun_UPTIME(int argc, char **argv)
 {
+    (void)argv;
+    if (argc > 1) {
+        ERROR_MESSAGE();
+        return 1;
+    }
+
     /* Open the /proc/uptime file */
     FILE *file = fopen("/proc/uptime", "r");
     if (!file) {
         perror("fopen"); /* Print an error if the file cannot be opened */
-        return;
+        return 1;
     }
 
     double uptime, idle;
@@ -215,7 +250,7 @@ void fun_UPTIME()
     if (fscanf(file, "%lf %lf", &uptime, &idle) != 2) {
         perror("fscanf"); /* Print an error if reading fails */
         fclose(file);
-        return;
+        return 1;
     }
     fclose(file); /* Close the file */
 
@@ -227,6 +262,7 @@ void fun_UPTIME()
     /* Print the uptime and idle time */
     printf("Uptime: %d days, %d hours, %d minutes\n", up_days, up_hours, up_minutes);
     printf("Idle time: %.2f seconds\n", idle);
+    return 0;
 }
 
 /*
@@ -234,13 +270,19 @@ void fun_UPTIME()
  * 1. Function to check the path /proc/meminfo and extract RAM info and Swap area info.
  * 2. Like Total memory, free, and used.
  */
-void fun_FREE()
+int fun_FREE(int argc, char **argv)
 {
+    (void)argv;
+    if (argc > 1) {
+        ERROR_MESSAGE();
+        return 1;
+    }
+
     /* Open the /proc/meminfo file */
     FILE *file = fopen("/proc/meminfo", "r");
     if (!file) {
         perror("fopen"); /* Print an error if the file cannot be opened */
-        return;
+        return 1;
     }
 
     char line[256];
@@ -269,132 +311,68 @@ void fun_FREE()
     printf("  Total:    %ld kB\n", info.swap_total);
     printf("  Used:     %ld kB\n", info.swap_total - info.swap_free);
     printf("  Free:     %ld kB\n", info.swap_free);
+    return 0;
 }
 
 /*
  * Description :
- * 1.Function to concatenate the string after \ with its space to be used in copy, move, and cd functions.
- */
-static void fun_PATH_CONCATENATE(char *PATH1)
-{
-    /* Get the next token to concatenate */
-    char *PATH2 = strtok(NULL, " ");
-
-    /* If no token is found, exit */
-    if (PATH2 == NULL) {
-        exit_from_fun_PATH_CHECKSPACES = 1;
-        return;
-    }
-
-    /* Check if the next token starts with '/', which is not allowed */
-    if (PATH2[0] == '/') {
-        exit_from_fun_PATH_CHECKSPACES = 1;
-        printf("File names ending with a backslash can't be moved or copied. Change the name and try again ^-^ \n");
-        return_variable = 1;
-        return;
-    }
-
-    int len1 = strlen(PATH1);
-    int len2 = strlen(PATH2);
-
-    /* Calculate the new length for concatenation */
-    size_t new_length = len1 + len2 + 2; // +1 for space, +1 for null terminator
-
-    /* Allocate memory for the new concatenated path */
-    char *new_path = (char *)malloc(new_length);
-    if (new_path == NULL) {
-        printf("Memory allocation failed.\n");
-        return;
-    }
-
-    /* Copy PATH1 to new_path, excluding the last '\' */
-    strncpy(new_path, PATH1, len1 - 1);
-    new_path[len1 - 1] = '\0';
-
-    /* Concatenate a space and PATH2 */
-    strcat(new_path, " ");
-    strcat(new_path, PATH2);
-
-    /* Update PATH1 with the new concatenated path */
-    strcpy(PATH1, new_path);
-
-    /* Free the allocated memory */
-    free(new_path);
-}
-
-/*
- * Description :
- * 1.Function to check if '\' is written.
+ * 1.Function to check if a command is internal; it returns true.
  */
-void fun_PATH_CHECKSPACES(char *PATH_SPACES)
+int is_internal_command(const char *command)
 {
-    /* Get the length of the input path */
-    int len1 = strlen(PATH_SPACES);
-    exit_from_fun_PATH_CHECKSPACES = 0;
-
-    /* If the last character is '\', concatenate the next token */
-    while ((PATH_SPACES[len1 - 1] == '\\') && (exit_from_fun_PATH_CHECKSPACES == 0)) {
-        fun_PATH_CONCATENATE(PATH_SPACES);
-        len1 = strlen(PATH_SPACES);
-    }
+    return find_internal_command(command) != NULL;
 }
 
 /*
  * Description :
- * 1.Function to check if a command is internal; it returns true.
+ * 1.Function to find the function of an internal command, it returns NULL if the command is not internal.
  */
-int is_internal_command(const char *command)
+internal_function find_internal_command(const char *command)
 {
-    int i = 0;
-
     /* Loop through the list of internal commands to check if the given command matches */
-    while (internal_commands[i] != NULL) {
-        if (strcmp(command, internal_commands[i]) == 0) {
-            return 1;
+    for (int i = 0; internal_commands[i].name != NULL; i++) {
+        if (strcmp(command, internal_commands[i].name) == 0) {
+            return internal_commands[i].function;
         }
-        i++;
     }
-    return 0; /* Return false if the command is not found in the list */
+    return NULL; /* The command is not found in the list */
 }
 
 /*
  * Description :
  * 1.Function to determine if the command is Internal, External, or Unsupported.
  */
-void fun_TYPE()
+int fun_TYPE(int argc, char **argv)
 {
-    /* Buffer to store the command to be checked */
-    char command_buffer[20];
-    int flag = 0;
-
     /* Extract the command to be checked from the input */
-    char *type_command = strtok(NULL, " ");
-    if (type_command == NULL) {
+    if (argc < 2) {
         printf("Error: Command is missing.\n");
-        return;
+        return 1;
     }
 
     /* Check if there is an additional argument after the command */
-    char *type_check = strtok(NULL, " ");
-    if (type_check != NULL) {
+    if (argc > 2) {
         printf("Command is an unsupported command.\n");
-        return;
+        return 1;
     }
 
     /* If the command starts with '/', it's considered unsupported */
+    const char *type_command = argv[1];
     if (type_command[0] == '/') {
         printf("Command is an unsupported command. Please provide the program name, not the path. \n");
-        return;
+        return 1;
     }
 
     /* Check if the command is internal, external, or unsupported */
     if (is_internal_command(type_command)) {
         printf("Command '%s' is an internal command.\n", type_command);
     } else if (is_external_command(type_command)) {
-        printf("Command '%s' is an external command.\n", type_command);
+        printf("Command '%s' is an external command (%s).\n", type_command, hash_lookup(type_command, HASH_CHECK));
     } else {
         printf("Command is an unsupported command.\n");
+        return 1;
     }
+    return 0;
 }
 
 /*
@@ -410,77 +388,117 @@ void fun_PWD()
     getcwd(pwd_PATH, PWD_BUFFER);
 }   
 
+/*
+ * Description :
+ * 1.Function to be called for the internal command mypwd.
+ */
+static int fun_MYPWD(int argc, char **argv)
+{
+    (void)argv;
+    if (argc > 1) {
+        ERROR_MESSAGE();
+        return 1;
+    }
+    fun_PWD(); /* Get the current working directory */
+    printf("%s \n", pwd_PATH); /* Print the path */
+    return 0;
+}
+
 /*
  * Description :
  * 1.Function to get help.
  */
-void fun_HELP()
+int fun_HELP(int argc, char **argv)
 {
+    (void)argv;
+    if (argc > 1) {
+        ERROR_MESSAGE();
+        return 1;
+    }
+
+
     /* Flush the output buffer to ensure all output is written */
     fflush(stdout);
     
     /* Print the list of supported commands */
     printf("Supported Commands: \n");
     printf(" 1) mypwd: to print the working directory \n 2) myecho: to print the text \n");
-    printf(" 3) mycp: to copy the files from path to another \n 4) mymv: to move the files from path to another \n 5) help: to get all the commands supported \n");
+    printf(" 3) mycp: to copy the files from path to another, mycp -r to copy directories \n 4) mymv: to move files or directories from path to another, or several of them into a directory \n 5) help: to get all the commands supported \n");
     printf(" 6) cd: to change the working directory\n 7) envir: to print All Enviroment variables \n");
     printf(" 8) envir variable: to print value of enviroment variable if exist \n 9) type: to find if the command is Internal external or not supported\n");
-    printf(" 10) phist: list the last 10 processes with their exit status \n 11) free: list Ram info and Swap Area info\n 12) uptime: it checks the uptime for the system and the time spent in IDLE.\n");
-    printf(" 13) set VAR_ENVIR=karim (between two quotes): assign envir variable, VAR_LOCAL=karim (between two quotes): assign local variable\n 14) allvars: Print All local and environment Variables, you can use allvars -l to print local variables only\n");
+    printf(" 10) phist [-s] [-v] [n]: list the last n processes (10 by default) with their exit status, wall and CPU time, -s: slowest first, -v: user and system time, max RSS, page faults and context switches \n 11) free: list Ram info and Swap Area info\n 12) uptime: it checks the uptime for the system and the time spent in IDLE.\n");
+    printf(" 13) set VAR_ENVIR=karim: assign envir variable, VAR_LOCAL=karim: assign local variable, use $VAR or ${VAR} to get the value\n 14) allvars: Print All local and environment Variables, you can use allvars -l to print local variables only\n");
     printf(" 15) Shell supports all external commands found in environment variable locations\n 16) exit: to terminate the program\n");
+    printf(" 17) hash: list the remembered paths of external commands, hash -r: forget them, hash name: remember a command\n");
+    printf(" 18) jobs: list the background and stopped jobs, fg %%n / bg %%n: continue a job in the foreground / background, wait [%%n | PID]: wait for jobs\n");
+    printf(" 19) parallel [-j N] command [args] ::: inputs...: run the command for every input, N at once, {} is replaced by the input\n");
+    printf(" 20) mycat [file...]: print files or the standard input, mygrep [-i] [-v] [-n] [-c] [-E] pattern [file...]: print the matching lines\n");
+    printf(" 21) history [n]: list the last n command lines, history -c: forget them, Up/Down: older/newer lines, Ctrl+R: search them\n");
+    printf(" 22) time pipeline: print the real, user and system time, max RSS, page faults and context switches of the pipeline\n");
+    printf("     accounting [on|off]: print the resources of every process when it finishes\n");
+    printf("Command lines: 'quotes', \"quotes\" and \\ escapes, cmd1 | cmd2 (internal commands too), cmd1 && cmd2, cmd1 || cmd2, cmd1 ; cmd2, cmd &, ( subshell ),\n");
+    printf("               redirections < file, > file, >> file, 2> file, 2>&1 on any command, $? is the status of the last command, $! the PID of the last background job\n");
+    return 0;
 }
 
 /*
  * Description :
  * 1.Function to print on the screen.
  */
-void fun_ECHO()
+int fun_ECHO(int argc, char **argv)
 {
-    /* Flush the output buffer to ensure all output is written */
-    fflush(stdout);
-    
-    /* Extract the text to echo from the command input */
-    char* echo_variable = strtok(NULL, " ");
-
-    /* Check if the echo text starts with a double quote */
-    if (echo_variable != NULL && echo_variable[0] == '"') {
-        echo_variable++;  /* Skip the initial double quote */
-
-        /* Loop through the remaining tokens to print them */
-        while (echo_variable != NULL) {
-            size_t len = strlen(echo_variable);
-
-            /* Check if the last character is a double quote and it's not the first character */
-            if (len > 0 && echo_variable[len - 1] == '"') {
-                echo_variable[len - 1] = '\0';  /* Remove the ending double quote */
-                printf("%s", echo_variable);    /* Print the final token without trailing space */
-                echo_variable = strtok(NULL, " ");
-
-                /* Print an error if there are extra tokens outside of quotes */
-                if (echo_variable != NULL) {
-                    printf("\nError in myecho: If you used quotes, make sure all the words are inside.\n");
-                    return;
-                }
-            } else {
-                /* Print the current token with a trailing space */
-                printf("%s ", echo_variable);
-            }
-
-            echo_variable = strtok(NULL, " ");
-        }
-    } else {
-        /* Print tokens if no double quotes are used */
-        while (echo_variable != NULL) {
-            printf("%s ", echo_variable);
-            echo_variable = strtok(NULL, " ");
-        }
+    /* The parser removed the quotes, print the arguments separated by one space */
+    for (int i = 1; i < argc; i++) {
+        printf((i < argc - 1) ? "%s " : "%s", argv[i]);
     }
 
     /* Print a newline after echoing the text */
     printf("\n");
-    
-    /* Flush the output buffer to ensure all output is written */
-    fflush(stdout);
+    return 0;
+}
+
+/*
+ * Description :
+ * 1.Function to stop the shell, with the given exit status or the status of the last command.
+ */
+int fun_EXIT(int argc, char **argv)
+{
+    int status = last_exit_status;
+    if (argc > 2) {
+        ERROR_MESSAGE();
+        return 1;
+    }
+    if (argc == 2) {
+        char *end;
+        status = (int)strtol(argv[1], &end, 10);
+        if (end == argv[1] || *end != '\0') {
+            printf("exit: %s: numeric argument required\n", argv[1]);
+            return 1;
+        }
+    }
+    printf(YELLOW "Hatw7shni y sa7by <_> \n5od balak 3la nfsk bye \n" RESET); /* Print farewell message */
+    exit_requested = 1;
+    return status & 0xFF;
+}
+
+/*
+ * Description :
+ * 1.Function to find the path a source gets inside a target directory, target/name of the source.
+ */
+static void fun_PATH_INSIDE_DIRECTORY(char *fullTargetPath, size_t size, const char *targetPath, const char *sourcePath)
+{
+    /* The name of "dir/" is "dir", ignore trailing slashes */
+    size_t sourceLength = strlen(sourcePath);
+    while (sourceLength > 1 && sourcePath[sourceLength - 1] == '/') {
+        sourceLength--;
+    }
+    const char *sourceFileName = sourcePath;
+    for (size_t i = 0; i < sourceLength; i++) {
+        if (sourcePath[i] == '/' && i + 1 < sourceLength) {
+            sourceFileName = sourcePath + i + 1;
+        }
+    }
+    snprintf(fullTargetPath, size, "%s/%.*s", targetPath, (int)(sourcePath + sourceLength - sourceFileName), sourceFileName);
 }
 
 /*
@@ -488,66 +506,64 @@ void fun_ECHO()
  * 1.Function to copy the Files from directory to another.
  * 2.It can deal with spaces and can write the name of the file if the file doesn't write it.
  * 3.It prints an error if the file exists.
+ * 4.mycp -r copies a directory with all its contents.
  */
-void fun_COPY()
+int fun_COPY(int argc, char **argv)
 {
-    /* Extract the source path from the command input */
-    char *sourcePath = strtok(NULL, " ");
+    int copy_flags = 0;
+    int arg = 1;
+
+    /* Check for the recursive option before the source path */
+    if (arg < argc && strcmp(argv[arg], "-r") == 0) {
+        copy_flags |= COPY_RECURSIVE;
+        arg++;
+    }
+
+    /* Extract the source path from the command input, spaces in names are quoted or escaped */
+    char *sourcePath = (arg < argc) ? argv[arg++] : NULL;
     
     /* Check if the source path is provided */
     if (sourcePath == NULL) {
         printf("Error: Source path is missing.\n");
-        return;
+        return 1;
     }
 
-    /* Check for spaces in the source path */
-    fun_PATH_CHECKSPACES(sourcePath);
-    
-    /* If there was an issue with spaces in the path, return */
-    if (return_variable) {
-        return_variable = 0; /* Reset the return variable */
-        return;
-    }
-
-    /* Open the source file for reading */
-    int fd_src = open(sourcePath, O_RDONLY);
-    
-    /* Check if the source file was successfully opened */
-    if (fd_src == -1) {
+    /* Check that the source exists and can be copied */
+    struct stat source_st;
+    if (stat(sourcePath, &source_st) == -1) {
         printf("Error opening source file \n"); 
-        return;
+        return 1;
+    }
+    if (S_ISDIR(source_st.st_mode) && !(copy_flags & COPY_RECURSIVE)) {
+        printf("Error: '%s' is a directory, use mycp -r to copy directories.\n", sourcePath);
+        return 1;
     }
 
     /* Extract the target path from the command input */
-    char *targetPath = strtok(NULL, " ");
+    char *targetPath = (arg < argc) ? argv[arg++] : NULL;
     
     /* Check if the target path is provided */
     if (targetPath == NULL) {
         printf("Error: Target path is missing.\n");
-        close(fd_src); /* Close the source file descriptor */
-        return;
+        return 1;
+    }
+    if (arg < argc) {
+        printf("Error: mycp copies one source, quote or escape names with spaces.\n");
+        return 1;
     }
-
-    /* Check for spaces in the target path */
-    fun_PATH_CHECKSPACES(targetPath);
 
     /* Checking if the target file exists or if the user provided a directory, 
      * and if so, name the file by its original name */
+    char fullTargetPath[PATH_MAX];
     struct stat st;
     if (stat(targetPath, &st) == 0 && S_ISDIR(st.st_mode)) {
-        /* The target path is a directory; construct the target file name */
-        char *sourceFileName = strrchr(sourcePath, '/');
-        sourceFileName = (sourceFileName == NULL) ? sourcePath : sourceFileName + 1;
-
-        /* Construct the full target path with the source file name */
-        char fullTargetPath[INPUT_BUFFER];
-        snprintf(fullTargetPath, sizeof(fullTargetPath), "%s/%s", targetPath, sourceFileName);
+        /* The target path is a directory; construct the full target path with the source file name */
+        fun_PATH_INSIDE_DIRECTORY(fullTargetPath, sizeof(fullTargetPath), targetPath, sourcePath);
 
         /* Check if the constructed target file already exists */
         if (access(fullTargetPath, F_OK) == 0) {
             printf("Error: Target file '%s' already exists.\n", fullTargetPath);
-            close(fd_src); /* Close the source file descriptor */
-            return;
+            return 1;
         }
 
         /* Set targetPath to the constructed full target path */
@@ -556,47 +572,25 @@ void fun_COPY()
         /* Check if the target file already exists */
         if (access(targetPath, F_OK) == 0) {
             printf("Error: Target file '%s' already exists.\n", targetPath);
-            close(fd_src); /* Close the source file descriptor */
-            return;
+            return 1;
         }
     }
 
-    /* Open the target file for writing, creating it if necessary, and truncating it if it exists */
-    int fd_dest = open(targetPath, O_WRONLY | O_CREAT | O_TRUNC, 0644); 
-    
-    /* Check if the target file was successfully opened */
-    if (fd_dest == -1) {
-        /* Flush the output buffer to ensure all output is written */
-        fflush(stdout);
-        
-        /* Print an error message if the target file couldn't be opened */
-        printf("Error in destination file, make sure you entered the full path correctly ^_^ \n"); 
-        return;
-    }
-
-    /* Buffer to hold data read from the source file */
-    char buff[READ_BUFFER];
-    int size = 0;
-
-    /* Copy the file content from the source to the destination */
-    while ((size = read(fd_src, buff, sizeof(buff))) > 0) {
-        if (write(fd_dest, buff, size) != size) {
-            printf("Error writing to destination file \n");
-            close(fd_src); /* Close the source file descriptor */
-            close(fd_dest); /* Close the destination file descriptor */
-            return;
-        }
+    /* Copy the contents with the fastest way the file systems support, see file_copy.c */
+    fflush(stdout);
+    if (copy_path(sourcePath, targetPath, copy_flags) == -1) {
+        /* copy_path printed what failed */
+        printf("Error: Copy is not complete, make sure you entered the full path correctly ^_^ \n"); 
+        return 1;
     }
 
-    /* Close the file descriptors after copying */
-    close(fd_src);
-    close(fd_dest);
-
-    /* Flush the output buffer to ensure all output is written */
-    fflush(stdout);
-    
     /* Print a success message after the file is successfully copied */
-    printf("File Copied successfully ^-^ \n");
+    if (S_ISDIR(source_st.st_mode)) {
+        printf("Directory Copied successfully ^-^ \n");
+    } else {
+        printf("File Copied successfully ^-^ \n");
+    }
+    return 0;
 }
 
 /*
@@ -604,123 +598,77 @@ void fun_COPY()
  * 1.Function to move the Files from directory to another
  * 2.it can deal with spaces and can write the name of the file if the file doesn't write it
  * 3.it prints error if the file exist.
+ * 4.It moves directories too, and several sources into one directory: mymv source1 source2 directory.
  */
-void fun_MOVE()
+int fun_MOVE(int argc, char **argv)
 {
-    /* Extract the source path from the command input */
-    char *sourcePath = strtok(NULL, " ");
-    
+    /* All paths after the command name, the last one is the target */
+    char **paths = argv + 1;
+    int num_paths = argc - 1;
+
     /* Check if the source path is provided */
-    if (sourcePath == NULL) {
+    if (num_paths == 0) {
         /* Print an error message if the source path is missing */
         printf("Error: Source path is missing.\n");
-        return;
+        return 1;
     }
 
-    /* Check for spaces in the source path */
-    fun_PATH_CHECKSPACES(sourcePath);
-    
-    /* If there was an issue with spaces in the path, return */
-    if (return_variable) {
-        return_variable = 0; /* Reset the return variable */
-        return;
-    }
-
-    /* Open the source file for reading */
-    int fd_src = open(sourcePath, O_RDONLY);
-    
-    /* Check if the source file was successfully opened */
-    if (fd_src == -1) {
-        /* Print an error message if the source file couldn't be opened */
-        printf("Error opening source file \n");
-        return;
-    }
-
-    /* Extract the target path from the command input */
-    char *targetPath = strtok(NULL, " ");
-    
     /* Check if the target path is provided */
-    if (targetPath == NULL) {
+    if (num_paths == 1) {
         /* Print an error message if the target path is missing */
         printf("Error: Target path is missing.\n");
-        close(fd_src); /* Close the source file descriptor */
-        return;
+        return 1;
     }
 
-    /* Check for spaces in the target path */
-    fun_PATH_CHECKSPACES(targetPath);
-
-    /* Check if the target file exists or if the user provided a directory, 
-     * and if so, name the file by its original name */
+    char *targetPath = paths[num_paths - 1];
+    int num_sources = num_paths - 1;
     struct stat st;
-    if (stat(targetPath, &st) == 0 && S_ISDIR(st.st_mode)) {
-        /* The target path is a directory; construct the target file name */
-        char *sourceFileName = strrchr(sourcePath, '/');
-        sourceFileName = (sourceFileName == NULL) ? sourcePath : sourceFileName + 1;
+    int targetIsDirectory = (stat(targetPath, &st) == 0 && S_ISDIR(st.st_mode));
+    if (num_sources > 1 && !targetIsDirectory) {
+        printf("Error: Target '%s' must be a directory when moving more than one source.\n", targetPath);
+        return 1;
+    }
 
-        /* Construct the full target path with the source file name */
-        char fullTargetPath[INPUT_BUFFER];
-        snprintf(fullTargetPath, sizeof(fullTargetPath), "%s/%s", targetPath, sourceFileName);
+    int moved = 0;
+    for (int i = 0; i < num_sources; i++) {
+        char *sourcePath = paths[i];
 
-        /* Check if the constructed target file already exists */
-        if (access(fullTargetPath, F_OK) == 0) {
-            /* Print an error message if the target file already exists */
-            printf("Error: Target file '%s' already exists.\n", fullTargetPath);
-            close(fd_src); /* Close the source file descriptor */
-            return;
+        /* Check if the source exists, a link is moved itself and not what it points to */
+        if (lstat(sourcePath, &st) == -1) {
+            /* Print an error message if the source file couldn't be found */
+            printf("Error opening source file '%s' \n", sourcePath);
+            continue;
+        }
+
+        /* If the user provided a directory, the source keeps its name inside it */
+        char fullTargetPath[PATH_MAX];
+        if (targetIsDirectory) {
+            fun_PATH_INSIDE_DIRECTORY(fullTargetPath, sizeof(fullTargetPath), targetPath, sourcePath);
+        } else {
+            snprintf(fullTargetPath, sizeof(fullTargetPath), "%s", targetPath);
         }
 
-        /* Set targetPath to the constructed full target path */
-        targetPath = fullTargetPath;
-    } else {
         /* Check if the target file already exists */
-        if (access(targetPath, F_OK) == 0) {
+        if (lstat(fullTargetPath, &st) == 0) {
             /* Print an error message if the target file already exists */
-            printf("Error: Target file '%s' already exists.\n", targetPath);
-            close(fd_src); /* Close the source file descriptor */
-            return;
+            printf("Error: Target file '%s' already exists.\n", fullTargetPath);
+            continue;
         }
-    }
 
-    /* Open the target file for writing, creating it if necessary, and truncating it if it exists */
-    int fd_dest = open(targetPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
-    
-    /* Check if the target file was successfully opened */
-    if (fd_dest == -1) {
-        /* Print an error message if the target file couldn't be opened */
-        printf("Error opening destination file\n ");
-        close(fd_src); /* Close the source file descriptor */
-        return;
-    }
-
-    /* Buffer to hold data read from the source file */
-    char buff[READ_BUFFER];
-    int size;
-
-    /* Copy the file content from the source to the destination */
-    while ((size = read(fd_src, buff, sizeof(buff))) > 0) {
-        /* Write the data to the destination file */
-        if (write(fd_dest, buff, size) != size) {
-            /* Print an error message if writing to the destination file failed */
-            printf("Error writing to destination file \n");
-            close(fd_src); /* Close the source file descriptor */
-            close(fd_dest); /* Close the destination file descriptor */
-            return;
+        /* rename on the same file system, copy and remove across file systems, see file_copy.c */
+        fflush(stdout);
+        if (move_path(sourcePath, fullTargetPath) == 0) {
+            moved++;
         }
     }
 
-    /* Close the file descriptors after copying */
-    close(fd_src);
-    close(fd_dest);
-
-    /* Remove the source file after copying */
-    if (remove(sourcePath) != 0) {
-        /* Print an error message if deleting the source file failed */
-        printf("Error deleting source file \n");
-    } else {
+    if (num_sources == 1 && moved == 1) {
         /* Print a success message after the file is successfully moved */
         printf("File moved successfully.\n");
+    } else if (num_sources > 1) {
+        printf("%d of %d files moved successfully.\n", moved, num_sources);
     }
+    return (moved == num_sources) ? 0 : 1;
 }
 
 /* 
@@ -728,31 +676,33 @@ void fun_MOVE()
  * 1. Function to Change Directory.
  * 2. It supports spaces in directories.
  */
-void fun_CD()
+int fun_CD(int argc, char **argv)
 {
-    /* Extract the path to change to from the command input */
-    char *changePath = strtok(NULL, " ");
-    
     /* Check if the change path is provided */
-    if (changePath == NULL) {
+    if (argc < 2) {
         /* Print an error message if the change path is missing */
         printf("Error: Change path is missing.\n");
-        return;
+        return 1;
     }
-
-    /* Check for spaces in the change path */
-    fun_PATH_CHECKSPACES(changePath);
+    if (argc > 2) {
+        printf("Error: cd takes one path, quote or escape names with spaces.\n");
+        return 1;
+    }
+    const char *changePath = argv[1];
 
     /* Attempt to change the directory */
     int status = chdir(changePath);
     
     /* Check if the directory change was successful */
     if (status == 0) {
+        pwd_changed = 1; /* The prompt shows the new directory */
         /* Print a success message */
         printf("Directory Changed ^_^ \n");
     } else {
         /* Print an error message if the directory change failed */
         perror("Error Changing Directory because ");
         printf("\n");
+        return 1;
     }
+    return 0;
 }
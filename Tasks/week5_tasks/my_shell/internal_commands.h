@@ -11,14 +11,13 @@
 #ifndef INTERNAL_COMMANDS_H
 #define INTERNAL_COMMANDS_H
 
+#include <stddef.h>
+
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
 
-#define INPUT_BUFFER        (100)
 #define PWD_BUFFER          (100)   /*Used by pwd_PATH*/
-#define READ_BUFFER         (1024)  /*Used in fun_COPY and fun_MOVE*/
-#define MAX_LOCAL_VARIABLES (100)
 #define ENVIROMENT_VARIABLE (1)
 #define LOCAL_VARIABLE      (0)
 
@@ -29,16 +28,21 @@ typedef struct {
     long swap_free;
 } MemoryInfo;
 
+/* Function of an internal command, it gets the words of the command like main and returns the exit status */
+typedef int (*internal_function)(int argc, char **argv);
+
+/* Struct to save an internal command name and the function that runs it */
 typedef struct {
-    char *name;
-    char *value;
-} local_variable;
+    const char *name;
+    internal_function function;
+} internal_command;
 
 /*******************************************************************************
  *                           Extern Global Variable                            *
  *******************************************************************************/
 
 extern char pwd_PATH[PWD_BUFFER]; /*Array of characters that store tha paths of the pwd*/
+extern char pwd_changed; /*Set by cd, the prompt is built again only when the directory changed*/
 
 /*******************************************************************************
  *                             Functions Prototypes                            *
@@ -46,56 +50,75 @@ extern char pwd_PATH[PWD_BUFFER]; /*Array of characters that store tha paths of
 
 /*
  * Description :
- * 1.Function to Add local or enviroment variable to the shell.
+ * 1.Function to Add local or enviroment variable to the shell from an assignment name=value.
+ */
+int fun_PLACE_VARIABLE(const char *assignment, char VARIABLE_MODE);
+
+/*
+ * Description :
+ * 1.Function to add an enviroment variable: set name=value.
+ */
+int fun_SET(int argc, char **argv);
+
+/*
+ * Description :
+ * 1.Function to check if the first length characters of name are a valid variable name.
+ */
+int is_variable_name(const char *name, size_t length);
+
+/*
+ * Description :
+ * 1.Function to get the value of a local or enviroment variable named by the first length characters of name,
+ *   NULL if it doesn't exist.
  */
-void fun_PLACE_VARIABLE(char *input_string_main_copy,char *equal_sign,char VARIABLE_MODE);
+const char *get_variable(const char *name, size_t length);
 
 /*
  * Description :
  * 1.Function to print env variables.
  */
-void fun_ENVIR(char *token);
+int fun_ENVIR(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to print all local and enviroment variables.
  */
-void fun_ALLVARS(char *which_variables);
+int fun_ALLVARS(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to check the path /proc/uptime and print the uptime for the system and the total time spend in IDLE.
  */
-void fun_UPTIME();
+int fun_UPTIME(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to check the path /proc/meminfo and extract Ram info and Swap area info
  * 2.Like Total meomory,free and used.
  */
-void fun_FREE();
+int fun_FREE(int argc, char **argv);
 
 /*
  * Description :
- * 1.Function to check if \ is written.
+ * 1.Function to check if a command is internal it returns true
  */
-void fun_PATH_CHECKSPACES(char *PATH_SPACES);
+int is_internal_command(const char *command);
 
 /*
  * Description :
- * 1.Function to check if a command is internal it returns true
+ * 1.Function to find the function of an internal command, it returns NULL if the command is not internal.
  */
-int is_internal_command(const char *command);
+internal_function find_internal_command(const char *command);
 
 /*
  * Description :
  * 1.Function to find it the command is Internal,external or not supported.
  */
-void fun_TYPE();
+int fun_TYPE(int argc, char **argv);
 
 /*
  * Description :
- * 1.Function to print the working directory path.
+ * 1.Function to update pwd_PATH with the working directory path.
  */
 void fun_PWD() ;
 
@@ -103,35 +126,42 @@ void fun_PWD() ;
  * Description :
  * 1.function to get help.
  */
-void fun_HELP();
+int fun_HELP(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to print on the screen.
  */
-void fun_ECHO();
+int fun_ECHO(int argc, char **argv);
+
+/*
+ * Description :
+ * 1.Function to stop the shell: exit, or exit status.
+ */
+int fun_EXIT(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to copy the Files from directory to another
- * 2.it can deal with spaces and can write the name of the file if the file doesn't write it
+ * 2.it can write the name of the file if the file doesn't write it
  * 3.it prints error if the file exist.
+ * 4.mycp -r copies a directory with all its contents.
  */
-void fun_COPY();
+int fun_COPY(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to move the Files from directory to another
- * 2.it can deal with spaces and can write the name of the file if the file doesn't write it
+ * 2.it can write the name of the file if the file doesn't write it
  * 3.it prints error if the file exist.
+ * 4.it moves directories too, and several sources into one directory: mymv source1 source2 directory.
  */
-void fun_MOVE();
+int fun_MOVE(int argc, char **argv);
 
 /*
  * Description :
  * 1.Function to Change Directory*.
- * 2.It supports spaces in directories.
  */
-void fun_CD();
+int fun_CD(int argc, char **argv);
 
 #endif // INTERNAL_COMMANDS_H
\ No newline at end of file
@@ -0,0 +1,933 @@
+ /******************************************************************************
+ *
+ * File Name: jobs.c
+ *
+ * Description: Source file for the job table: foreground and background jobs with their process groups,
+ *              the SIGCHLD reaper, the internal commands jobs, fg, bg, wait and phist
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "jobs.h"
+#include "launcher.h"  /* For launch_status */
+
+pid_t last_background_pid = 0; /* $! */
+
+static shell_job *job_table = NULL; /* Jobs ordered by number, the last one is the current job %+ */
+static char job_control = 0; /* Jobs get their own process groups and the terminal */
+static const int shell_terminal = 0; /* The standard input of an interactive shell */
+static pid_t shell_pgid; /* Process group of the shell, it takes the terminal back after a job */
+static struct termios shell_tmodes; /* Terminal settings of the prompt */
+static volatile sig_atomic_t children_changed = 0; /* Set by SIGCHLD, a child finished, stopped or continued */
+
+static ProcessInfo process_history[MAX_HISTORY]; /* Ring of the last finished processes, the oldest is overwritten */
+static int history_start = 0; /* Index of the oldest process in process_history */
+static int process_count = 0; /* Counter for the number of processes in the history */
+static struct rusage children_usage; /* Sums of all finished children, ru_maxrss is the largest of them, for time */
+static char accounting = 0; /* Print the resources of every process when it finishes */
+
+/*
+ * Description :
+ * 1. Function called on SIGCHLD, it only sets a flag because almost nothing is safe inside a signal handler.
+ */
+static void sigchld_handler(int signal_number)
+{
+    (void)signal_number;
+    children_changed = 1;
+}
+
+/*
+ * Description :
+ * 1. Function to get the seconds between two times.
+ */
+static double seconds_between(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) + (end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * Description :
+ * 1. Function to get the seconds of a time from getrusage or wait4.
+ */
+double timeval_seconds(const struct timeval *time)
+{
+    return time->tv_sec + time->tv_usec / 1e6;
+}
+
+/*
+ * Description :
+ * 1. Function to add the counters of a usage to a total, or take them away with sign -1. ru_maxrss is left as it is.
+ */
+static void add_usage(struct rusage *total, const struct rusage *usage, int sign)
+{
+    long user = (total->ru_utime.tv_sec + sign * usage->ru_utime.tv_sec) * 1000000L + total->ru_utime.tv_usec + sign * usage->ru_utime.tv_usec;
+    long system = (total->ru_stime.tv_sec + sign * usage->ru_stime.tv_sec) * 1000000L + total->ru_stime.tv_usec + sign * usage->ru_stime.tv_usec;
+    total->ru_utime.tv_sec = user / 1000000L;
+    total->ru_utime.tv_usec = user % 1000000L;
+    total->ru_stime.tv_sec = system / 1000000L;
+    total->ru_stime.tv_usec = system % 1000000L;
+    total->ru_minflt += sign * usage->ru_minflt;
+    total->ru_majflt += sign * usage->ru_majflt;
+    total->ru_nvcsw += sign * usage->ru_nvcsw;
+    total->ru_nivcsw += sign * usage->ru_nivcsw;
+}
+
+/*
+ * Description :
+ * 1. Function to print the max RSS, the page faults and the context switches of a usage, without a new line.
+ */
+void print_resources(FILE *stream, const struct rusage *usage)
+{
+    fprintf(stream, "max RSS %ld KB, page faults %ld minor %ld major, context switches %ld voluntary %ld involuntary",
+            usage->ru_maxrss, usage->ru_minflt, usage->ru_majflt, usage->ru_nvcsw, usage->ru_nivcsw);
+}
+
+/*
+ * Description :
+ * 1. Function to add a finished process to phist, overwriting the oldest one when the ring is full.
+ */
+static void add_process(int pid, int exit_status, const char *process_name, double wall_seconds, const struct rusage *usage)
+{
+    /* The history shows the program name without its directory */
+    const char *last_slash = strrchr(process_name, '/');
+    if (last_slash != NULL) {
+        process_name = last_slash + 1;
+    }
+
+    int index = (history_start + process_count) % MAX_HISTORY;
+    if (process_count < MAX_HISTORY) {
+        process_count++; /* Increment the process count */
+    } else {
+        history_start = (history_start + 1) % MAX_HISTORY; /* The oldest entry is replaced */
+    }
+    process_history[index].pid = pid; /* Store the process ID */
+    process_history[index].exit_status = exit_status; /* Store the exit status */
+    strncpy(process_history[index].process_name, process_name, MAX_PROCESS_NAME - 1); /* Store the process name */
+    process_history[index].process_name[MAX_PROCESS_NAME - 1] = '\0'; /* Ensure null-termination */
+    process_history[index].wall_seconds = wall_seconds;
+    process_history[index].cpu_seconds = timeval_seconds(&usage->ru_utime) + timeval_seconds(&usage->ru_stime);
+    process_history[index].usage = *usage;
+
+    if (accounting) {
+        fprintf(stderr, "accounting: %s (PID %d) exit %d, real %.3fs, user %.3fs, sys %.3fs, ", process_name, pid,
+                exit_status, wall_seconds, timeval_seconds(&usage->ru_utime), timeval_seconds(&usage->ru_stime));
+        print_resources(stderr, usage);
+        fputc('\n', stderr);
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to prepare job control: an interactive shell puts itself in its own process group, takes the terminal
+ *    and ignores the stop signals, every job then gets its own process group.
+ * 2. It also installs the SIGCHLD handler which tells the shell that jobs changed.
+ */
+void jobs_init(char interactive)
+{
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = sigchld_handler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART; /* read and wait4 continue after the handler */
+    sigaction(SIGCHLD, &action, NULL);
+
+    if (!interactive) {
+        return; /* Scripts run their jobs in the shell's process group like other shells */
+    }
+
+    /* Wait until the shell is in the foreground, a shell started with & must not take the terminal */
+    while (tcgetpgrp(shell_terminal) != (shell_pgid = getpgrp())) {
+        kill(-shell_pgid, SIGTTIN);
+    }
+
+    /* Ctrl+Z stops the foreground job, not the shell, and the shell may give the terminal away and back */
+    signal(SIGTSTP, SIG_IGN);
+    signal(SIGTTIN, SIG_IGN);
+    signal(SIGTTOU, SIG_IGN);
+
+    shell_pgid = getpid();
+    if (getpgrp() != shell_pgid && setpgid(0, shell_pgid) == -1) {
+        perror("Job control is off, setpgid");
+        return;
+    }
+    tcsetpgrp(shell_terminal, shell_pgid);
+    tcgetattr(shell_terminal, &shell_tmodes);
+    job_control = 1;
+}
+
+/*
+ * Description :
+ * 1. Function to know if jobs get their own process groups and the terminal, only in an interactive shell.
+ */
+char job_control_active(void)
+{
+    return job_control;
+}
+
+/*
+ * Description :
+ * 1. Function for a forked copy of the shell: it joins the process group pgid (0 for a new one),
+ *    takes the default signals back and forgets the jobs of the shell, they are not its children.
+ */
+void jobs_enter_child(pid_t pgid)
+{
+    if (job_control && pgid != JOB_NO_PGROUP) {
+        setpgid(0, pgid);
+    }
+    signal(SIGTSTP, SIG_DFL);
+    signal(SIGTTIN, SIG_DFL);
+    signal(SIGTTOU, SIG_DFL);
+    job_control = 0; /* The commands of the copy stay in its process group */
+    job_table = NULL; /* Not freed, the copy exits soon and never touches them */
+}
+
+/*
+ * Description :
+ * 1. Function to create a job, it is added to the job table.
+ */
+shell_job *job_create(const char *command, char background)
+{
+    shell_job *job = calloc(1, sizeof(shell_job));
+    if (job == NULL) {
+        return NULL;
+    }
+    job->command = strdup(command);
+    if (job->command == NULL) {
+        free(job);
+        return NULL;
+    }
+    job->background = background;
+    job->notified_state = PROCESS_RUNNING;
+
+    /* The new job gets the number after the highest one in use */
+    shell_job **link = &job_table;
+    job->id = 1;
+    while (*link != NULL) {
+        job->id = (*link)->id + 1;
+        link = &(*link)->next;
+    }
+    *link = job;
+    return job;
+}
+
+/*
+ * Description :
+ * 1. Function to create a job named by the words of a command joined by spaces.
+ */
+shell_job *job_create_words(char *const argv[], char background)
+{
+    size_t length = 1;
+    for (int i = 0; argv[i] != NULL; i++) {
+        length += strlen(argv[i]) + 1;
+    }
+    char *command = malloc(length);
+    if (command == NULL) {
+        return NULL;
+    }
+
+    char *end = command;
+    *end = '\0';
+    for (int i = 0; argv[i] != NULL; i++) {
+        end = stpcpy(end, argv[i]);
+        if (argv[i + 1] != NULL) {
+            end = stpcpy(end, " ");
+        }
+    }
+
+    shell_job *job = job_create(command, background);
+    free(command);
+    return job;
+}
+
+/*
+ * Description :
+ * 1. Function to remove a job from the job table and free it.
+ */
+static void job_remove(shell_job *job)
+{
+    for (shell_job **link = &job_table; *link != NULL; link = &(*link)->next) {
+        if (*link == job) {
+            *link = job->next;
+            break;
+        }
+    }
+    for (int i = 0; i < job->num_processes; i++) {
+        free(job->processes[i].name);
+    }
+    free(job->processes);
+    free(job->command);
+    free(job);
+}
+
+/*
+ * Description :
+ * 1. Function to get the process group a new process of the job must join: 0 for a new group,
+ *    the group of the first process, or JOB_NO_PGROUP when job control is off.
+ */
+pid_t job_spawn_pgid(const shell_job *job)
+{
+    return job_control ? job->pgid : JOB_NO_PGROUP;
+}
+
+/*
+ * Description :
+ * 1. Function to add a started process to a job, or a stage that couldn't start with pid -1 and its status.
+ */
+int job_add_process(shell_job *job, pid_t pid, const char *name, int status)
+{
+    if (job->num_processes == job->capacity) {
+        int capacity = job->capacity ? job->capacity * 2 : 4;
+        job_process *grown = realloc(job->processes, capacity * sizeof(job_process));
+        if (grown == NULL) {
+            return -1;
+        }
+        job->processes = grown;
+        job->capacity = capacity;
+    }
+
+    job_process *process = &job->processes[job->num_processes++];
+    process->pid = pid;
+    process->name = (name != NULL) ? strdup(name) : NULL;
+    process->state = (pid == -1) ? PROCESS_DONE : PROCESS_RUNNING;
+    process->status = status;
+    clock_gettime(CLOCK_MONOTONIC, &process->started);
+
+    if (pid != -1) {
+        /* Also set the group here, a forked copy may not have done it yet when the terminal is given to the job */
+        if (job_control) {
+            setpgid(pid, job->pgid ? job->pgid : pid);
+        }
+        if (job->pgid == 0) {
+            job->pgid = pid;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to find the state of a job: running if one process runs, stopped if one is stopped, else done.
+ */
+static char job_state(const shell_job *job)
+{
+    char state = PROCESS_DONE;
+    for (int i = 0; i < job->num_processes; i++) {
+        if (job->processes[i].state == PROCESS_RUNNING) {
+            return PROCESS_RUNNING;
+        }
+        if (job->processes[i].state == PROCESS_STOPPED) {
+            state = PROCESS_STOPPED;
+        }
+    }
+    return state;
+}
+
+/*
+ * Description :
+ * 1. Function to get the exit status of a job, the status of its last process like other shells.
+ */
+static int job_status(const shell_job *job)
+{
+    return (job->num_processes > 0) ? job->processes[job->num_processes - 1].status : 0;
+}
+
+/*
+ * Description :
+ * 1. Function to save what wait4 reported for a child in the process of its job.
+ * 2. A finished process is added to phist with its times, usage is what the kernel counted for it.
+ */
+static void update_process(pid_t pid, int status, const struct rusage *usage)
+{
+    if (!WIFSTOPPED(status) && !WIFCONTINUED(status)) {
+        add_usage(&children_usage, usage, 1);
+        if (usage->ru_maxrss > children_usage.ru_maxrss) {
+            children_usage.ru_maxrss = usage->ru_maxrss;
+        }
+    }
+
+    for (shell_job *job = job_table; job != NULL; job = job->next) {
+        for (int i = 0; i < job->num_processes; i++) {
+            job_process *process = &job->processes[i];
+            if (process->pid != pid) {
+                continue;
+            }
+            if (WIFSTOPPED(status)) {
+                process->state = PROCESS_STOPPED;
+            } else if (WIFCONTINUED(status)) {
+                process->state = PROCESS_RUNNING;
+            } else {
+                process->state = PROCESS_DONE;
+                process->status = launch_status(status);
+                if (process->name != NULL) {
+                    struct timespec now;
+                    clock_gettime(CLOCK_MONOTONIC, &now);
+                    add_process(pid, process->status, process->name, seconds_between(&process->started, &now), usage);
+                }
+            }
+            return;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to send a signal to all processes of a job.
+ */
+static void job_signal(shell_job *job, int signal_number)
+{
+    if (job_control && job->pgid > 0) {
+        kill(-job->pgid, signal_number);
+        return;
+    }
+    for (int i = 0; i < job->num_processes; i++) {
+        if (job->processes[i].pid > 0 && job->processes[i].state != PROCESS_DONE) {
+            kill(job->processes[i].pid, signal_number);
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to continue a job if some of its processes are stopped.
+ */
+static void job_continue(shell_job *job)
+{
+    char stopped = 0;
+    for (int i = 0; i < job->num_processes; i++) {
+        if (job->processes[i].state == PROCESS_STOPPED) {
+            job->processes[i].state = PROCESS_RUNNING;
+            stopped = 1;
+        }
+    }
+    if (stopped) {
+        job_signal(job, SIGCONT);
+    }
+    job->notified_state = PROCESS_RUNNING;
+}
+
+/*
+ * Description :
+ * 1. Function to give the terminal to a job, so Ctrl+C and Ctrl+Z are sent to its processes and not to the shell.
+ * 2. It returns 1 if the terminal was given and must be taken back with job_release_terminal.
+ */
+char job_take_terminal(shell_job *job)
+{
+    if (!job_control || job->pgid <= 0) {
+        return 0;
+    }
+    if (job->has_tmodes) {
+        tcsetattr(shell_terminal, TCSADRAIN, &job->tmodes);
+    }
+    tcsetpgrp(shell_terminal, job->pgid);
+    return 1;
+}
+
+/*
+ * Description :
+ * 1. Function to take the terminal back from a job, saving its terminal settings if it was stopped.
+ */
+void job_release_terminal(shell_job *job)
+{
+    tcsetpgrp(shell_terminal, shell_pgid);
+    if (job_state(job) == PROCESS_STOPPED) {
+        tcgetattr(shell_terminal, &job->tmodes);
+        job->has_tmodes = 1;
+    }
+    tcsetattr(shell_terminal, TCSADRAIN, &shell_tmodes);
+}
+
+/*
+ * Description :
+ * 1. Function to wait for one change of any child and save it in its job.
+ * 2. It returns -1 when the shell has no children left.
+ */
+static int wait_any_child(void)
+{
+    while (1) {
+        int status;
+        struct rusage usage;
+        pid_t pid = wait4(-1, &status, WUNTRACED, &usage);
+        if (pid != -1) {
+            update_process(pid, status, &usage); /* Children of other jobs are saved in their own jobs */
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to mark the running processes of a job done, when there are no children left to change them.
+ */
+static void job_lost(shell_job *job)
+{
+    for (int i = 0; i < job->num_processes; i++) {
+        if (job->processes[i].state == PROCESS_RUNNING) {
+            job->processes[i].state = PROCESS_DONE;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to wait until all processes of a job finished or it was stopped with Ctrl+Z.
+ * 2. A foreground job gets the terminal while it runs.
+ * 3. It returns the status of the last process, 128 + SIGTSTP if it was stopped. A finished job is removed.
+ */
+int job_wait(shell_job *job, char foreground)
+{
+    char use_terminal = foreground && job_take_terminal(job);
+
+    while (job_state(job) == PROCESS_RUNNING) {
+        if (wait_any_child() == -1) {
+            job_lost(job);
+            break;
+        }
+    }
+
+    if (use_terminal) {
+        job_release_terminal(job);
+    }
+
+    if (job_state(job) == PROCESS_STOPPED) {
+        if (foreground) {
+            job->background = 1;
+            job->notified_state = PROCESS_STOPPED;
+            printf("\n[%d]+  %-24s%s\n", job->id, "Stopped", job->command);
+        }
+        return STATUS_SIGNALED + SIGTSTP;
+    }
+
+    int status = job_status(job);
+    job_remove(job);
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function for internal commands that run many processes themselves and can't be stopped:
+ *    it collects the changed children and continues the processes of the job stopped with Ctrl+Z.
+ */
+void job_keep_running(shell_job *job)
+{
+    jobs_reap();
+    job_continue(job); /* The whole group, the children of the commands were stopped too */
+}
+
+/*
+ * Description :
+ * 1. Function to wait until one process of a job finished, the other processes keep running.
+ * 2. A process stopped with Ctrl+Z is continued, see job_keep_running.
+ * 3. It returns the status of the process.
+ */
+int job_wait_process(shell_job *job, pid_t pid)
+{
+    int index = 0;
+    while (index < job->num_processes && job->processes[index].pid != pid) {
+        index++;
+    }
+    if (index == job->num_processes) {
+        return 0;
+    }
+
+    while (job->processes[index].state != PROCESS_DONE) {
+        if (job->processes[index].state == PROCESS_STOPPED) {
+            job_keep_running(job);
+        }
+        if (job->processes[index].state == PROCESS_RUNNING && wait_any_child() == -1) {
+            job_lost(job);
+        }
+    }
+    return job->processes[index].status;
+}
+
+/*
+ * Description :
+ * 1. Function to leave a job running in the background, the interactive shell prints its number and PID.
+ */
+void job_background(shell_job *job)
+{
+    pid_t last_pid = -1;
+    for (int i = 0; i < job->num_processes; i++) {
+        if (job->processes[i].pid > 0) {
+            last_pid = job->processes[i].pid;
+        }
+    }
+    if (last_pid == -1) {
+        job_remove(job); /* Nothing started, the errors were printed */
+        return;
+    }
+
+    job->background = 1;
+    last_background_pid = last_pid;
+    if (job_control) {
+        printf("[%d] %d\n", job->id, last_pid);
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to collect the children that finished or stopped since the last call, without blocking.
+ * 2. The SIGCHLD handler only sets a flag, the real work is done here outside of the handler.
+ */
+void jobs_reap(void)
+{
+    if (!children_changed) {
+        return;
+    }
+    children_changed = 0; /* Cleared first, a child finishing during the loop sets it again */
+
+    int status;
+    struct rusage usage;
+    pid_t pid;
+    while ((pid = wait4(-1, &status, WNOHANG | WUNTRACED | WCONTINUED, &usage)) > 0) {
+        update_process(pid, status, &usage);
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to write the state of a job like jobs prints it.
+ */
+static void print_job(const shell_job *job, char marker)
+{
+    char state_text[32];
+    char state = job_state(job);
+    if (state == PROCESS_RUNNING) {
+        snprintf(state_text, sizeof(state_text), "Running");
+    } else if (state == PROCESS_STOPPED) {
+        snprintf(state_text, sizeof(state_text), "Stopped");
+    } else if (job_status(job) == 0) {
+        snprintf(state_text, sizeof(state_text), "Done");
+    } else {
+        snprintf(state_text, sizeof(state_text), "Exit %d", job_status(job));
+    }
+    printf("[%d]%c  %-24s%s%s\n", job->id, marker, state_text, job->command, (state == PROCESS_RUNNING) ? " &" : "");
+}
+
+/*
+ * Description :
+ * 1. Function to find the marker of a job: + for the current job, - for the one before.
+ */
+static char job_marker(const shell_job *job)
+{
+    if (job->next == NULL) {
+        return '+';
+    }
+    return (job->next->next == NULL) ? '-' : ' ';
+}
+
+/*
+ * Description :
+ * 1. Function to tell the user which background jobs finished or stopped, called before the prompt.
+ */
+void jobs_notify(char interactive)
+{
+    jobs_reap();
+
+    shell_job *job = job_table;
+    while (job != NULL) {
+        shell_job *next = job->next;
+        char state = job_state(job);
+        if (state == PROCESS_DONE && interactive) {
+            print_job(job, job_marker(job));
+            job_remove(job); /* A script keeps finished jobs for wait */
+        } else if (state != job->notified_state) {
+            if (interactive) {
+                print_job(job, job_marker(job));
+            }
+            job->notified_state = state;
+        }
+        job = next;
+    }
+    fflush(stdout);
+}
+
+/*
+ * Description :
+ * 1. Function to find the job of %n, %+, %% or %-, or the current job if spec is NULL.
+ * 2. For wait a plain number is a PID, for fg and bg it is a job number.
+ */
+static shell_job *find_job(const char *spec, char number_is_pid)
+{
+    shell_job *last = NULL;
+    shell_job *before_last = NULL;
+    for (shell_job *job = job_table; job != NULL; job = job->next) {
+        before_last = last;
+        last = job;
+    }
+
+    if (spec == NULL || strcmp(spec, "%+") == 0 || strcmp(spec, "%%") == 0) {
+        return last;
+    }
+    if (strcmp(spec, "%-") == 0) {
+        return before_last;
+    }
+
+    char is_job_number = (spec[0] == '%') || !number_is_pid;
+    const char *number_text = (spec[0] == '%') ? spec + 1 : spec;
+    char *end;
+    long number = strtol(number_text, &end, 10);
+    if (end == number_text || *end != '\0') {
+        return NULL;
+    }
+
+    for (shell_job *job = job_table; job != NULL; job = job->next) {
+        if (is_job_number && job->id == number) {
+            return job;
+        }
+        for (int i = 0; !is_job_number && i < job->num_processes; i++) {
+            if (job->processes[i].pid == number) {
+                return job;
+            }
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command jobs, it lists the jobs of the shell.
+ */
+int fun_JOBS(int argc, char **argv)
+{
+    (void)argv;
+    if (argc > 1) {
+        printf("jobs doesn't take arguments\n");
+        return 1;
+    }
+
+    jobs_reap();
+    shell_job *job = job_table;
+    while (job != NULL) {
+        shell_job *next = job->next;
+        print_job(job, job_marker(job));
+        job->notified_state = job_state(job);
+        if (job->notified_state == PROCESS_DONE) {
+            job_remove(job); /* Done jobs are shown once */
+        }
+        job = next;
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command fg, it continues a job in the foreground and waits for it.
+ */
+int fun_FG(int argc, char **argv)
+{
+    if (argc > 2) {
+        printf("fg: usage: fg [%%job]\n");
+        return 1;
+    }
+
+    jobs_reap();
+    shell_job *job = find_job((argc == 2) ? argv[1] : NULL, 0);
+    if (job == NULL) {
+        printf("fg: %s: no such job\n", (argc == 2) ? argv[1] : "current");
+        return 1;
+    }
+
+    printf("%s\n", job->command);
+    fflush(stdout);
+    job->background = 0;
+    if (job_control && job->has_tmodes) {
+        tcsetattr(shell_terminal, TCSADRAIN, &job->tmodes);
+    }
+    job_continue(job);
+    return job_wait(job, 1);
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command bg, it continues stopped jobs in the background.
+ */
+int fun_BG(int argc, char **argv)
+{
+    int status = 0;
+    int i = 1;
+    do {
+        jobs_reap();
+        shell_job *job = find_job((i < argc) ? argv[i] : NULL, 0);
+        if (job == NULL) {
+            printf("bg: %s: no such job\n", (i < argc) ? argv[i] : "current");
+            status = 1;
+            continue;
+        }
+        if (job_state(job) == PROCESS_RUNNING) {
+            printf("bg: job %d already in background\n", job->id);
+            continue;
+        }
+        job->background = 1;
+        job_continue(job);
+        printf("[%d]%c %s &\n", job->id, job_marker(job), job->command);
+    } while (++i < argc);
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command wait.
+ * 2. wait: waits for all background jobs, wait %n or wait PID: waits for one job and returns its status.
+ */
+int fun_WAIT(int argc, char **argv)
+{
+    jobs_reap();
+
+    if (argc == 1) {
+        shell_job *job = job_table;
+        while (job != NULL) {
+            shell_job *next = job->next;
+            if (job_state(job) != PROCESS_STOPPED) {
+                job_wait(job, 0);
+            }
+            job = next;
+        }
+        return 0;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        shell_job *job = find_job(argv[i], 1);
+        if (job == NULL) {
+            printf("wait: %s: no such job or child of this shell\n", argv[i]);
+            status = 127;
+            continue;
+        }
+        status = job_wait(job, 0);
+    }
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to start counting the resources of the children that finish from now on, for time.
+ * 2. saved keeps the counters from before, they are given to jobs_usage_end.
+ */
+void jobs_usage_begin(struct rusage *saved)
+{
+    *saved = children_usage;
+    children_usage.ru_maxrss = 0; /* The largest process is looked for again, among the new children only */
+}
+
+/*
+ * Description :
+ * 1. Function to get the resources of the children that finished since jobs_usage_begin: the sums of their
+ *    CPU times, page faults and context switches, and the largest max RSS of them.
+ */
+void jobs_usage_end(const struct rusage *saved, struct rusage *spent)
+{
+    *spent = children_usage;
+    add_usage(spent, saved, -1);
+    if (saved->ru_maxrss > children_usage.ru_maxrss) {
+        children_usage.ru_maxrss = saved->ru_maxrss; /* A time around this one still sees the largest of all */
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to compare two processes of phist -s, the one with the longest wall time comes first.
+ */
+static int compare_wall_time(const void *first, const void *second)
+{
+    const ProcessInfo *a = *(const ProcessInfo *const *)first;
+    const ProcessInfo *b = *(const ProcessInfo *const *)second;
+    return (a->wall_seconds < b->wall_seconds) - (a->wall_seconds > b->wall_seconds);
+}
+
+/*
+ * Description :
+ * 1. Function to be called to display the last processes with their PID, exit status, times and name.
+ * 2. phist [n] shows the last n processes (10 by default), phist -s sorts them with the slowest first,
+ *    phist -v adds the user and system time, max RSS, page faults and context switches.
+ * 3. The processes are recorded when the job table collects them, from the foreground or the background.
+ */
+int fun_PHIST(int argc, char **argv)
+{
+    int count = PHIST_DEFAULT_COUNT;
+    char slowest_first = 0;
+    char verbose = 0;
+    for (int i = 1; i < argc; i++) {
+        char *end;
+        long number = strtol(argv[i], &end, 10);
+        if (strcmp(argv[i], "-s") == 0) {
+            slowest_first = 1;
+        } else if (strcmp(argv[i], "-v") == 0) {
+            verbose = 1;
+        } else if (end != argv[i] && *end == '\0' && number > 0) {
+            count = (number < MAX_HISTORY) ? (int)number : MAX_HISTORY;
+        } else {
+            printf("phist: usage: phist [-s] [-v] [n], the last n processes (%d by default), -s: slowest first, -v: all resources\n",
+                   PHIST_DEFAULT_COUNT);
+            return 1;
+        }
+    }
+
+    jobs_reap();
+    if (count > process_count) {
+        count = process_count;
+    }
+    const ProcessInfo *shown[MAX_HISTORY];
+    for (int i = 0; i < count; i++) {
+        shown[i] = &process_history[(history_start + process_count - count + i) % MAX_HISTORY];
+    }
+    if (slowest_first) {
+        qsort(shown, count, sizeof(shown[0]), compare_wall_time);
+    }
+
+    printf("Last %d processes:\n", count); /* Display the count of recent processes */
+    printf("0 means: success, Other numbers mean: error \n");
+    printf("----------------------------------------------\n");
+    for (int i = 0; i < count; i++) {
+        if (!verbose) {
+            printf("PID: %d,     Exit Status: %d,      Wall: %.3fs,  CPU: %.3fs,      Process Name: %s\n", shown[i]->pid,
+                   shown[i]->exit_status, shown[i]->wall_seconds, shown[i]->cpu_seconds, shown[i]->process_name);
+            continue;
+        }
+        const struct rusage *usage = &shown[i]->usage;
+        printf("PID: %d,     Exit Status: %d,      Wall: %.3fs,  User: %.3fs,  Sys: %.3fs,  Max RSS: %ld KB,  "
+               "Faults: %ld minor %ld major,  Switches: %ld voluntary %ld involuntary,      Process Name: %s\n",
+               shown[i]->pid, shown[i]->exit_status, shown[i]->wall_seconds, timeval_seconds(&usage->ru_utime),
+               timeval_seconds(&usage->ru_stime), usage->ru_maxrss, usage->ru_minflt, usage->ru_majflt,
+               usage->ru_nvcsw, usage->ru_nivcsw, shown[i]->process_name);
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command accounting [on|off]: when it is on, the resources of every
+ *    process are printed on the standard error when it finishes. Without an argument it shows if it is on.
+ * 2. The resources are always saved for phist -v, this only prints them as the processes end.
+ */
+int fun_ACCOUNTING(int argc, char **argv)
+{
+    if (argc == 1) {
+        printf("accounting is %s\n", accounting ? "on" : "off");
+        return 0;
+    }
+    if (argc == 2 && strcmp(argv[1], "on") == 0) {
+        accounting = 1;
+    } else if (argc == 2 && strcmp(argv[1], "off") == 0) {
+        accounting = 0;
+    } else {
+        printf("accounting: usage: accounting [on|off]\n");
+        return 1;
+    }
+    return 0;
+}
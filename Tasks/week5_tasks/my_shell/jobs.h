@@ -0,0 +1,229 @@
+ /******************************************************************************
+ *
+ * File Name: jobs.h
+ *
+ * Description: Header file for jobs.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <time.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define MAX_HISTORY         (100)   /* Finished processes phist remembers */
+#define PHIST_DEFAULT_COUNT (10)    /* Processes phist shows without a number */
+#define MAX_PROCESS_NAME    (50)
+#define JOB_NO_PGROUP       (-1)    /* Process group of the jobs when job control is off, they stay in the shell's group */
+
+/* States of a process of a job */
+#define PROCESS_RUNNING     ('R')
+#define PROCESS_STOPPED     ('S')
+#define PROCESS_DONE        ('D')
+
+/*Struct to save Process pids and exit status*/
+typedef struct {
+    int pid;
+    int exit_status;
+    char process_name[MAX_PROCESS_NAME];
+    double wall_seconds;    /* From the start of the process to its end */
+    double cpu_seconds;     /* User and system CPU time of the process and its children, from wait4 */
+    struct rusage usage;    /* Everything wait4 counted: CPU times, max RSS, page faults and context switches */
+} ProcessInfo;
+
+/* Struct to save one process of a job, a pipeline has one per stage */
+typedef struct {
+    pid_t pid;          /* -1 if the stage couldn't start */
+    char *name;         /* Command name for phist, NULL for a process phist doesn't show */
+    char state;         /* One of PROCESS_* */
+    int status;         /* Exit status when PROCESS_DONE */
+    struct timespec started;
+} job_process;
+
+/* Struct to save a command or pipeline started by one command line, in the foreground or with & */
+typedef struct shell_job {
+    int id;                     /* %1, %2 ... */
+    pid_t pgid;                 /* Process group of all its processes, 0 until the first one starts */
+    char *command;              /* Text shown by jobs */
+    job_process *processes;
+    int num_processes;
+    int capacity;
+    char background;            /* Started with & or continued with bg */
+    char notified_state;        /* Last state printed for the user, to print each change once */
+    struct termios tmodes;      /* Terminal settings of a stopped job, given back by fg */
+    char has_tmodes;
+    struct shell_job *next;
+} shell_job;
+
+/*******************************************************************************
+ *                           Extern Global Variable                            *
+ *******************************************************************************/
+
+extern pid_t last_background_pid;   /* $! */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to prepare job control: an interactive shell puts itself in its own process group, takes the terminal
+ *    and ignores the stop signals, every job then gets its own process group.
+ * 2. It also installs the SIGCHLD handler which tells the shell that jobs changed.
+ */
+void jobs_init(char interactive);
+
+/*
+ * Description :
+ * 1. Function to know if jobs get their own process groups and the terminal, only in an interactive shell.
+ */
+char job_control_active(void);
+
+/*
+ * Description :
+ * 1. Function for a forked copy of the shell: it joins the process group pgid (0 for a new one),
+ *    takes the default signals back and forgets the jobs of the shell, they are not its children.
+ */
+void jobs_enter_child(pid_t pgid);
+
+/*
+ * Description :
+ * 1. Function to create a job, it is added to the job table.
+ */
+shell_job *job_create(const char *command, char background);
+
+/*
+ * Description :
+ * 1. Function to create a job named by the words of a command joined by spaces.
+ */
+shell_job *job_create_words(char *const argv[], char background);
+
+/*
+ * Description :
+ * 1. Function to get the process group a new process of the job must join: 0 for a new group,
+ *    the group of the first process, or JOB_NO_PGROUP when job control is off.
+ */
+pid_t job_spawn_pgid(const shell_job *job);
+
+/*
+ * Description :
+ * 1. Function to add a started process to a job, or a stage that couldn't start with pid -1 and its status.
+ */
+int job_add_process(shell_job *job, pid_t pid, const char *name, int status);
+
+/*
+ * Description :
+ * 1. Function to wait until all processes of a job finished or it was stopped with Ctrl+Z.
+ * 2. A foreground job gets the terminal while it runs.
+ * 3. It returns the status of the last process, 128 + SIGTSTP if it was stopped. A finished job is removed.
+ */
+int job_wait(shell_job *job, char foreground);
+
+/*
+ * Description :
+ * 1. Function for internal commands that run many processes themselves and can't be stopped:
+ *    it collects the changed children and continues the processes of the job stopped with Ctrl+Z.
+ */
+void job_keep_running(shell_job *job);
+
+/*
+ * Description :
+ * 1. Function to wait until one process of a job finished, the other processes keep running.
+ * 2. A process stopped with Ctrl+Z is continued, see job_keep_running.
+ * 3. It returns the status of the process.
+ */
+int job_wait_process(shell_job *job, pid_t pid);
+
+/*
+ * Description :
+ * 1. Function to give the terminal to a job, so Ctrl+C and Ctrl+Z are sent to its processes and not to the shell.
+ * 2. It returns 1 if the terminal was given and must be taken back with job_release_terminal.
+ */
+char job_take_terminal(shell_job *job);
+
+/*
+ * Description :
+ * 1. Function to take the terminal back from a job, saving its terminal settings if it was stopped.
+ */
+void job_release_terminal(shell_job *job);
+
+/*
+ * Description :
+ * 1. Function to leave a job running in the background, the interactive shell prints its number and PID.
+ */
+void job_background(shell_job *job);
+
+/*
+ * Description :
+ * 1. Function to collect the children that finished or stopped since the last call, without blocking.
+ * 2. The SIGCHLD handler only sets a flag, the real work is done here outside of the handler.
+ */
+void jobs_reap(void);
+
+/*
+ * Description :
+ * 1. Function to tell the user which background jobs finished or stopped, called before the prompt.
+ */
+void jobs_notify(char interactive);
+
+/*
+ * Description :
+ * 1. Function to start counting the resources of the children that finish from now on, for time.
+ * 2. saved keeps the counters from before, they are given to jobs_usage_end.
+ */
+void jobs_usage_begin(struct rusage *saved);
+
+/*
+ * Description :
+ * 1. Function to get the resources of the children that finished since jobs_usage_begin: the sums of their
+ *    CPU times, page faults and context switches, and the largest max RSS of them.
+ */
+void jobs_usage_end(const struct rusage *saved, struct rusage *spent);
+
+/*
+ * Description :
+ * 1. Function to get the seconds of a time from getrusage or wait4.
+ */
+double timeval_seconds(const struct timeval *time);
+
+/*
+ * Description :
+ * 1. Function to print the max RSS, the page faults and the context switches of a usage, without a new line.
+ */
+void print_resources(FILE *stream, const struct rusage *usage);
+
+/*
+ * Description :
+ * 1. Function to be called for the internal commands jobs, fg, bg and wait.
+ */
+int fun_JOBS(int argc, char **argv);
+int fun_FG(int argc, char **argv);
+int fun_BG(int argc, char **argv);
+int fun_WAIT(int argc, char **argv);
+
+/*
+ * Description :
+ * 1. Function to be called to display the last processes with their PID, exit status, times and name.
+ * 2. phist [n] shows the last n processes (10 by default), phist -s sorts them with the slowest first,
+ *    phist -v adds the user and system time, max RSS, page faults and context switches.
+ */
+int fun_PHIST(int argc, char **argv);
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command accounting [on|off]: when it is on, the resources of every
+ *    process are printed on the standard error when it finishes. Without an argument it shows if it is on.
+ */
+int fun_ACCOUNTING(int argc, char **argv);
+
+#endif // JOBS_H
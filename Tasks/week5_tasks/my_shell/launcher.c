@@ -0,0 +1,226 @@
+ /******************************************************************************
+ *
+ * File Name: launcher.c
+ *
+ * Description: Source file for starting external commands with posix_spawn instead of fork and exec,
+ *              and for moving descriptors around for redirections and pipes
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE  /* For pipe2 */
+#include <stdlib.h>
+#include <spawn.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "launcher.h"
+
+extern char **environ; /* The environment given to the launched commands */
+
+/*
+ * Description :
+ * 1. Function to add a descriptor copy at the end of the list, returns -1 if memory is exhausted.
+ */
+int launch_dups_add(launch_dups *dups, int target_fd, int source_fd, char owned)
+{
+    if (dups->count == dups->capacity) {
+        int capacity = dups->capacity ? dups->capacity * 2 : 4;
+        launch_dup *grown = realloc(dups->dups, capacity * sizeof(launch_dup));
+        if (grown == NULL) {
+            return -1;
+        }
+        dups->dups = grown;
+        dups->capacity = capacity;
+    }
+    dups->dups[dups->count].target_fd = target_fd;
+    dups->dups[dups->count].source_fd = source_fd;
+    dups->dups[dups->count].owned = owned;
+    dups->count++;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to close the descriptors the shell opened for a command and free the list.
+ */
+void launch_dups_release(launch_dups *dups)
+{
+    for (int i = 0; i < dups->count; i++) {
+        if (dups->dups[i].owned) {
+            close(dups->dups[i].source_fd);
+        }
+    }
+    free(dups->dups);
+    dups->dups = NULL;
+    dups->count = 0;
+    dups->capacity = 0;
+}
+
+/*
+ * Description :
+ * 1. Function to start the program at path with argv, without copying the shell's memory like fork does.
+ * 2. The descriptors in dups are copied in order in the child, dups may be NULL.
+ * 3. The child joins the process group pgid, 0 makes a new group, a negative pgid keeps the shell's group.
+ * 4. It returns 0 and stores the child PID, or the error number if the program couldn't be started.
+ */
+int launch_command(const char *path, char *const argv[], const launch_dups *dups, pid_t pgid, pid_t *pid)
+{
+    /*
+     * glibc runs posix_spawn as clone(CLONE_VM | CLONE_VFORK): the child shares the shell's memory until
+     * it calls exec, so no page tables are copied however big the shell is, and a failed exec is returned
+     * here as an error number instead of being an exit status of a child.
+     */
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attributes;
+    int result = posix_spawn_file_actions_init(&actions);
+    if (result != 0) {
+        return result;
+    }
+    result = posix_spawnattr_init(&attributes);
+    if (result != 0) {
+        posix_spawn_file_actions_destroy(&actions);
+        return result;
+    }
+
+    /* The shell's descriptors are close-on-exec, dup2 clears that flag on the copy */
+    for (int i = 0; dups != NULL && i < dups->count && result == 0; i++) {
+        if (dups->dups[i].source_fd == LAUNCH_CLOSE) {
+            result = posix_spawn_file_actions_addclose(&actions, dups->dups[i].target_fd);
+        } else {
+            result = posix_spawn_file_actions_adddup2(&actions, dups->dups[i].source_fd, dups->dups[i].target_fd);
+        }
+    }
+
+    /*
+     * The job control signals the shell ignores would stay ignored after exec, give the command the defaults.
+     * The group is set in the child before exec, so it is ready when the shell gives the terminal to it.
+     */
+    sigset_t default_signals;
+    sigset_t no_signals;
+    sigemptyset(&default_signals);
+    sigaddset(&default_signals, SIGTSTP);
+    sigaddset(&default_signals, SIGTTIN);
+    sigaddset(&default_signals, SIGTTOU);
+    sigemptyset(&no_signals);
+    short spawn_flags = POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETSIGMASK;
+    if (pgid >= 0) {
+        spawn_flags |= POSIX_SPAWN_SETPGROUP;
+        result = (result == 0) ? posix_spawnattr_setpgroup(&attributes, pgid) : result;
+    }
+    result = (result == 0) ? posix_spawnattr_setsigdefault(&attributes, &default_signals) : result;
+    result = (result == 0) ? posix_spawnattr_setsigmask(&attributes, &no_signals) : result;
+    result = (result == 0) ? posix_spawnattr_setflags(&attributes, spawn_flags) : result;
+
+    if (result == 0) {
+        result = posix_spawn(pid, path, &actions, &attributes, argv, environ);
+    }
+    posix_spawnattr_destroy(&attributes);
+    posix_spawn_file_actions_destroy(&actions);
+    return result;
+}
+
+/*
+ * Description :
+ * 1. Function to turn a status returned by waitpid into the exit status the shell reports in $?.
+ */
+int launch_status(int wait_status)
+{
+    if (WIFSIGNALED(wait_status)) {
+        return STATUS_SIGNALED + WTERMSIG(wait_status);
+    }
+    return WEXITSTATUS(wait_status);
+}
+
+/*
+ * Description :
+ * 1. Function to apply dups to the shell itself, for a builtin or a forked subshell.
+ * 2. If saved is not NULL it must hold dups->count entries, the original descriptors are kept there for restore_fds.
+ */
+int apply_fds(const launch_dups *dups, saved_fd *saved)
+{
+    for (int i = 0; i < dups->count; i++) {
+        const launch_dup *dup = &dups->dups[i];
+        if (saved != NULL) {
+            saved[i].target_fd = dup->target_fd;
+            saved[i].saved_fd = fcntl(dup->target_fd, F_DUPFD_CLOEXEC, HIGH_FD_MIN);
+        }
+        if (dup->source_fd == LAUNCH_CLOSE) {
+            close(dup->target_fd);
+        } else if (dup2(dup->source_fd, dup->target_fd) == -1) {
+            if (saved != NULL) {
+                restore_fds(saved, i + 1);
+            }
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to put back the descriptors changed by apply_fds, in reverse order.
+ */
+void restore_fds(saved_fd *saved, int count)
+{
+    for (int i = count - 1; i >= 0; i--) {
+        if (saved[i].saved_fd == -1) {
+            close(saved[i].target_fd); /* It wasn't open before the redirection */
+        } else {
+            dup2(saved[i].saved_fd, saved[i].target_fd);
+            close(saved[i].saved_fd);
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to move a close-on-exec descriptor above HIGH_FD_MIN, it returns the new descriptor or -1.
+ */
+static int move_fd_high(int fd)
+{
+    if (fd == -1 || fd >= HIGH_FD_MIN) {
+        return fd;
+    }
+    int high_fd = fcntl(fd, F_DUPFD_CLOEXEC, HIGH_FD_MIN);
+    close(fd);
+    return high_fd;
+}
+
+/*
+ * Description :
+ * 1. Function to open a redirection file in the shell so errors are reported before anything is started.
+ * 2. The descriptor is close-on-exec and above HIGH_FD_MIN, only its copy reaches the child
+ *    and it can't be overwritten by an earlier redirection like 4>b 3>a.
+ * 3. It returns the descriptor or -1 with errno set.
+ */
+int open_redirection(const char *file, int open_flags)
+{
+    return move_fd_high(open(file, open_flags | O_CLOEXEC, 0644));
+}
+
+/*
+ * Description :
+ * 1. Function to create a pipe whose ends are close-on-exec, so a launched command only gets the end given to it.
+ * 2. The ends are above HIGH_FD_MIN like the redirection files.
+ */
+int open_pipe(int pipe_fd[2])
+{
+    if (pipe2(pipe_fd, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    pipe_fd[0] = move_fd_high(pipe_fd[0]);
+    pipe_fd[1] = move_fd_high(pipe_fd[1]);
+    if (pipe_fd[0] == -1 || pipe_fd[1] == -1) {
+        if (pipe_fd[0] != -1) {
+            close(pipe_fd[0]);
+        }
+        if (pipe_fd[1] != -1) {
+            close(pipe_fd[1]);
+        }
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+ /******************************************************************************
+ *
+ * File Name: launcher.h
+ *
+ * Description: Header file for launcher.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef LAUNCHER_H
+#define LAUNCHER_H
+
+#include <sys/types.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define LAUNCH_CLOSE        (-1)    /* source_fd of a descriptor the command gets closed, [n]>&- */
+#define HIGH_FD_MIN         (10)    /* Descriptors the shell opens for commands are moved above the ones users redirect */
+#define STATUS_SIGNALED     (128)   /* Status of a command killed by a signal is 128 + the signal number */
+
+/* Struct to save one descriptor of the shell that becomes a descriptor of the launched command */
+typedef struct {
+    int target_fd;      /* Descriptor number in the command */
+    int source_fd;      /* Descriptor in the shell copied onto it, or LAUNCH_CLOSE */
+    char owned;         /* The shell opened source_fd for this command and closes it afterwards */
+} launch_dup;
+
+/* Struct to save the descriptors of a command in the order they are applied, like the redirections were written */
+typedef struct {
+    launch_dup *dups;
+    int count;
+    int capacity;
+} launch_dups;
+
+/* Struct to save the descriptors a builtin changed in the shell, to put them back when it returns */
+typedef struct {
+    int target_fd;
+    int saved_fd;       /* Copy of the original, -1 if target_fd was closed before */
+} saved_fd;
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to add a descriptor copy at the end of the list, returns -1 if memory is exhausted.
+ */
+int launch_dups_add(launch_dups *dups, int target_fd, int source_fd, char owned);
+
+/*
+ * Description :
+ * 1. Function to close the descriptors the shell opened for a command and free the list.
+ */
+void launch_dups_release(launch_dups *dups);
+
+/*
+ * Description :
+ * 1. Function to start the program at path with argv, without copying the shell's memory like fork does.
+ * 2. The descriptors in dups are copied in order in the child, dups may be NULL.
+ * 3. The child joins the process group pgid, 0 makes a new group, a negative pgid keeps the shell's group.
+ * 4. It returns 0 and stores the child PID, or the error number if the program couldn't be started.
+ */
+int launch_command(const char *path, char *const argv[], const launch_dups *dups, pid_t pgid, pid_t *pid);
+
+/*
+ * Description :
+ * 1. Function to turn a status returned by waitpid into the exit status the shell reports in $?.
+ */
+int launch_status(int wait_status);
+
+/*
+ * Description :
+ * 1. Function to apply dups to the shell itself, for a builtin or a forked subshell.
+ * 2. If saved is not NULL it must hold dups->count entries, the original descriptors are kept there for restore_fds.
+ */
+int apply_fds(const launch_dups *dups, saved_fd *saved);
+
+/*
+ * Description :
+ * 1. Function to put back the descriptors changed by apply_fds, in reverse order.
+ */
+void restore_fds(saved_fd *saved, int count);
+
+/*
+ * Description :
+ * 1. Function to open a redirection file in the shell so errors are reported before anything is started.
+ * 2. The descriptor is close-on-exec and above HIGH_FD_MIN, only its copy reaches the child
+ *    and it can't be overwritten by an earlier redirection like 4>b 3>a.
+ * 3. It returns the descriptor or -1 with errno set.
+ */
+int open_redirection(const char *file, int open_flags);
+
+/*
+ * Description :
+ * 1. Function to create a pipe whose ends are close-on-exec, so a launched command only gets the end given to it.
+ * 2. The ends are above HIGH_FD_MIN like the redirection files.
+ */
+int open_pipe(int pipe_fd[2]);
+
+#endif // LAUNCHER_H
@@ -0,0 +1,450 @@
+ /******************************************************************************
+ *
+ * File Name: line_editor.c
+ *
+ * Description: Source file for the line editor of the interactive shell: moving in the line, the history with
+ *              the arrows and the incremental reverse search of Ctrl+R
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <termios.h>
+#include "line_editor.h"
+#include "history.h"
+#include "my_shell.h"
+
+/* Struct to save the line being edited */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t pos;             /* Cursor */
+    size_t cap;
+    int age;                /* Line of the history shown, -1 for the line being typed */
+    char *typed;            /* The line being typed, kept while older lines are shown */
+    const char *prompt;
+    int prompt_length;
+} edit_line;
+
+static char *edit_buffer = NULL; /* Line returned by line_edit, it is reused by the next call */
+static size_t edit_capacity = 0;
+
+/*
+ * Description :
+ * 1. Function to know if the editor can be used: the standard input and output are a terminal that isn't dumb.
+ */
+int line_editor_usable(void)
+{
+    const char *term = getenv("TERM");
+    return isatty(STDIN) && isatty(STDOUT) && term != NULL && strcmp(term, "dumb") != 0;
+}
+
+/*
+ * Description :
+ * 1. Function to write a whole buffer to the terminal.
+ */
+static void editor_write(const char *data, size_t length)
+{
+    while (length > 0) {
+        ssize_t written = write(STDOUT, data, length);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to make room for length characters and the terminator in the line.
+ */
+static int edit_reserve(edit_line *line, size_t length)
+{
+    if (length + 1 <= line->cap) {
+        return 0;
+    }
+    size_t cap = line->cap ? line->cap : READ_CHUNK;
+    while (length + 1 > cap) {
+        cap *= 2;
+    }
+    char *data = realloc(line->data, cap);
+    if (data == NULL) {
+        return -1;
+    }
+    line->data = data;
+    line->cap = cap;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to replace the whole line, the cursor goes to its end.
+ */
+static void edit_set(edit_line *line, const char *text)
+{
+    size_t length = strlen(text);
+    if (edit_reserve(line, length) == -1) {
+        return;
+    }
+    memcpy(line->data, text, length + 1);
+    line->len = length;
+    line->pos = length;
+}
+
+/*
+ * Description :
+ * 1. Function to draw a prompt and a line again in one write: back to the start of the row, the prompt,
+ *    the text, clear what was after it and move the cursor back to its place.
+ * 2. The line is expected to fit in one row of the terminal.
+ */
+static void edit_draw(const char *prompt, size_t prompt_length, const char *text, size_t length, size_t pos)
+{
+    size_t size = prompt_length + length + EDITOR_REDRAW_EXTRA;
+    char *output = malloc(size);
+    if (output == NULL) {
+        return;
+    }
+    size_t used = 0;
+    output[used++] = '\r';
+    memcpy(output + used, prompt, prompt_length);
+    used += prompt_length;
+    memcpy(output + used, text, length);
+    used += length;
+    used += snprintf(output + used, size - used, "\033[K");
+    if (pos < length) {
+        used += snprintf(output + used, size - used, "\033[%zuD", length - pos);
+    }
+    editor_write(output, used);
+    free(output);
+}
+
+/*
+ * Description :
+ * 1. Function to draw the prompt and the line being edited.
+ */
+static void edit_refresh(const edit_line *line)
+{
+    edit_draw(line->prompt, line->prompt_length, line->data, line->len, line->pos);
+}
+
+/*
+ * Description :
+ * 1. Function to insert a character at the cursor.
+ */
+static void edit_insert(edit_line *line, char character)
+{
+    if (edit_reserve(line, line->len + 1) == -1) {
+        return;
+    }
+    memmove(line->data + line->pos + 1, line->data + line->pos, line->len - line->pos + 1);
+    line->data[line->pos++] = character;
+    line->len++;
+}
+
+/*
+ * Description :
+ * 1. Function to delete the characters between from and to.
+ */
+static void edit_delete(edit_line *line, size_t from, size_t to)
+{
+    memmove(line->data + from, line->data + to, line->len - to + 1);
+    line->len -= to - from;
+    line->pos = from;
+}
+
+/*
+ * Description :
+ * 1. Function to show an older (step 1) or newer (step -1) line of the history.
+ * 2. The line being typed is kept and comes back after the newest line.
+ */
+static void edit_history(edit_line *line, int step)
+{
+    int age = line->age + step;
+    const char *text = (age >= 0) ? history_get(age, NULL) : NULL;
+    if (age >= 0 && text == NULL) {
+        return; /* No older line */
+    }
+    if (line->age == -1) {
+        free(line->typed);
+        line->typed = strdup(line->data);
+    }
+    if (age < 0) {
+        age = -1;
+        text = (line->typed != NULL) ? line->typed : "";
+    }
+    line->age = age;
+    edit_set(line, text);
+}
+
+/*
+ * Description :
+ * 1. Function to read one key, KEY_END for the end of the input or an error.
+ */
+static int read_key(void)
+{
+    unsigned char key;
+    while (1) {
+        ssize_t bytes = read(STDIN, &key, 1);
+        if (bytes == 1) {
+            return key;
+        }
+        if (bytes == -1 && errno == EINTR) {
+            continue;
+        }
+        return KEY_END;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to read the rest of an escape sequence and turn the arrows and Home/End/Delete into control keys.
+ * 2. It returns 0 for the other sequences, they are ignored.
+ */
+static int read_escape(void)
+{
+    int first = read_key();
+    if (first != '[' && first != 'O') {
+        return 0;
+    }
+    int key = read_key();
+    if (key >= '0' && key <= '9') {
+        int end = read_key(); /* ESC [ 3 ~ */
+        if (end != '~') {
+            return 0;
+        }
+        return (key == '3') ? KEY_CTRL('D') : (key == '1' || key == '7') ? KEY_CTRL('A') :
+               (key == '4' || key == '8') ? KEY_CTRL('E') : 0;
+    }
+    switch (key) {
+    case 'A': return KEY_CTRL('P');
+    case 'B': return KEY_CTRL('N');
+    case 'C': return KEY_CTRL('F');
+    case 'D': return KEY_CTRL('B');
+    case 'H': return KEY_CTRL('A');
+    case 'F': return KEY_CTRL('E');
+    default: return 0;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function for Ctrl+R: every typed character narrows the search, Ctrl+R again finds an older match.
+ * 2. Enter runs the found line, Ctrl+G or Ctrl+C go back to the line as it was, other keys keep the found line
+ *    for editing.
+ * 3. It returns KEY_ENTER if the line must run now, 0 otherwise.
+ */
+static int reverse_search(edit_line *line)
+{
+    char query[EDITOR_QUERY_MAX];
+    size_t query_length = 0;
+    int match_age = -1;
+    char *found = NULL;
+    char failed = 0;
+    query[0] = '\0';
+
+    while (1) {
+        char prompt[EDITOR_QUERY_MAX + 32];
+        int prompt_length = snprintf(prompt, sizeof(prompt), "(%sreverse-i-search)`%s': ", failed ? "failed " : "", query);
+        const char *shown = (found != NULL) ? found : "";
+        edit_draw(prompt, prompt_length, shown, strlen(shown), strlen(shown));
+
+        int key = read_key();
+        int from = -1; /* Age where the search starts, -1 if the query didn't change */
+        if (key == KEY_CTRL('R')) {
+            from = match_age + 1;
+        } else if (key == KEY_BACKSPACE || key == KEY_CTRL('H')) {
+            if (query_length > 0) {
+                query[--query_length] = '\0';
+            }
+            from = 0;
+        } else if (key >= ' ' && key < KEY_BACKSPACE && query_length < sizeof(query) - 1) {
+            query[query_length++] = key;
+            query[query_length] = '\0';
+            from = (match_age >= 0) ? match_age : 0; /* The current match may still match */
+        } else {
+            /* Leave the search with the found line, or with the old one if it was cancelled */
+            char cancel = (key == KEY_CTRL('G') || key == KEY_CTRL('C') || key == KEY_END);
+            if (found != NULL && !cancel) {
+                edit_set(line, found);
+                line->age = -1;
+            }
+            free(found);
+            if (key == KEY_ESCAPE) {
+                read_escape();
+            }
+            return (key == KEY_ENTER || key == '\n') ? KEY_ENTER : 0;
+        }
+
+        /* Search older lines for the query */
+        failed = 1;
+        const char *text;
+        for (int age = from; query_length > 0 && (text = history_get(age, NULL)) != NULL; age++) {
+            if (strstr(text, query) != NULL) {
+                free(found);
+                found = strdup(text);
+                match_age = age;
+                failed = 0;
+                break;
+            }
+        }
+        if (query_length == 0) {
+            failed = 0;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to turn off the line mode of the terminal: keys are read one by one without echo,
+ *    and Ctrl+C, Ctrl+Z are keys instead of signals while the line is typed.
+ */
+static int enter_raw_mode(struct termios *saved)
+{
+    if (tcgetattr(STDIN, saved) == -1) {
+        return -1;
+    }
+    struct termios raw = *saved;
+    raw.c_iflag &= ~(ICRNL | IXON);
+    raw.c_lflag &= ~(ICANON | ECHO | IEXTEN | ISIG);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    return tcsetattr(STDIN, TCSADRAIN, &raw);
+}
+
+/*
+ * Description :
+ * 1. Function to write the prompt and read one line from the terminal with editing and the history:
+ *    arrows, Home/End, Ctrl+A/E/B/F/U/K/W/L, Up/Down or Ctrl+P/N for older and newer lines,
+ *    and Ctrl+R to search the history backwards while typing.
+ * 2. Ctrl+C drops the line, Ctrl+D on an empty line ends the input.
+ * 3. It returns the line, valid until the next call, or NULL at the end of the input or on a read error.
+ */
+char *line_edit(const char *prompt, int prompt_length)
+{
+    struct termios saved;
+    fflush(stdout); /* Output of the last command comes before the prompt */
+    if (enter_raw_mode(&saved) == -1) {
+        return NULL;
+    }
+
+    edit_line line = {edit_buffer, 0, 0, edit_capacity, -1, NULL, prompt, prompt_length};
+    char done = 0;
+    char end_of_input = 0;
+    char dropped = 0; /* Ctrl+C, the line stays as it was typed followed by ^C */
+    if (edit_reserve(&line, 0) == -1) {
+        end_of_input = 1;
+        done = 1;
+    } else {
+        line.data[0] = '\0';
+        editor_write(prompt, prompt_length);
+    }
+
+    while (!done) {
+        int key = read_key();
+        if (key == KEY_ESCAPE) {
+            key = read_escape();
+        }
+
+        switch (key) {
+        case KEY_END:
+            end_of_input = 1; /* The terminal is gone */
+            done = 1;
+            break;
+        case KEY_ENTER:
+        case '\n':
+            done = 1;
+            break;
+        case KEY_CTRL('C'):
+            editor_write("^C", 2);
+            line.len = line.pos = 0;
+            line.data[0] = '\0';
+            dropped = 1;
+            done = 1;
+            break;
+        case KEY_CTRL('D'):
+            if (line.len == 0) {
+                end_of_input = 1;
+                done = 1;
+            } else if (line.pos < line.len) {
+                edit_delete(&line, line.pos, line.pos + 1);
+            }
+            break;
+        case KEY_BACKSPACE:
+        case KEY_CTRL('H'):
+            if (line.pos > 0) {
+                edit_delete(&line, line.pos - 1, line.pos);
+            }
+            break;
+        case KEY_CTRL('A'):
+            line.pos = 0;
+            break;
+        case KEY_CTRL('E'):
+            line.pos = line.len;
+            break;
+        case KEY_CTRL('B'):
+            line.pos -= (line.pos > 0);
+            break;
+        case KEY_CTRL('F'):
+            line.pos += (line.pos < line.len);
+            break;
+        case KEY_CTRL('U'):
+            edit_delete(&line, 0, line.pos);
+            break;
+        case KEY_CTRL('K'):
+            line.len = line.pos;
+            line.data[line.len] = '\0';
+            break;
+        case KEY_CTRL('W'): {
+            size_t from = line.pos;
+            while (from > 0 && line.data[from - 1] == ' ') {
+                from--;
+            }
+            while (from > 0 && line.data[from - 1] != ' ') {
+                from--;
+            }
+            edit_delete(&line, from, line.pos);
+            break;
+        }
+        case KEY_CTRL('L'):
+            editor_write("\033[H\033[2J", 7);
+            break;
+        case KEY_CTRL('P'):
+            edit_history(&line, 1);
+            break;
+        case KEY_CTRL('N'):
+            edit_history(&line, -1);
+            break;
+        case KEY_CTRL('R'):
+            done = (reverse_search(&line) == KEY_ENTER);
+            break;
+        default:
+            if (key >= ' ' && key != KEY_BACKSPACE) {
+                edit_insert(&line, key);
+            }
+            break;
+        }
+        if (!done) {
+            edit_refresh(&line);
+        }
+    }
+
+    if (!end_of_input && !dropped) {
+        edit_refresh(&line); /* The whole line stays shown, also after Ctrl+R */
+    }
+    editor_write("\r\n", 2);
+    tcsetattr(STDIN, TCSADRAIN, &saved);
+
+    free(line.typed);
+    edit_buffer = line.data;
+    edit_capacity = line.cap;
+    return end_of_input ? NULL : line.data;
+}
@@ -0,0 +1,48 @@
+ /******************************************************************************
+ *
+ * File Name: line_editor.h
+ *
+ * Description: Header file for line_editor.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef LINE_EDITOR_H
+#define LINE_EDITOR_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define EDITOR_QUERY_MAX    (256)   /* Longest text searched with Ctrl+R */
+#define EDITOR_REDRAW_EXTRA (64)    /* Bytes of the escape sequences written around the prompt and the line */
+
+/* Keys read by the editor */
+#define KEY_CTRL(key)       ((key) & 0x1f)
+#define KEY_ESCAPE          (27)
+#define KEY_BACKSPACE       (127)
+#define KEY_ENTER           ('\r')
+#define KEY_END             (-1)    /* The input ended or can't be read */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to know if the editor can be used: the standard input and output are a terminal that isn't dumb.
+ */
+int line_editor_usable(void);
+
+/*
+ * Description :
+ * 1. Function to write the prompt and read one line from the terminal with editing and the history:
+ *    arrows, Home/End, Ctrl+A/E/B/F/U/K/W/L, Up/Down or Ctrl+P/N for older and newer lines,
+ *    and Ctrl+R to search the history backwards while typing.
+ * 2. Ctrl+C drops the line, Ctrl+D on an empty line ends the input.
+ * 3. It returns the line, valid until the next call, or NULL at the end of the input or on a read error.
+ */
+char *line_edit(const char *prompt, int prompt_length);
+
+#endif // LINE_EDITOR_H
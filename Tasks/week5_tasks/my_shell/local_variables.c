@@ -0,0 +1,245 @@
+ /******************************************************************************
+ *
+ * File Name: local_variables.c
+ *
+ * Description: Source file for the local variables: a hash table with open addressing over an array of variables
+ *              in the order they were set, with the names and values kept in a string arena
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "local_variables.h"
+
+static local_variable *variables = NULL; /* Variables in the order they were first set */
+static int variable_count = 0;
+static int variable_capacity = 0;
+static int *variable_index = NULL; /* Slots with the position of a variable in variables, or VARIABLES_EMPTY_SLOT */
+static unsigned int index_slots = 0; /* A power of two, so the slot of a hash is hash & (index_slots - 1) */
+static arena_block *arena = NULL; /* Newest block first, strings are only added at the end of it */
+static size_t arena_total = 0; /* Bytes taken from all the blocks */
+static size_t arena_live = 0; /* Bytes of these that still belong to a name or a value */
+
+/*
+ * Description :
+ * 1. Function to calculate the hash of a variable name (FNV-1a), like the command hash.
+ */
+static unsigned int variable_hash(const char *name, size_t name_length)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < name_length; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * Description :
+ * 1. Function to take size bytes from the arena, a new block is added when the newest one is full.
+ * 2. It returns NULL if memory is exhausted.
+ */
+static char *arena_alloc(size_t size)
+{
+    if (arena == NULL || arena->size - arena->used < size) {
+        size_t block_size = (size > VARIABLES_ARENA_BLOCK) ? size : VARIABLES_ARENA_BLOCK;
+        arena_block *block = malloc(sizeof(arena_block) + block_size);
+        if (block == NULL) {
+            return NULL;
+        }
+        block->next = arena;
+        block->used = 0;
+        block->size = block_size;
+        arena = block;
+    }
+    char *memory = arena->data + arena->used;
+    arena->used += size;
+    arena_total += size;
+    arena_live += size;
+    return memory;
+}
+
+/*
+ * Description :
+ * 1. Function to copy all names and values to a new arena and free the old one, when most of it is old values.
+ * 2. A loop that changes a variable again and again would otherwise make the arena grow forever.
+ */
+static void arena_compact(void)
+{
+    if (arena_total - arena_live <= arena_live || arena_total - arena_live < VARIABLES_ARENA_BLOCK) {
+        return;
+    }
+
+    arena_block *old_arena = arena;
+    size_t old_total = arena_total;
+    size_t old_live = arena_live;
+    arena = NULL;
+    arena_total = 0;
+    arena_live = 0;
+    for (int i = 0; i < variable_count; i++) {
+        local_variable *variable = &variables[i];
+        size_t value_length = strlen(variable->value) + 1;
+        char *strings = arena_alloc(variable->name_length + 1 + value_length);
+        if (strings == NULL) {
+            /* The old blocks are kept behind the new ones, the variables not copied yet still use them */
+            arena_block *last = arena;
+            while (last != NULL && last->next != NULL) {
+                last = last->next;
+            }
+            if (last != NULL) {
+                last->next = old_arena;
+            } else {
+                arena = old_arena;
+            }
+            arena_total += old_total;
+            arena_live = old_live;
+            return;
+        }
+        memcpy(strings, variable->name, variable->name_length + 1);
+        memcpy(strings + variable->name_length + 1, variable->value, value_length);
+        variable->name = strings;
+        variable->value = strings + variable->name_length + 1;
+        variable->value_capacity = value_length;
+    }
+
+    while (old_arena != NULL) {
+        arena_block *next = old_arena->next;
+        free(old_arena);
+        old_arena = next;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to find the slot of a name in the index, the slots after its hash are tried one by one.
+ * 2. It returns the slot of the variable, or the empty slot where it would be added.
+ */
+static unsigned int find_slot(const char *name, size_t name_length, unsigned int hash)
+{
+    unsigned int slot = hash & (index_slots - 1);
+    while (variable_index[slot] != VARIABLES_EMPTY_SLOT) {
+        const local_variable *variable = &variables[variable_index[slot]];
+        if (variable->hash == hash && variable->name_length == name_length &&
+            memcmp(variable->name, name, name_length) == 0) {
+            break;
+        }
+        slot = (slot + 1) & (index_slots - 1);
+    }
+    return slot;
+}
+
+/*
+ * Description :
+ * 1. Function to double the index, the variables are put in their new slots with the hashes they kept.
+ * 2. It returns 0, or -1 if memory is exhausted.
+ */
+static int grow_index(void)
+{
+    unsigned int slots = index_slots ? index_slots * 2 : VARIABLES_INITIAL_SLOTS;
+    int *index = malloc(slots * sizeof(int));
+    if (index == NULL) {
+        return -1;
+    }
+    for (unsigned int i = 0; i < slots; i++) {
+        index[i] = VARIABLES_EMPTY_SLOT;
+    }
+    for (int i = 0; i < variable_count; i++) {
+        unsigned int slot = variables[i].hash & (slots - 1);
+        while (index[slot] != VARIABLES_EMPTY_SLOT) {
+            slot = (slot + 1) & (slots - 1);
+        }
+        index[slot] = i;
+    }
+    free(variable_index);
+    variable_index = index;
+    index_slots = slots;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to set a local variable, the name is the first name_length characters of name.
+ * 2. A new value that fits in the old one is written in place, otherwise it is added to the arena.
+ * 3. It returns 0, or -1 if memory is exhausted.
+ */
+int local_variable_set(const char *name, size_t name_length, const char *value)
+{
+    if ((unsigned long)(variable_count + 1) * 100 > (unsigned long)index_slots * VARIABLES_MAX_LOAD && grow_index() == -1) {
+        return -1;
+    }
+
+    size_t value_length = strlen(value) + 1;
+    unsigned int hash = variable_hash(name, name_length);
+    unsigned int slot = find_slot(name, name_length, hash);
+    if (variable_index[slot] != VARIABLES_EMPTY_SLOT) {
+        local_variable *variable = &variables[variable_index[slot]];
+        if (value_length > variable->value_capacity) {
+            char *new_value = arena_alloc(value_length);
+            if (new_value == NULL) {
+                return -1;
+            }
+            arena_live -= variable->value_capacity; /* The old value stays in the arena until it is compacted */
+            variable->value = new_value;
+            variable->value_capacity = value_length;
+        }
+        memcpy(variable->value, value, value_length);
+        arena_compact();
+        return 0;
+    }
+
+    if (variable_count == variable_capacity) {
+        int capacity = variable_capacity ? variable_capacity * 2 : VARIABLES_INITIAL_SLOTS;
+        local_variable *grown = realloc(variables, capacity * sizeof(local_variable));
+        if (grown == NULL) {
+            return -1;
+        }
+        variables = grown;
+        variable_capacity = capacity;
+    }
+
+    /* The name and its value are next to each other in the arena */
+    char *strings = arena_alloc(name_length + 1 + value_length);
+    if (strings == NULL) {
+        return -1;
+    }
+    memcpy(strings, name, name_length);
+    strings[name_length] = '\0';
+    memcpy(strings + name_length + 1, value, value_length);
+
+    local_variable *variable = &variables[variable_count];
+    variable->name = strings;
+    variable->name_length = name_length;
+    variable->value = strings + name_length + 1;
+    variable->value_capacity = value_length;
+    variable->hash = hash;
+    variable_index[slot] = variable_count++;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to get the value of a local variable, the name is the first name_length characters of name.
+ * 2. It returns NULL if the variable doesn't exist.
+ */
+const char *local_variable_get(const char *name, size_t name_length)
+{
+    if (variable_count == 0) {
+        return NULL;
+    }
+    unsigned int slot = find_slot(name, name_length, variable_hash(name, name_length));
+    return (variable_index[slot] != VARIABLES_EMPTY_SLOT) ? variables[variable_index[slot]].value : NULL;
+}
+
+/*
+ * Description :
+ * 1. Function to print all local variables as name=value, in the order they were first set.
+ */
+void local_variables_print(void)
+{
+    for (int i = 0; i < variable_count; i++) {
+        printf("%s=%s\n", variables[i].name, variables[i].value);
+    }
+}
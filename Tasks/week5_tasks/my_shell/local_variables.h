@@ -0,0 +1,66 @@
+ /******************************************************************************
+ *
+ * File Name: local_variables.h
+ *
+ * Description: Header file for local_variables.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef LOCAL_VARIABLES_H
+#define LOCAL_VARIABLES_H
+
+#include <stddef.h>
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define VARIABLES_INITIAL_SLOTS (64)        /* Slots of the index at the start, a power of two, it doubles when full */
+#define VARIABLES_MAX_LOAD      (70)        /* Percent of used slots before the index doubles */
+#define VARIABLES_ARENA_BLOCK   (16 * 1024) /* Bytes of one block of the string arena, longer strings get their own block */
+#define VARIABLES_EMPTY_SLOT    (-1)
+
+/* Struct to save one local variable, the name and the value are in the string arena */
+typedef struct {
+    char *name;
+    char *value;
+    size_t name_length;
+    size_t value_capacity;  /* Bytes kept for the value, a new value that fits is written in place */
+    unsigned int hash;      /* Kept so the index can grow without hashing the names again */
+} local_variable;
+
+/* Struct to save one block of the string arena, blocks are never moved so the strings stay where they are */
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t used;
+    size_t size;
+    char data[];
+} arena_block;
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to set a local variable, the name is the first name_length characters of name.
+ * 2. It returns 0, or -1 if memory is exhausted.
+ */
+int local_variable_set(const char *name, size_t name_length, const char *value);
+
+/*
+ * Description :
+ * 1. Function to get the value of a local variable, the name is the first name_length characters of name.
+ * 2. It returns NULL if the variable doesn't exist.
+ */
+const char *local_variable_get(const char *name, size_t name_length);
+
+/*
+ * Description :
+ * 1. Function to print all local variables as name=value, in the order they were first set.
+ */
+void local_variables_print(void);
+
+#endif // LOCAL_VARIABLES_H
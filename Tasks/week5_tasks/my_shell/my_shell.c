@@ -2,7 +2,8 @@
  *
  * File Name: my_shell.c
  *
- * Description: Shell Program used to do the Following commands (mypwd,myecho,mycp,mymv,help,type,envir,cd,exit and all external commands)
+ * Description: Shell Program used to do the Following commands (mypwd,myecho,mycp,mymv,help,type,envir,cd,hash,exit and all external commands)
+ *              from the user, from a script (my_shell script.sh) or from a string (my_shell -c "commands")
  *
  * Author: Karim Gomaa
  *
@@ -12,11 +13,15 @@
 #include <string.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
 #include "my_shell.h"
 #include "internal_commands.h"
-#include "external_commands.h"
-
-char input_string[INPUT_BUFFER]; /* Global buffer to hold the command input and used across all functions */
+#include "parser.h"
+#include "executor.h"
+#include "jobs.h"
+#include "history.h"
+#include "line_editor.h"
 
 /*
  * Description :
@@ -30,285 +35,205 @@ void ERROR_MESSAGE()
 
 /*
  * Description :
- * 1. Function used to remove the "set" prefix when trying to insert an environmental variable.
- */
-void remove_set_prefix(char *str) {
-    const char *prefix = "set "; /* Prefix to remove from the string */
-    char *pos = strstr(str, prefix); /* Find the position of the prefix in the string */
-    
-    if (pos != NULL) { /* If the prefix is found */
-        // Move the pointer past the "set " prefix
-        char *new_start = pos + strlen(prefix); /* Calculate new start position */
-        memmove(str, new_start, strlen(new_start) + 1); /* Move the remaining string to the start */
-    }
-}
-
-/*
- * Description :
- * 1. Function to remove leading spaces from the input string.
+ * 1. Function to read the next line of the input, without its new line.
+ * 2. The input is read in big chunks and the rest after the new line is kept for the next call,
+ *    so piped or pasted lines are never cut or joined.
+ * 3. It returns the line, valid until the next call, or NULL at the end of the input.
  */
-void REMOVE_LeadingSpaces(char *str)
+static char *read_line(line_reader *reader)
 {
-    int i = 0; /* Index for iterating through the string */
-    int j = 0; /* Index for writing characters to the string */
-
-    while (str[i] == ' ') {
-        i++; /* Increment index until a non-space character is found */
+    /* Drop the line returned last time */
+    if (reader->consumed > 0) {
+        memmove(reader->data, reader->data + reader->consumed, reader->len - reader->consumed);
+        reader->len -= reader->consumed;
+        reader->scanned = 0;
+        reader->consumed = 0;
     }
 
-    while (str[i]) {
-        str[j++] = str[i++]; /* Copy characters to the beginning of the string */
-    }
+    while (1) {
+        char *newline = (reader->len > reader->scanned) ? memchr(reader->data + reader->scanned, '\n', reader->len - reader->scanned) : NULL;
+        if (newline != NULL) {
+            *newline = '\0';
+            reader->consumed = newline - reader->data + 1;
+            return reader->data;
+        }
+        reader->scanned = reader->len;
+
+        /* Make room for another chunk and the terminator */
+        if (reader->len + READ_CHUNK + 1 > reader->cap) {
+            size_t cap = reader->cap ? reader->cap * 2 : READ_CHUNK * 2;
+            char *data = realloc(reader->data, cap);
+            if (data == NULL) {
+                errno = ENOMEM;
+                return NULL;
+            }
+            reader->data = data;
+            reader->cap = cap;
+        }
 
-    str[j] = '\0'; /* End the string with a null terminator */
+        ssize_t bytes = read(reader->fd, reader->data + reader->len, READ_CHUNK);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes <= 0) {
+            /* The last line may have no new line */
+            if (bytes == 0 && reader->len > 0) {
+                reader->data[reader->len] = '\0';
+                reader->consumed = reader->len;
+                return reader->data;
+            }
+            return NULL;
+        }
+        reader->len += bytes;
+    }
 }
 
 /*
  * Description :
- * 1. Function to remove the newline character from the input string.
+ * 1. Function to get the shell prompt and its length.
+ * 2. The prompt is built once, it is built again only after cd.
  */
-void remove_newline(char *str)
+static const char *shell_prompt(int *length)
 {
-    char *pos;
-    if ((pos = strchr(str, '\n')) != NULL) { /* Find the newline character in the string */
-        *pos = '\0'; /* Replace newline with null terminator */
+    static char prompt[PROMPT_BUFFER]; /* Colored prompt with the working directory */
+    static int prompt_length = 0;
+
+    if (pwd_changed) {
+        fun_PWD(); /* Call function to get current working directory */
+        prompt_length = snprintf(prompt, sizeof(prompt), GREEN "Yaa Naaa3m: " RESET BLUE "%s" RESET RED " >>> " RESET, pwd_PATH);
+        if (prompt_length >= (int)sizeof(prompt)) {
+            prompt_length = sizeof(prompt) - 1; /* A very long directory is cut */
+        }
+        pwd_changed = 0;
     }
+    *length = prompt_length;
+    return prompt;
 }
 
 /*
  * Description :
  * 1. Function to write the shell prompt.
+ * 2. The prompt is built once and written with one write, it is built again only after cd.
  */
 void fun_SHELL_WRITE()
 {
-    const char *shellMsg = "Yaa Naaa3m: "; /* Prompt message */
-    const char *shellMsg2 = " >>> "; /* Prompt suffix */
-    int write_cheaker = 0; /* Variable to check if writing was successful */
+    int prompt_length;
+    const char *prompt = shell_prompt(&prompt_length);
 
-    fun_PWD(); /* Call function to get current working directory */
-    write(STDOUT, GREEN, strlen(GREEN)); /* Set text color to green */
-    write_cheaker = write(STDOUT, shellMsg, strlen(shellMsg)); /* Write the prompt message */
-    write(STDOUT, RESET, strlen(RESET)); /* Reset text color */
-    if (write_cheaker <= 0) /* Check if writing was unsuccessful */
+    fflush(stdout); /* Output of the last command comes before the prompt */
+    if (write(STDOUT, prompt, prompt_length) <= 0) /* Check if writing was unsuccessful */
     {
         printf("Can't Read from user Shell will stop \n"); /* Print error message */
         perror("write"); /* Print system error message */
         exit(1); /* Exit with an error code */
     }
+}
 
-    write(STDOUT, BLUE, strlen(BLUE)); /* Set text color to blue */
-    write_cheaker = write(STDOUT, pwd_PATH, strlen(pwd_PATH)); /* Write the current working directory */
-    write(STDOUT, RESET, strlen(RESET)); /* Reset text color */
-    if (write_cheaker <= 0) /* Check if writing was unsuccessful */
-    {
-        printf("Can't Read from user Shell will stop \n"); /* Print error message */
-        perror("write"); /* Print system error message */
-        exit(1); /* Exit with an error code */
-    }
+/*
+ * Description :
+ * 1. Function to parse and run one line, or the whole string given to -c.
+ */
+static void run_line(const char *line)
+{
+    shell_node *tree; /* Command tree of the line */
 
-    write(STDOUT, RED, strlen(RED)); /* Set text color to red */
-    write_cheaker = write(STDOUT, shellMsg2, strlen(shellMsg2)); /* Write the prompt suffix */
-    write(STDOUT, RESET, strlen(RESET)); /* Reset text color */
-    if (write_cheaker <= 0) /* Check if writing was unsuccessful */
+    /* Build the tree of the whole line first, a syntax error runs nothing */
+    if (parse_command_line(line, &tree) == -1)
     {
-        printf("Can't Read from user Shell will stop \n"); /* Print error message */
-        perror("write"); /* Print system error message */
-        exit(1); /* Exit with an error code */
+        last_exit_status = STATUS_SYNTAX_ERROR;
+        return;
     }
-}
 
+    execute_node(tree); /* Run the commands, an empty line or a comment is a NULL tree */
+    free_node(tree);
+}
 
-/* Main function entry point */
-int main(void)
+/*
+ * Description :
+ * 1. Function to run all lines of an input until exit or its end.
+ * 2. The prompt is only written for an interactive shell, scripts and piped commands run without it.
+ * 3. On a terminal the lines are read with the line editor and remembered in the history.
+ */
+static void run_input(line_reader *reader, char show_prompt)
 {
-    char  *token; /* Token for separating the command */
-    char input_string_main_copy[INPUT_BUFFER]; /* Copy of input string to avoid modification by strtok in other functions */
-    char envir_variable_checker[INPUT_BUFFER]; /* Copy of input string to check environment variables */
+    char use_editor = show_prompt && line_editor_usable();
 
-    int read_cheaker = 0; /* Variable to check if reading input was successful */
-
-    while (1) /* Infinite loop for the shell to continuously accept commands */
+    while (!exit_requested) /* Loop for the shell to continuously accept commands until exit */
     {
-        fun_SHELL_WRITE(); /* Display the shell prompt */
-
-        read_cheaker = read(STDIN, input_string, INPUT_BUFFER); /* Read input from the user */
-        if (read_cheaker <= 0) /* Check if reading input was unsuccessful */
+        jobs_notify(show_prompt); /* Tell about background jobs that finished before the next command */
+
+        char *line;
+        errno = 0;
+        if (use_editor) {
+            int prompt_length;
+            const char *prompt = shell_prompt(&prompt_length);
+            line = line_edit(prompt, prompt_length); /* Read input from the user */
+        } else {
+            if (show_prompt) {
+                fun_SHELL_WRITE(); /* Display the shell prompt */
+            }
+            line = read_line(reader); /* Read input from the user */
+        }
+        if (line == NULL) /* Check if reading input was unsuccessful */
         {
-            printf("Can't Read from user Shell will stop \n"); /* Print error message */
-            perror("read"); /* Print system error message */
+            if (errno != 0) {
+                printf("Can't Read from user Shell will stop \n"); /* Print error message */
+                perror("read"); /* Print system error message */
+            } else if (show_prompt && !use_editor) {
+                printf("\n"); /* Ctrl+D, end the prompt line */
+            }
             break; /* Exit the loop */
         }
 
-        REMOVE_LeadingSpaces(input_string); /* Remove leading spaces from input string */
-
-        if (input_string[0] != '\n') { /* Check if input is not just a newline */
-            remove_newline(input_string); /* Remove newline character from input string */
+        if (show_prompt) {
+            history_add(line);
         }
+        run_line(line);
+    }
+    fflush(stdout);
+}
 
-        strcpy(input_string_main_copy, input_string); /* Copy input string to main copy for processing */
-        strcpy(envir_variable_checker, input_string); /* Copy input string to check environment variables */
+/* Main function entry point */
+int main(int argc, char *argv[])
+{
+    line_reader reader = {STDIN, NULL, 0, 0, 0, 0}; /* Input lines of any length */
 
-        char *set_check = strtok(envir_variable_checker, " "); /* Tokenize the input to check if it starts with "set" */
-        if (strcmp(set_check, "set") == 0) /* Check if the command is "set" */
-        {
-            remove_set_prefix(input_string_main_copy); /* Remove "set" prefix from input string */
-            char *equal_sign = strchr(input_string_main_copy, '='); /* Find the equal sign in the input string */
-            if (equal_sign != NULL) /* Check if equal sign was found */
-            {
-                fun_PLACE_VARIABLE(input_string_main_copy, equal_sign, ENVIROMENT_VARIABLE); /* Place the environment variable */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            ERROR_MESSAGE(); /* Print error message */
-            continue; /* Skip to the next iteration of the loop */
-        }
-        else
-        {
-            char *equal_sign = strchr(input_string_main_copy, '='); /* Find the equal sign in the input string */
-            if (equal_sign != NULL) /* Check if equal sign was found */
-            {
-                fun_PLACE_VARIABLE(input_string_main_copy, equal_sign, LOCAL_VARIABLE); /* Place the local variable */
-                continue; /* Skip to the next iteration of the loop */
-            }
+    if (argc >= 2 && strcmp(argv[1], "-c") == 0)
+    {
+        /* my_shell -c "commands": run the string and stop, like sh -c */
+        if (argc < 3) {
+            fprintf(stderr, "my_shell: -c: option requires an argument\n");
+            return STATUS_USAGE;
         }
+        jobs_init(0);
+        run_line(argv[2]);
+        fflush(stdout);
+        return last_exit_status;
+    }
 
-        /* Get the first token (command) */
-        token = strtok(input_string_main_copy, " ");
-
-        if (*token == '\r' || *token == '\n') /* Check if token is just a carriage return or newline */
-        {
-            continue; /* Skip to the next iteration of the loop */
-        }
-        else if (is_internal_command(token)) /* Check if the token is an internal command */
-        {
-            if (strcmp(token, "help") == 0) /* Check if the command is "help" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_HELP(); /* Display help information */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "mypwd") == 0) /* Check if the command is "mypwd" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_PWD(); /* Display current working directory */
-                printf("%s \n", pwd_PATH); /* Print the path */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "myecho") == 0) /* Check if the command is "myecho" */
-            {
-                fun_ECHO(); /* Display echoed text */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "exit") == 0) /* Check if the command is "exit" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                printf(YELLOW "Hatw7shni y sa7by <_> \n5od balak 3la nfsk bye \n" RESET); /* Print farewell message */
-                break; /* Exit the loop and terminate the shell */
-            }
-            else if (strcmp(token, "mycp") == 0) /* Check if the command is "mycp" */
-            {
-                fun_COPY(); /* Perform copy operation */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "mymv") == 0) /* Check if the command is "mymv" */
-            {
-                fun_MOVE(); /* Perform move operation */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "cd") == 0) /* Check if the command is "cd" */
-            {
-                fun_CD(); /* Change directory */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "type") == 0) /* Check if the command is "type" */
-            {
-                fun_TYPE(); /* Display type information */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "envir") == 0) /* Check if the command is "envir" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                fun_ENVIR(token); /* Display environment variables */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "phist") == 0) /* Check if the command is "phist" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_PHIST(); /* Print command history */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "free") == 0) /* Check if the command is "free" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_FREE(); /* Free memory or resources */
-                continue; /* Skip to the next iteration of the loop */
-            }
-            else if (strcmp(token, "uptime") == 0) /* Check if the command is "uptime" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    ERROR_MESSAGE(); /* Print error message */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_UPTIME(); /* Display system uptime */
-                continue; /* Skip to the next iteration of the loop */
-            }   
-            else if (strcmp(token, "allvars") == 0) /* Check if the command is "allvars" */
-            {
-                token = strtok(NULL, " "); /* Get the next token */
-                if (token != NULL) /* Check if there are extra tokens */
-                {
-                    char *check_more = strtok(NULL, " "); /* Check for more tokens */
-                    if (check_more != NULL) /* Check if there are more tokens */
-                    {
-                        ERROR_MESSAGE(); /* Print error message */
-                        printf("allvars: prints all local and envir variables\nallvars -l: print local variables only\nenvir: prints enviroment variables only\n"); /* Print usage information */
-                        continue; /* Skip to the next iteration of the loop */
-                    }
-                    fun_ALLVARS(token); /* Display all variables */
-                    continue; /* Skip to the next iteration of the loop */
-                }
-                fun_ALLVARS(token); /* Display all variables */
-                continue; /* Skip to the next iteration of the loop */
-            }  
-        }
-        else if (is_external_command(token)) /* Check if the token is an external command */
-        {
-            fun_EXTERNAL_COMMAND(); /* Execute the external command */
-            continue; /* Skip to the next iteration of the loop */
+    if (argc >= 2)
+    {
+        /* my_shell script.sh: run the lines of the script without a prompt */
+        reader.fd = open(argv[1], O_RDONLY | O_CLOEXEC);
+        if (reader.fd == -1) {
+            fprintf(stderr, "my_shell: %s: %s\n", argv[1], strerror(errno));
+            return STATUS_NO_SCRIPT;
         }
-        else
-        {
-            ERROR_MESSAGE(); /* Print error message for unknown commands */
+        jobs_init(0);
+        run_input(&reader, 0);
+        close(reader.fd);
+    }
+    else
+    {
+        /* Commands from the standard input, the prompt is only for a terminal */
+        char interactive = isatty(STDIN);
+        jobs_init(interactive);
+        if (interactive) {
+            history_open();
         }
-
+        run_input(&reader, interactive);
     }
 
-    return 0; /* Return from main function */
+    free(reader.data);
+    return last_exit_status; /* Return from main function */
 }
-  
@@ -11,6 +11,8 @@
 #ifndef SHELL_MAIN_H
 #define SHELL_MAIN_H
 
+#include <stddef.h>
+
 /*******************************************************************************
  *                                Definitions                                  *
  *******************************************************************************/
@@ -18,7 +20,10 @@
 #define STDIN               (0)
 #define STDOUT              (1)
 #define STDERR              (2)
-#define INPUT_BUFFER        (100)
+#define READ_CHUNK          (4096)  /* Bytes read from the input at once, lines can be longer */
+#define PROMPT_BUFFER       (256)   /* Prompt with its colors and the working directory */
+#define STATUS_USAGE        (2)     /* Exit status for wrong options of my_shell */
+#define STATUS_NO_SCRIPT    (127)   /* Exit status when the script can't be opened */
 #define ENVIROMENT_VARIABLE (1)
 #define LOCAL_VARIABLE      (0)
 
@@ -32,11 +37,15 @@
 #define CYAN "\033[1;36m"
 #define WHITE "\033[37m"
 
-/*******************************************************************************
- *                           Extern Global Variable                            *
- *******************************************************************************/
-
-extern char input_string[INPUT_BUFFER]; /* Global function to get the command and use in all functions*/
+/* Struct to save the input read but not used yet, a read can return several lines or half a line */
+typedef struct {
+    int fd;             /* Input being read, the standard input or a script */
+    char *data;
+    size_t len;         /* Bytes in data */
+    size_t scanned;     /* Bytes already searched for a new line */
+    size_t consumed;    /* Bytes of the line returned last time */
+    size_t cap;
+} line_reader;
 
 /*******************************************************************************
  *                             Functions Prototypes                            *
@@ -44,21 +53,16 @@ extern char input_string[INPUT_BUFFER]; /* Global function to get the command an
 
 /*
  * Description :
- * 1. Function to remove the Leading spaces if the input_string contain.
- */
-void REMOVE_LeadingSpaces(char *str);
-
-/*
- * Description :
- * 1. Function to remove the new line in input_string.
+ * 1. Function to print an error message for the user.
  */
-void remove_newline(char *str);
+void ERROR_MESSAGE();
 
 /*
  * Description :
  * 1. Function to Write on the Shell.
+ * 2. The prompt is built once and written with one write, it is built again only after cd.
  */
 void fun_SHELL_WRITE();
 
 
-#endif // SHELL_MAIN__H
\ No newline at end of file
+#endif // SHELL_MAIN__H
@@ -0,0 +1,443 @@
+ /******************************************************************************
+ *
+ * File Name: parallel.c
+ *
+ * Description: Source file for the internal command parallel which runs one external command for many inputs
+ *              on all the CPUs, with the output of every command kept together
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#define _GNU_SOURCE  /* For ppoll */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/types.h>
+#include "parallel.h"
+#include "launcher.h"  /* For the pipes and the descriptors of the commands */
+#include "external_commands.h"  /* To start the commands like any external command */
+#include "jobs.h"  /* The commands are the processes of one job, they are added to phist */
+#include "my_shell.h"
+
+/* Struct to save the output of a command until it finishes */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} output_buffer;
+
+/* Struct to save one running command, a free slot has pid 0 */
+typedef struct {
+    pid_t pid;
+    int fds[2];                 /* Read ends of its standard output and error pipes, -1 after the end */
+    output_buffer outputs[2];   /* What was read from them */
+} parallel_task;
+
+/*
+ * Description :
+ * 1. Function to add bytes to an output buffer, doubling it when it is full.
+ */
+static int output_add(output_buffer *buffer, const char *data, size_t length)
+{
+    if (buffer->len + length > buffer->cap) {
+        size_t cap = buffer->cap ? buffer->cap : PARALLEL_READ_CHUNK;
+        while (buffer->len + length > cap) {
+            cap *= 2;
+        }
+        char *grown = realloc(buffer->data, cap);
+        if (grown == NULL) {
+            return -1;
+        }
+        buffer->data = grown;
+        buffer->cap = cap;
+    }
+    memcpy(buffer->data + buffer->len, data, length);
+    buffer->len += length;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to write all of a buffer to a descriptor, write may take only a part of it.
+ */
+static void write_all(int fd, const char *data, size_t length)
+{
+    while (length > 0) {
+        ssize_t written = write(fd, data, length);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return; /* The reader is gone, the rest of the output is lost like in other shells */
+        }
+        data += written;
+        length -= written;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to read the standard input and split it in lines, used when no ::: inputs are given.
+ * 2. It returns an array of lines ending with NULL, the lines point into *text which must be freed too.
+ */
+static char **read_input_lines(char **text, int *count)
+{
+    output_buffer buffer = {NULL, 0, 0};
+    char chunk[READ_CHUNK];
+    ssize_t bytes;
+    while ((bytes = read(STDIN, chunk, sizeof(chunk))) != 0) {
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("parallel: read");
+            break;
+        }
+        if (output_add(&buffer, chunk, bytes) == -1) {
+            break;
+        }
+    }
+    if (output_add(&buffer, "", 1) == -1) {
+        free(buffer.data);
+        return NULL;
+    }
+
+    /* One line per input, empty lines are skipped */
+    int lines = 0;
+    for (size_t i = 0; i < buffer.len; i++) {
+        lines += (buffer.data[i] == '\n');
+    }
+    char **inputs = malloc((lines + 2) * sizeof(char *));
+    if (inputs == NULL) {
+        free(buffer.data);
+        return NULL;
+    }
+    *count = 0;
+    for (char *line = strtok(buffer.data, "\n"); line != NULL; line = strtok(NULL, "\n")) {
+        inputs[(*count)++] = line;
+    }
+    inputs[*count] = NULL;
+    *text = buffer.data;
+    return inputs;
+}
+
+/*
+ * Description :
+ * 1. Function to build the words of the command for one input: every {} is replaced by the input,
+ *    or the input is added as the last word if no word has {}.
+ */
+static char **build_command(char **words, int num_words, const char *input)
+{
+    char **argv = calloc(num_words + 2, sizeof(char *));
+    if (argv == NULL) {
+        return NULL;
+    }
+
+    char replaced = 0;
+    size_t input_length = strlen(input);
+    size_t replace_length = strlen(PARALLEL_REPLACE);
+    for (int i = 0; i < num_words; i++) {
+        /* The new word is at most as long as the word with every {} replaced by the input */
+        size_t count = 0;
+        for (const char *p = strstr(words[i], PARALLEL_REPLACE); p != NULL; p = strstr(p + replace_length, PARALLEL_REPLACE)) {
+            count++;
+        }
+        argv[i] = malloc(strlen(words[i]) + count * input_length + 1);
+        if (argv[i] == NULL) {
+            for (int j = 0; j < i; j++) {
+                free(argv[j]);
+            }
+            free(argv);
+            return NULL;
+        }
+
+        char *end = argv[i];
+        const char *word = words[i];
+        const char *found;
+        while ((found = strstr(word, PARALLEL_REPLACE)) != NULL) {
+            memcpy(end, word, found - word);
+            end += found - word;
+            memcpy(end, input, input_length);
+            end += input_length;
+            word = found + replace_length;
+            replaced = 1;
+        }
+        strcpy(end, word);
+    }
+    argv[num_words] = replaced ? NULL : (char *)input;
+    return argv;
+}
+
+/*
+ * Description :
+ * 1. Function to free the words built by build_command, the added input is not a copy.
+ */
+static void free_command(char **argv, int num_words)
+{
+    for (int i = 0; i < num_words; i++) {
+        free(argv[i]);
+    }
+    free(argv);
+}
+
+/*
+ * Description :
+ * 1. Function to start the command for one input in a free slot, with its outputs going into pipes
+ *    and /dev/null as its input, the commands must not fight for the terminal.
+ * 2. It returns 0 if the command started, or the status of the command that couldn't start.
+ */
+static int start_task(parallel_task *task, char **words, int num_words, const char *input, shell_job *job)
+{
+    char **argv = build_command(words, num_words, input);
+    if (argv == NULL) {
+        printf("Memory allocation failed.\n");
+        return 1;
+    }
+
+    int out_pipe[2] = {-1, -1};
+    int err_pipe[2] = {-1, -1};
+    launch_dups dups = {NULL, 0, 0};
+    int status = 1;
+    int null_fd = open_redirection("/dev/null", O_RDONLY);
+    if (null_fd == -1 || open_pipe(out_pipe) == -1 || open_pipe(err_pipe) == -1) {
+        perror("parallel");
+    } else if (launch_dups_add(&dups, STDIN, null_fd, 1) == -1 ||
+               launch_dups_add(&dups, STDOUT, out_pipe[1], 1) == -1 ||
+               launch_dups_add(&dups, STDERR, err_pipe[1], 1) == -1) {
+        printf("Memory allocation failed.\n");
+    } else {
+        int processes = job->num_processes;
+        status = start_external_command(argv, &dups, job);
+        if (status == 0 && job->num_processes > processes) {
+            task->pid = job->processes[job->num_processes - 1].pid;
+            task->fds[0] = out_pipe[0];
+            task->fds[1] = err_pipe[0];
+            out_pipe[0] = err_pipe[0] = -1; /* Kept by the task */
+        } else if (status == 0) {
+            status = 1; /* The job couldn't remember the process */
+        }
+    }
+
+    /* The write ends only stay open in the command, so the task reads the end of its output when it exits */
+    for (int i = 0; i < dups.count; i++) {
+        null_fd = (dups.dups[i].source_fd == null_fd) ? -1 : null_fd;
+        out_pipe[1] = (dups.dups[i].source_fd == out_pipe[1]) ? -1 : out_pipe[1];
+        err_pipe[1] = (dups.dups[i].source_fd == err_pipe[1]) ? -1 : err_pipe[1];
+    }
+    launch_dups_release(&dups);
+    int left[] = {null_fd, out_pipe[0], out_pipe[1], err_pipe[0], err_pipe[1]};
+    for (size_t i = 0; i < sizeof(left) / sizeof(left[0]); i++) {
+        if (left[i] != -1) {
+            close(left[i]);
+        }
+    }
+    free_command(argv, num_words);
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to read what a task wrote since the last call, a descriptor is closed when its pipe ends.
+ */
+static void read_task(parallel_task *task, int output)
+{
+    char chunk[PARALLEL_READ_CHUNK];
+    ssize_t bytes = read(task->fds[output], chunk, sizeof(chunk));
+    if (bytes == -1 && errno == EINTR) {
+        return;
+    }
+    if (bytes <= 0 || output_add(&task->outputs[output], chunk, bytes) == -1) {
+        close(task->fds[output]);
+        task->fds[output] = -1;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to collect a task whose outputs ended: it waits for its process, writes its whole output at once
+ *    and frees the slot.
+ * 2. It returns the exit status of the command.
+ */
+static int finish_task(parallel_task *task, shell_job *job)
+{
+    int status = job_wait_process(job, task->pid);
+
+    fflush(stdout); /* The messages of the shell come before the output */
+    write_all(STDOUT, task->outputs[0].data, task->outputs[0].len);
+    write_all(STDERR, task->outputs[1].data, task->outputs[1].len);
+    free(task->outputs[0].data);
+    free(task->outputs[1].data);
+    memset(task, 0, sizeof(*task));
+    task->fds[0] = task->fds[1] = -1;
+    return status;
+}
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command parallel [-j N] command [args] [::: inputs...].
+ * 2. It runs the command once for each input, at most N at once (default: the number of CPUs).
+ *    {} in the words is replaced by the input, otherwise the input is added as the last argument.
+ * 3. Without ::: the inputs are the lines of the standard input.
+ * 4. The output of every command is kept until it finishes and then written at once, so lines never mix.
+ * 5. It returns the number of commands that failed, each of them is also in phist.
+ */
+int fun_PARALLEL(int argc, char **argv)
+{
+    /* Options come before the command */
+    long max_tasks = sysconf(_SC_NPROCESSORS_ONLN);
+    int first = 1;
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        }
+        const char *number = NULL;
+        if (strcmp(argv[first], "-j") == 0 && first + 1 < argc) {
+            number = argv[++first];
+        } else if (strncmp(argv[first], "-j", 2) == 0 && argv[first][2] != '\0') {
+            number = argv[first] + 2;
+        }
+        char *end = NULL;
+        max_tasks = (number != NULL) ? strtol(number, &end, 10) : 0;
+        if (number == NULL || *end != '\0' || max_tasks < 1) {
+            printf("parallel: usage: parallel [-j N] command [args] [::: inputs...], N is at least 1\n");
+            return STATUS_PARALLEL_USAGE;
+        }
+        first++;
+    }
+    if (max_tasks < 1) {
+        max_tasks = 1;
+    }
+
+    int separator = first;
+    while (separator < argc && strcmp(argv[separator], PARALLEL_SEPARATOR) != 0) {
+        separator++;
+    }
+    int num_words = separator - first;
+    if (num_words == 0) {
+        printf("parallel: usage: parallel [-j N] command [args] [::: inputs...]\n");
+        return STATUS_PARALLEL_USAGE;
+    }
+
+    char *input_text = NULL;
+    char **inputs = argv + separator + 1;
+    int num_inputs = argc - separator - 1;
+    if (separator == argc) {
+        inputs = read_input_lines(&input_text, &num_inputs);
+        if (inputs == NULL) {
+            printf("Memory allocation failed.\n");
+            return 1;
+        }
+    }
+
+    /* All the commands are one foreground job, so Ctrl+C reaches all of them */
+    shell_job *job = job_create_words(argv, 0);
+    parallel_task *tasks = calloc(max_tasks, sizeof(parallel_task));
+    struct pollfd *polled = calloc(2 * max_tasks, sizeof(struct pollfd));
+    int *polled_task = calloc(2 * max_tasks, sizeof(int));
+    if (job == NULL || tasks == NULL || polled == NULL || polled_task == NULL) {
+        printf("Memory allocation failed.\n");
+        if (job != NULL) {
+            job_wait(job, 0);
+        }
+        free(tasks);
+        free(polled);
+        free(polled_task);
+        free(input_text);
+        if (input_text != NULL) {
+            free(inputs);
+        }
+        return 1;
+    }
+    for (long i = 0; i < max_tasks; i++) {
+        tasks[i].fds[0] = tasks[i].fds[1] = -1;
+    }
+
+    /* SIGCHLD is only let in while waiting in ppoll, so a command stopped with Ctrl+Z always wakes it up */
+    sigset_t chld_mask, old_mask, wait_mask;
+    sigemptyset(&chld_mask);
+    sigaddset(&chld_mask, SIGCHLD);
+    sigprocmask(SIG_BLOCK, &chld_mask, &old_mask);
+    wait_mask = old_mask;
+    sigdelset(&wait_mask, SIGCHLD);
+
+    int next_input = 0;
+    int running = 0;
+    int failed = 0;
+    char interrupted = 0;
+    char has_terminal = 0;
+    while (running > 0 || (next_input < num_inputs && !interrupted)) {
+        /* Fill the free slots */
+        for (long i = 0; i < max_tasks && next_input < num_inputs && !interrupted; i++) {
+            if (tasks[i].pid != 0) {
+                continue;
+            }
+            if (start_task(&tasks[i], argv + first, num_words, inputs[next_input++], job) != 0) {
+                failed++;
+                continue;
+            }
+            running++;
+            if (!has_terminal) {
+                has_terminal = job_take_terminal(job);
+            }
+        }
+        if (running == 0) {
+            continue;
+        }
+
+        /* Wait until a command writes or ends its output */
+        job_keep_running(job);
+        int num_polled = 0;
+        for (long i = 0; i < max_tasks; i++) {
+            for (int output = 0; output < 2; output++) {
+                if (tasks[i].fds[output] != -1) {
+                    polled[num_polled].fd = tasks[i].fds[output];
+                    polled[num_polled].events = POLLIN;
+                    polled_task[num_polled++] = 2 * i + output;
+                }
+            }
+        }
+        if (num_polled > 0 && ppoll(polled, num_polled, NULL, &wait_mask) == -1) {
+            if (errno != EINTR) {
+                perror("parallel: poll");
+                break;
+            }
+            continue;
+        }
+        for (int i = 0; i < num_polled; i++) {
+            if (polled[i].revents != 0) {
+                read_task(&tasks[polled_task[i] / 2], polled_task[i] % 2);
+            }
+        }
+
+        /* A command is finished when both its outputs ended */
+        for (long i = 0; i < max_tasks; i++) {
+            if (tasks[i].pid != 0 && tasks[i].fds[0] == -1 && tasks[i].fds[1] == -1) {
+                int status = finish_task(&tasks[i], job);
+                running--;
+                failed += (status != 0);
+                interrupted |= (status == STATUS_SIGNALED + SIGINT); /* Ctrl+C stops starting new commands */
+            }
+        }
+    }
+
+    sigprocmask(SIG_SETMASK, &old_mask, NULL);
+    if (has_terminal) {
+        job_release_terminal(job);
+    }
+    job_wait(job, 0); /* Every process was collected, this removes the job */
+    free(tasks);
+    free(polled);
+    free(polled_task);
+    if (input_text != NULL) {
+        free(inputs);
+        free(input_text);
+    }
+    return (failed < PARALLEL_MAX_FAILED) ? failed : PARALLEL_MAX_FAILED;
+}
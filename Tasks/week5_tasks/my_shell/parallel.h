@@ -0,0 +1,39 @@
+ /******************************************************************************
+ *
+ * File Name: parallel.h
+ *
+ * Description: Header file for parallel.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define PARALLEL_SEPARATOR      (":::")     /* Words after it are the inputs, one command runs for each of them */
+#define PARALLEL_REPLACE        ("{}")      /* Replaced by the input in the words of the command */
+#define PARALLEL_READ_CHUNK     (65536)     /* Bytes read from the output of a command at once */
+#define PARALLEL_MAX_FAILED     (101)       /* Status when more than 100 commands failed, like GNU parallel */
+#define STATUS_PARALLEL_USAGE   (255)       /* Status of a wrong parallel command line */
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to be called for the internal command parallel [-j N] command [args] [::: inputs...].
+ * 2. It runs the command once for each input, at most N at once (default: the number of CPUs).
+ *    {} in the words is replaced by the input, otherwise the input is added as the last argument.
+ * 3. Without ::: the inputs are the lines of the standard input.
+ * 4. The output of every command is kept until it finishes and then written at once, so lines never mix.
+ * 5. It returns the number of commands that failed, each of them is also in phist.
+ */
+int fun_PARALLEL(int argc, char **argv);
+
+#endif // PARALLEL_H
@@ -0,0 +1,614 @@
+ /******************************************************************************
+ *
+ * File Name: parser.c
+ *
+ * Description: Source file for the lexer and parser which turn a command line into a command tree
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "parser.h"
+
+/* Types of the tokens read by the lexer */
+typedef enum {
+    TOKEN_WORD,
+    TOKEN_PIPE,         /* |  */
+    TOKEN_AND,          /* && */
+    TOKEN_OR,           /* || */
+    TOKEN_SEMICOLON,    /* ; or a new line */
+    TOKEN_OPEN,         /* (  */
+    TOKEN_CLOSE,        /* )  */
+    TOKEN_REDIRECT,     /* [n]<, [n]>, [n]>>, [n]>&, [n]<& */
+    TOKEN_AMPERSAND,    /* &  */
+    TOKEN_END
+} token_type;
+
+/* Struct to save the token the parser is looking at */
+typedef struct {
+    token_type type;
+    parsed_word word;       /* TOKEN_WORD, owned by the lexer until the parser takes it */
+    int fd;                 /* TOKEN_REDIRECT */
+    char redirect_type;     /* TOKEN_REDIRECT */
+} token;
+
+/* Struct to save the position in the line, the line is read once from the start to the end */
+typedef struct {
+    const char *input;
+    size_t pos;
+    token current;
+    char failed;            /* A syntax error was printed */
+} lexer;
+
+/* Struct to save a growing string, words have no length limit */
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} text_buffer;
+
+/*
+ * Description :
+ * 1. Function to add one character to a text buffer, doubling it when it is full.
+ */
+static int buffer_add(text_buffer *buffer, char c)
+{
+    if (buffer->len + 1 >= buffer->cap) {
+        size_t cap = buffer->cap ? buffer->cap * 2 : 32;
+        char *data = realloc(buffer->data, cap);
+        if (data == NULL) {
+            return -1;
+        }
+        buffer->data = data;
+        buffer->cap = cap;
+    }
+    buffer->data[buffer->len++] = c;
+    buffer->data[buffer->len] = '\0';
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to print a syntax error once, later errors of the same line are consequences of the first.
+ */
+static void syntax_error(lexer *lx, const char *message, const char *detail)
+{
+    if (!lx->failed) {
+        printf("Syntax error: %s%s\n", message, detail);
+        lx->failed = 1;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to check if a character ends a word when it is not quoted.
+ */
+static int is_metacharacter(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '|' || c == '&' ||
+           c == ';' || c == '(' || c == ')' || c == '<' || c == '>' || c == '\0';
+}
+
+/*
+ * Description :
+ * 1. Function to check if a '$' followed by c starts a variable: $NAME, ${NAME}, $?, $$ or $!.
+ */
+static int starts_variable(char c)
+{
+    return isalpha((unsigned char)c) || c == '_' || c == '{' || c == '?' || c == '$' || c == '!';
+}
+
+/*
+ * Description :
+ * 1. Function to read one word, removing quotes and backslashes.
+ * 2. A '$' that must be expanded is written as EXPAND_MARK followed by the name, a quoted or escaped '$' stays as it is.
+ */
+static int lex_word(lexer *lx, parsed_word *word)
+{
+    text_buffer buffer = {NULL, 0, 0};
+    const char *input = lx->input;
+    size_t pos = lx->pos;
+    int ok = (buffer_add(&buffer, '\0') == 0); /* Allocate now, an empty quoted word "" is still a word */
+    buffer.len = 0;
+    word->quoted = 0;
+
+    while (ok && !is_metacharacter(input[pos])) {
+        char c = input[pos];
+
+        if (c == '\\') {
+            /* Escaped character, a backslash at the end of the line is kept */
+            word->quoted = 1;
+            if (input[pos + 1] == '\0') {
+                ok = (buffer_add(&buffer, '\\') == 0);
+                pos++;
+            } else {
+                ok = (buffer_add(&buffer, input[pos + 1]) == 0);
+                pos += 2;
+            }
+        } else if (c == '\'') {
+            /* Everything is literal until the closing quote */
+            const char *closing = strchr(input + pos + 1, '\'');
+            if (closing == NULL) {
+                syntax_error(lx, "missing closing quote ", "'");
+                free(buffer.data);
+                return -1;
+            }
+            word->quoted = 1;
+            for (const char *p = input + pos + 1; ok && p < closing; p++) {
+                ok = (buffer_add(&buffer, *p) == 0);
+            }
+            pos = closing - input + 1;
+        } else if (c == '"') {
+            /* Variables are expanded, backslash only escapes $ " and \ */
+            word->quoted = 1;
+            pos++;
+            while (ok && input[pos] != '"') {
+                if (input[pos] == '\0') {
+                    syntax_error(lx, "missing closing quote ", "\"");
+                    free(buffer.data);
+                    return -1;
+                }
+                if (input[pos] == '\\' && (input[pos + 1] == '$' || input[pos + 1] == '"' || input[pos + 1] == '\\')) {
+                    ok = (buffer_add(&buffer, input[pos + 1]) == 0);
+                    pos += 2;
+                } else if (input[pos] == '$' && starts_variable(input[pos + 1])) {
+                    ok = (buffer_add(&buffer, EXPAND_MARK) == 0);
+                    pos++;
+                } else {
+                    if (input[pos] != EXPAND_MARK) {
+                        ok = (buffer_add(&buffer, input[pos]) == 0);
+                    }
+                    pos++;
+                }
+            }
+            pos++; /* Skip the closing quote */
+        } else if (c == '$' && starts_variable(input[pos + 1])) {
+            ok = (buffer_add(&buffer, EXPAND_MARK) == 0);
+            pos++;
+        } else {
+            if (c != EXPAND_MARK) {
+                ok = (buffer_add(&buffer, c) == 0);
+            }
+            pos++;
+        }
+    }
+
+    if (!ok) {
+        syntax_error(lx, "out of memory", "");
+        free(buffer.data);
+        return -1;
+    }
+    lx->pos = pos;
+    word->text = buffer.data;
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to move to the next token, freeing the word of the current one if the parser didn't take it.
+ */
+static void next_token(lexer *lx)
+{
+    const char *input = lx->input;
+    token *tok = &lx->current;
+
+    free(tok->word.text);
+    tok->word.text = NULL;
+    if (lx->failed) {
+        tok->type = TOKEN_END;
+        return;
+    }
+
+    /* Skip spaces and comments */
+    while (input[lx->pos] == ' ' || input[lx->pos] == '\t' || input[lx->pos] == '\r') {
+        lx->pos++;
+    }
+    if (input[lx->pos] == '#') {
+        while (input[lx->pos] != '\0' && input[lx->pos] != '\n') {
+            lx->pos++;
+        }
+    }
+
+    const char *start = input + lx->pos;
+    switch (*start) {
+    case '\0':
+        tok->type = TOKEN_END;
+        return;
+    case '|':
+        tok->type = (start[1] == '|') ? TOKEN_OR : TOKEN_PIPE;
+        lx->pos += (start[1] == '|') ? 2 : 1;
+        return;
+    case '&':
+        tok->type = (start[1] == '&') ? TOKEN_AND : TOKEN_AMPERSAND;
+        lx->pos += (start[1] == '&') ? 2 : 1;
+        return;
+    case ';':
+    case '\n':
+        tok->type = TOKEN_SEMICOLON;
+        lx->pos++;
+        return;
+    case '(':
+        tok->type = TOKEN_OPEN;
+        lx->pos++;
+        return;
+    case ')':
+        tok->type = TOKEN_CLOSE;
+        lx->pos++;
+        return;
+    default:
+        break;
+    }
+
+    /* A redirection, with an optional descriptor number written right before it */
+    const char *op = start;
+    while (isdigit((unsigned char)*op)) {
+        op++;
+    }
+    if (*op == '<' || *op == '>') {
+        tok->type = TOKEN_REDIRECT;
+        tok->fd = (op == start) ? (*op == '<' ? 0 : 1) : atoi(start);
+        if (op[0] == '<' && op[1] == '<') {
+            syntax_error(lx, "here documents (<<) are not supported", "");
+            tok->type = TOKEN_END;
+            return;
+        }
+        if (op[1] == '&') {
+            tok->redirect_type = REDIRECT_DUP;
+            op += 2;
+        } else if (op[0] == '>' && op[1] == '>') {
+            tok->redirect_type = REDIRECT_APPEND;
+            op += 2;
+        } else {
+            tok->redirect_type = (op[0] == '<') ? REDIRECT_INPUT : REDIRECT_OUTPUT;
+            op += 1;
+        }
+        lx->pos = op - input;
+        return;
+    }
+
+    tok->type = TOKEN_WORD;
+    if (lex_word(lx, &tok->word) == -1) {
+        tok->type = TOKEN_END;
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to name a token in syntax errors.
+ */
+static const char *token_name(const token *tok)
+{
+    switch (tok->type) {
+    case TOKEN_PIPE:        return "|";
+    case TOKEN_AND:         return "&&";
+    case TOKEN_OR:          return "||";
+    case TOKEN_SEMICOLON:   return ";";
+    case TOKEN_OPEN:        return "(";
+    case TOKEN_CLOSE:       return ")";
+    case TOKEN_REDIRECT:    return "redirection";
+    case TOKEN_AMPERSAND:   return "&";
+    case TOKEN_WORD:        return tok->word.text;
+    default:                return "end of line";
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to allocate an empty node of a type.
+ */
+static shell_node *new_node(node_type type, shell_node *left, shell_node *right)
+{
+    shell_node *node = calloc(1, sizeof(shell_node));
+    if (node == NULL) {
+        free_node(left);
+        free_node(right);
+        return NULL;
+    }
+    node->type = type;
+    node->left = left;
+    node->right = right;
+    return node;
+}
+
+static shell_node *parse_list(lexer *lx);
+
+/*
+ * Description :
+ * 1. Function to read one redirection and its file name, appending it at tail.
+ */
+static int parse_redirection(lexer *lx, shell_redirection ***tail)
+{
+    shell_redirection *redirection = calloc(1, sizeof(shell_redirection));
+    if (redirection == NULL) {
+        syntax_error(lx, "out of memory", "");
+        return -1;
+    }
+    redirection->fd = lx->current.fd;
+    redirection->type = lx->current.redirect_type;
+
+    next_token(lx);
+    if (lx->current.type != TOKEN_WORD) {
+        syntax_error(lx, "missing file name after redirection, found ", token_name(&lx->current));
+        free(redirection);
+        return -1;
+    }
+    redirection->target = lx->current.word;
+    lx->current.word.text = NULL; /* The node owns the word now */
+
+    **tail = redirection;
+    *tail = &redirection->next;
+    next_token(lx);
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to read one command: words and redirections, or a ( subshell ) followed by redirections.
+ */
+static shell_node *parse_command(lexer *lx)
+{
+    shell_node *node;
+
+    if (lx->current.type == TOKEN_OPEN) {
+        next_token(lx);
+        shell_node *inside = parse_list(lx);
+        if (inside == NULL) {
+            syntax_error(lx, "empty subshell before ", token_name(&lx->current));
+            return NULL;
+        }
+        if (lx->current.type != TOKEN_CLOSE) {
+            syntax_error(lx, "missing ) before ", token_name(&lx->current));
+            free_node(inside);
+            return NULL;
+        }
+        next_token(lx);
+        node = new_node(NODE_SUBSHELL, inside, NULL);
+    } else {
+        node = new_node(NODE_COMMAND, NULL, NULL);
+    }
+    if (node == NULL) {
+        syntax_error(lx, "out of memory", "");
+        return NULL;
+    }
+
+    shell_redirection **tail = &node->redirections;
+    int capacity = 0;
+    while (lx->current.type == TOKEN_WORD || lx->current.type == TOKEN_REDIRECT) {
+        if (lx->current.type == TOKEN_REDIRECT) {
+            if (parse_redirection(lx, &tail) == -1) {
+                free_node(node);
+                return NULL;
+            }
+            continue;
+        }
+
+        if (node->type == NODE_SUBSHELL) {
+            syntax_error(lx, "unexpected word after ), found ", lx->current.word.text);
+            free_node(node);
+            return NULL;
+        }
+        if (node->num_words == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            parsed_word *words = realloc(node->words, capacity * sizeof(parsed_word));
+            if (words == NULL) {
+                syntax_error(lx, "out of memory", "");
+                free_node(node);
+                return NULL;
+            }
+            node->words = words;
+        }
+        node->words[node->num_words++] = lx->current.word;
+        lx->current.word.text = NULL; /* The node owns the word now */
+        next_token(lx);
+    }
+
+    if (node->type == NODE_COMMAND && node->num_words == 0 && node->redirections == NULL) {
+        syntax_error(lx, "unexpected ", token_name(&lx->current));
+        free_node(node);
+        return NULL;
+    }
+    return node;
+}
+
+/*
+ * Description :
+ * 1. Function to read commands connected by |, a single command is returned as it is.
+ * 2. A pipeline that starts with the unquoted word time is read after it and put under a NODE_TIME node,
+ *    time alone times nothing like in other shells.
+ */
+static shell_node *parse_pipeline(lexer *lx)
+{
+    if (lx->current.type == TOKEN_WORD && !lx->current.word.quoted && strcmp(lx->current.word.text, TIME_KEYWORD) == 0) {
+        next_token(lx);
+        shell_node *timed = NULL;
+        if (lx->current.type == TOKEN_WORD || lx->current.type == TOKEN_REDIRECT || lx->current.type == TOKEN_OPEN) {
+            timed = parse_pipeline(lx);
+            if (timed == NULL) {
+                return NULL;
+            }
+        }
+        shell_node *node = new_node(NODE_TIME, timed, NULL);
+        if (node == NULL) {
+            syntax_error(lx, "out of memory", "");
+        }
+        return node;
+    }
+
+    shell_node *first = parse_command(lx);
+    if (first == NULL || lx->current.type != TOKEN_PIPE) {
+        return first;
+    }
+
+    shell_node *pipeline = new_node(NODE_PIPELINE, NULL, NULL);
+    if (pipeline == NULL) {
+        free_node(first);
+        syntax_error(lx, "out of memory", "");
+        return NULL;
+    }
+
+    int capacity = 0;
+    shell_node *stage = first;
+    while (1) {
+        if (pipeline->num_stages == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            shell_node **stages = realloc(pipeline->stages, capacity * sizeof(shell_node *));
+            if (stages == NULL) {
+                free_node(stage);
+                free_node(pipeline);
+                syntax_error(lx, "out of memory", "");
+                return NULL;
+            }
+            pipeline->stages = stages;
+        }
+        pipeline->stages[pipeline->num_stages++] = stage;
+
+        if (lx->current.type != TOKEN_PIPE) {
+            return pipeline;
+        }
+        next_token(lx);
+        stage = parse_command(lx);
+        if (stage == NULL) {
+            free_node(pipeline);
+            return NULL;
+        }
+    }
+}
+
+/*
+ * Description :
+ * 1. Function to read pipelines connected by && and ||, which group from the left like in other shells.
+ */
+static shell_node *parse_and_or(lexer *lx)
+{
+    shell_node *node = parse_pipeline(lx);
+
+    while (node != NULL && (lx->current.type == TOKEN_AND || lx->current.type == TOKEN_OR)) {
+        node_type type = (lx->current.type == TOKEN_AND) ? NODE_AND : NODE_OR;
+        next_token(lx);
+        shell_node *right = parse_pipeline(lx);
+        if (right == NULL) {
+            free_node(node);
+            return NULL;
+        }
+        node = new_node(type, node, right);
+        if (node == NULL) {
+            syntax_error(lx, "out of memory", "");
+        }
+    }
+    return node;
+}
+
+/*
+ * Description :
+ * 1. Function to read a list of commands separated by ;, & or new lines, until the end of the line or a ).
+ * 2. It returns NULL for an empty list, check lx->failed for errors.
+ */
+static shell_node *parse_list(lexer *lx)
+{
+    shell_node *list = NULL;
+
+    while (!lx->failed) {
+        if (lx->current.type == TOKEN_SEMICOLON) {
+            next_token(lx); /* Empty commands are skipped */
+            continue;
+        }
+        if (lx->current.type == TOKEN_END || lx->current.type == TOKEN_CLOSE) {
+            break;
+        }
+
+        shell_node *item = parse_and_or(lx);
+        if (item == NULL) {
+            free_node(list);
+            return NULL;
+        }
+
+        /* cmd1 && cmd2 & runs the whole and-or list in the background */
+        if (lx->current.type == TOKEN_AMPERSAND) {
+            shell_node *background = new_node(NODE_BACKGROUND, item, NULL);
+            if (background == NULL) {
+                free_node(item);
+                free_node(list);
+                syntax_error(lx, "out of memory", "");
+                return NULL;
+            }
+            item = background;
+            next_token(lx);
+        } else if (lx->current.type != TOKEN_SEMICOLON && lx->current.type != TOKEN_END && lx->current.type != TOKEN_CLOSE) {
+            syntax_error(lx, "unexpected ", token_name(&lx->current));
+        }
+
+        list = (list == NULL) ? item : new_node(NODE_SEQUENCE, list, item);
+        if (list == NULL) {
+            syntax_error(lx, "out of memory", "");
+            return NULL;
+        }
+    }
+
+    if (lx->failed) {
+        free_node(list);
+        return NULL;
+    }
+    return list;
+}
+
+/*
+ * Description :
+ * 1. Function to read a command line in one pass and build its command tree.
+ * 2. It supports quotes, backslash escapes, $VAR, &&, ||, ;, ( subshells ), |, time and [n]<, [n]>, [n]>>, [n]>&m redirections.
+ * 3. It returns 0 and the tree (NULL for an empty line or a comment), or -1 after printing a syntax error.
+ */
+int parse_command_line(const char *line, shell_node **tree)
+{
+    lexer lx = {line, 0, {TOKEN_END, {NULL, 0}, 0, 0}, 0};
+
+    next_token(&lx);
+    *tree = parse_list(&lx);
+    if (!lx.failed && lx.current.type == TOKEN_CLOSE) {
+        syntax_error(&lx, "unexpected ", ")");
+    }
+    free(lx.current.word.text);
+
+    if (lx.failed) {
+        free_node(*tree);
+        *tree = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Description :
+ * 1. Function to free a command tree built by parse_command_line.
+ */
+void free_node(shell_node *node)
+{
+    if (node == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < node->num_words; i++) {
+        free(node->words[i].text);
+    }
+    free(node->words);
+
+    shell_redirection *redirection = node->redirections;
+    while (redirection != NULL) {
+        shell_redirection *next = redirection->next;
+        free(redirection->target.text);
+        free(redirection);
+        redirection = next;
+    }
+
+    for (int i = 0; i < node->num_stages; i++) {
+        free_node(node->stages[i]);
+    }
+    free(node->stages);
+
+    free_node(node->left);
+    free_node(node->right);
+    free(node);
+}
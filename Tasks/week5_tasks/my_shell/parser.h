@@ -0,0 +1,84 @@
+ /******************************************************************************
+ *
+ * File Name: parser.h
+ *
+ * Description: Header file for parser.c
+ *
+ * Author: Karim Gomaa
+ *
+ *******************************************************************************/
+
+#ifndef PARSER_H
+#define PARSER_H
+
+/*******************************************************************************
+ *                                Definitions                                  *
+ *******************************************************************************/
+
+#define EXPAND_MARK         ('\001')    /* Written before the name of a variable to expand, a quoted '$' stays a '$' */
+
+/* Types of redirections */
+#define REDIRECT_INPUT      ('<')       /* [n]< file  */
+#define REDIRECT_OUTPUT     ('>')       /* [n]> file  */
+#define REDIRECT_APPEND     ('a')       /* [n]>> file */
+#define REDIRECT_DUP        ('&')       /* [n]>&m or [n]<&m, n becomes a copy of m */
+
+#define TIME_KEYWORD        ("time")    /* Unquoted first word of a pipeline that times it */
+
+/* Types of the nodes of the command tree */
+typedef enum {
+    NODE_COMMAND,       /* Words and redirections of one command */
+    NODE_PIPELINE,      /* Stages connected by | */
+    NODE_AND,           /* left && right */
+    NODE_OR,            /* left || right */
+    NODE_SEQUENCE,      /* left ; right */
+    NODE_SUBSHELL,      /* ( left ) with its own redirections */
+    NODE_BACKGROUND,    /* left &, runs without waiting for it */
+    NODE_TIME           /* time left, prints the time and resources the pipeline used, left may be NULL */
+} node_type;
+
+/* Struct to save one word after quote removal, variables are expanded when the command runs */
+typedef struct {
+    char *text;
+    char quoted;        /* Some part of the word was quoted, so it is kept even if it expands to nothing */
+} parsed_word;
+
+/* Struct to save one redirection, they are applied in the order they were written */
+typedef struct shell_redirection {
+    int fd;                             /* Descriptor being redirected */
+    char type;                          /* One of REDIRECT_* */
+    parsed_word target;                 /* File name, or the descriptor number for REDIRECT_DUP */
+    struct shell_redirection *next;
+} shell_redirection;
+
+/* Struct to save one node of the command tree */
+typedef struct shell_node {
+    node_type type;
+    parsed_word *words;                 /* NODE_COMMAND */
+    int num_words;
+    shell_redirection *redirections;    /* NODE_COMMAND and NODE_SUBSHELL */
+    struct shell_node *left;            /* NODE_AND, NODE_OR, NODE_SEQUENCE, NODE_SUBSHELL, NODE_BACKGROUND, NODE_TIME */
+    struct shell_node *right;           /* NODE_AND, NODE_OR, NODE_SEQUENCE */
+    struct shell_node **stages;         /* NODE_PIPELINE */
+    int num_stages;
+} shell_node;
+
+/*******************************************************************************
+ *                             Functions Prototypes                            *
+ *******************************************************************************/
+
+/*
+ * Description :
+ * 1. Function to read a command line in one pass and build its command tree.
+ * 2. It supports quotes, backslash escapes, $VAR, &&, ||, ;, &, ( subshells ), |, time and [n]<, [n]>, [n]>>, [n]>&m redirections.
+ * 3. It returns 0 and the tree (NULL for an empty line or a comment), or -1 after printing a syntax error.
+ */
+int parse_command_line(const char *line, shell_node **tree);
+
+/*
+ * Description :
+ * 1. Function to free a command tree built by parse_command_line.
+ */
+void free_node(shell_node *node);
+
+#endif // PARSER_H